@@ -0,0 +1,71 @@
+#include <stdio.h>
+#include "sjf.h"
+#include "trace.h"
+#include "record.h"
+#include "stats.h"
+
+#ifndef __SJF_CONTEXT__
+#define __SJF_CONTEXT__
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds everything an SJF simulation reads or writes besides its task
+/// array. Simulations on separate contexts share no state and can run on separate threads.
+//----------------------------------------------------------------------------------------------------------------------------------
+struct sjf_context_t {
+    // Implementation the simulations run on
+    enum sjf_engine_t engine;
+
+    // Trace output (level, sink and stream) of the simulations
+    struct trace_buffer_t* trace;
+
+    // Log the dispatches are recorded into (NULL to not record)
+    struct dispatch_log_t* log;
+
+    // Log created by sjf_context_record(), freed with the context
+    struct dispatch_log_t* owned_log;
+
+    // Simulated clock and statistics at the end of the last simulation
+    int run_time;
+    struct time_stats_t stats;
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Creates a scheduler context with its own trace buffer and no dispatch log
+///
+/// @param[in] engine The implementation to schedule with
+/// @param[in] out Stream the trace is written to (NULL to turn the trace off)
+///
+/// @return the new context, NULL on failure
+//----------------------------------------------------------------------------------------------------------------------------------
+struct sjf_context_t* create_sjf_context(enum sjf_engine_t engine, FILE* out);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Run the shortest job first algorithm with a context. The wait and turn around time of
+/// each task are written to the task array, the clock and statistics to the context.
+///
+/// @param[in] context The scheduler context
+/// @param[in] task The buffer containing task data
+/// @param[in] size The size of the buffer
+//----------------------------------------------------------------------------------------------------------------------------------
+void sjf_context_run(struct sjf_context_t* context, struct task_t* task, int size);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Creates a dispatch log and records the simulations of the context into it. The context
+/// owns the log: it replaces (and frees) a log created this way before and is freed with the context.
+///
+/// @param[in] context The scheduler context
+/// @param[in] capacity Number of dispatches the log holds (later ones are counted as dropped)
+///
+/// @return the log, NULL on failure
+//----------------------------------------------------------------------------------------------------------------------------------
+struct dispatch_log_t* sjf_context_record(struct sjf_context_t* context, size_t capacity);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Free a scheduler context and write out its trace (a log attached with
+/// sjf_context_record() is freed too, any other log is not owned)
+///
+/// @param[in] context The scheduler context
+//----------------------------------------------------------------------------------------------------------------------------------
+void destroy_sjf_context(struct sjf_context_t* context);
+
+#endif // __SJF_CONTEXT__
@@ -0,0 +1,135 @@
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "generator.h"
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Generates a synthetic workload, as CSV on stdout (streamed, any size) or as a packed
+/// workload file
+///
+/// @Usage
+/// ./genworkload -n <tasks> [-s seed] [-d uniform|exponential|bimodal|pareto] [-m mean] [-r min:max]
+///               [-p levels] [-z zipf exponent] [-a arrival rate] [-o packed.wl]
+//----------------------------------------------------------------------------------------------------------------------------------
+
+static int parseDistribution(const char* name, enum generator_distribution_t* distribution);
+
+int main(int argc, char *argv[])
+{
+    struct generator_config_t config;
+    long long count = -1;
+    const char* output = NULL;
+    int invalid = 0;
+    int option;
+
+    generator_default_config(&config, 1);
+
+    while((option = getopt(argc, argv, "n:s:d:m:r:p:z:a:o:")) != -1)
+    {
+        switch(option)
+        {
+            case 'n':
+                count = atoll(optarg);
+                break;
+
+            case 's':
+                config.seed = strtoull(optarg, NULL, 0);
+                break;
+
+            case 'd':
+                invalid |= (parseDistribution(optarg, &config.execution) != 0);
+                break;
+
+            case 'm':
+                config.execution_mean = atof(optarg);
+                break;
+
+            case 'r':
+                invalid |= (sscanf(optarg, "%d:%d", &config.execution_min, &config.execution_max) != 2);
+                break;
+
+            case 'p':
+                config.priority_levels = atoi(optarg);
+                break;
+
+            case 'z':
+                config.zipf_exponent = atof(optarg);
+                break;
+
+            case 'a':
+                config.arrival_rate = atof(optarg);
+                break;
+
+            case 'o':
+                output = optarg;
+                break;
+
+            default:
+                invalid = 1;
+                break;
+        }
+    }
+
+    // Packed files hold at most INT_MAX tasks
+    if(invalid || (count < 0) || (optind != argc) || ((output != NULL) && (count > INT_MAX)))
+    {
+        fprintf(stderr, "usage: %s -n <tasks> [-s seed] [-d uniform|exponential|bimodal|pareto] [-m mean] [-r min:max]\n"
+                        "       [-p levels] [-z zipf exponent] [-a arrival rate] [-o packed.wl]\n", argv[0]);
+        return 1;
+    }
+
+    struct generator_t* generator = create_generator(&config);
+
+    if(generator == NULL)
+    {
+        fprintf(stderr, "%s: Invalid workload configuration!\n", argv[0]);
+        return 1;
+    }
+
+    int result;
+
+    if(output == NULL)
+    {
+        result = generate_csv(generator, count, stdout);
+        result |= fflush(stdout);
+    }
+    else
+    {
+        struct workload_t* workload = generate_workload(generator, (int)count);
+
+        result = (workload == NULL) ? -1 : workload_write(workload, output);
+        destroy_workload(workload);
+    }
+
+    destroy_generator(generator);
+
+    return (result == 0) ? 0 : 1;
+}
+
+
+///-------------------------------------------------
+/// @brief  Looks up a distribution by name
+///
+/// @param[in] name Name of the distribution
+/// @param[out] distribution The distribution
+///
+/// @return 0 on success, -1 for an unknown name
+///-------------------------------------------------
+static int parseDistribution(const char* name, enum generator_distribution_t* distribution)
+{
+    const char* names[] = {"uniform", "exponential", "bimodal", "pareto"};
+    const enum generator_distribution_t values[] = {GENERATOR_UNIFORM, GENERATOR_EXPONENTIAL, GENERATOR_BIMODAL, GENERATOR_PARETO};
+
+    for(int i = 0; i < 4; i++)
+    {
+        if(strcmp(name, names[i]) == 0)
+        {
+            *distribution = values[i];
+            return 0;
+        }
+    }
+
+    return -1;
+}
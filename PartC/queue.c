@@ -1,7 +1,23 @@
 #include "queue.h"
+#include <stddef.h>
 
 
+static struct queue_t* queueFromHead(struct node_t* head);
+static struct node_t* allocNode(struct node_pool_t* pool, struct task_t* task);
+static void releaseNode(struct node_pool_t* pool, struct node_t* node);
+static struct task_link_t* splitRun(struct task_link_t* run, int length);
+static void mergeRuns(struct task_link_t* left, struct task_link_t* right, int (*compare)(struct task_t* taskA, struct task_t* taskB),
+                      struct task_link_t** head, struct task_link_t** tail);
 static int isInvalidNode(struct node_t* node, const char* caller);
+static int isInvalidHead(struct node_t* head, const char* caller);
+static void* trackedMalloc(size_t size, int nodes);
+static void trackedFree(void* pointer, size_t size, int nodes);
+static void raisePeak(long long* peak, long long live);
+
+// Allocation counters (see queue_alloc_enable_tracking()), updated atomically so queues can live on
+// several threads
+static int allocTracking = 0;
+static struct queue_alloc_stats_t allocStats;
 
 
 ///-------------------------------------------------
@@ -18,42 +34,67 @@ static int isInvalidNode(struct node_t* node, const char* caller);
 struct node_t* create_queue(struct task_t* task, int size)
 {
     // Validate parameters
-    if((task == NULL) ||(size < 1))
+    if((task == NULL) || (size < 1))
     {
         return NULL;
     }
 
-    // Create the sentinel node at the base of the queue
-    struct node_t* sentinel = create_new_node(NULL);
+    struct queue_t* queue = create_task_queue(task, size, NULL);
 
-    // Verify that malloc didn't fail
-    if(isInvalidNode(sentinel, __func__))
+    return (queue != NULL) ? &(queue->sentinel) : NULL;
+}
+
+
+///-------------------------------------------------
+/// @brief  Given an array of tasks, construct a
+///         singly-linked task queue whose
+///         nodes come from a node pool
+///
+/// @param[in] task Array of tasks to create task
+///                 nodes from
+/// @param[in] size The number of tasks nodes to
+///                 create
+/// @param[in] pool The pool to take nodes from
+///
+/// @return The sentinel node of the queue
+///-------------------------------------------------
+struct node_t* create_queue_from_pool(struct task_t* task, int size, struct node_pool_t* pool)
+{
+    // Validate parameters
+    if((task == NULL) || (size < 1) || (pool == NULL))
     {
         return NULL;
     }
 
-    // Create and link nodes together to form the queue
-    // NOTE: The first "true" node in the queue is linked to the sentinel
-    for(int i = 0; i < size; i++)
-    {
-        push(&sentinel, &(task[i]));
-    }
+    struct queue_t* queue = create_task_queue(task, size, pool);
 
-    return sentinel;
+    return (queue != NULL) ? &(queue->sentinel) : NULL;
 }
 
 
 ///-------------------------------------------------
-/// @brief  Construct a new task node
+/// @brief  Construct a new task node, or the
+///         sentinel of an empty queue if there
+///         is no task
 ///
 /// @param[in] task Task to attach to a node
+///                 (NULL: sentinel)
 ///
 /// @return The newly created task node
 ///-------------------------------------------------
 struct node_t* create_new_node(struct task_t* task)
 {
+    // NOTE: A head node must be embedded in a
+    //       queue descriptor for push()/pop()
+    if(task == NULL)
+    {
+        struct queue_t* queue = create_task_queue(NULL, 0, NULL);
+
+        return (queue != NULL) ? &(queue->sentinel) : NULL;
+    }
+
     // Dynamically allocate memory for the new node
-    struct node_t* newNode = (struct node_t*)malloc(sizeof(struct node_t));
+    struct node_t* newNode = (struct node_t*)trackedMalloc(sizeof(struct node_t), 1);
     
     // Verify that malloc didn't fail
     if(isInvalidNode(newNode, __func__))
@@ -78,18 +119,13 @@ struct node_t* create_new_node(struct task_t* task)
 ///-------------------------------------------------
 struct task_t* peek(struct node_t** head)
 {
-    if(is_empty(head))
+    // Check if the queue is invalid
+    if(isInvalidHead(*head, __func__))
     {
         return NULL;
     }
 
-    // NOTE: The base of the queue is a sentinel
-    //       therefore the first task node is
-    //       linked to it
-    struct node_t* topNode = (*head)->next;
-
-    // Return the top-most task
-    return topNode->task;
+    return queue_peek(queueFromHead(*head));
 }
 
 
@@ -100,18 +136,34 @@ struct task_t* peek(struct node_t** head)
 ///-------------------------------------------------
 void pop(struct node_t** head)
 {
-    // Check if the queue is empty
-    if(is_empty(head))
+    // Check if the queue is invalid
+    if(isInvalidHead(*head, __func__))
     {
         return;
     }
 
-    // Pop the old head
-    struct node_t* oldHead = *head;
-    *head = (*head)->next;
+    queue_pop(queueFromHead(*head));
+}
+
 
-    // Free the memory allocated for the popped head
-    free(oldHead);
+///-------------------------------------------------
+/// @brief  Pop the top-most task off a queue and
+///         return its node to the pool
+///
+/// @param[in] head The head of the queue
+/// @param[in] pool The pool the queue's nodes
+///                 came from
+///-------------------------------------------------
+void pop_pooled(struct node_t** head, struct node_pool_t* pool)
+{
+    // Check if the queue is invalid or wasn't
+    // created from this pool
+    if(isInvalidHead(*head, __func__) || (queueFromHead(*head)->pool != pool))
+    {
+        return;
+    }
+
+    queue_pop(queueFromHead(*head));
 }
 
 
@@ -123,36 +175,33 @@ void pop(struct node_t** head)
 ///-------------------------------------------------
 void push(struct node_t** head, struct task_t* task)
 {
-    // Verify that the queue is initialized properly
-    if(isInvalidNode(*head, __func__) || (task == NULL))
+    // Validate parameters
+    if(isInvalidHead(*head, __func__) || (task == NULL))
     {
         return;
     }
 
-    struct node_t* sentinel = *head;
+    queue_push(queueFromHead(*head), task);
+}
+
 
-    // Check if the queue is empty
-    if(is_empty(&sentinel))
+///-------------------------------------------------
+/// @brief  Push a new task onto a queue using a
+///         node from the pool
+///
+/// @param[in] head The head of the task queue
+/// @param[in] task The task to push onto the queue
+/// @param[in] pool The pool to take the node from
+///-------------------------------------------------
+void push_pooled(struct node_t** head, struct task_t* task, struct node_pool_t* pool)
+{
+    // Validate parameters
+    if(isInvalidHead(*head, __func__) || (task == NULL) || (queueFromHead(*head)->pool != pool))
     {
-        // Link the new node to the sentinel
-        sentinel->next = create_new_node(task);
+        return;
     }
-    else
-    {
-        struct node_t* nextNode = sentinel->next;
-        struct node_t* currentNode;
 
-        // Traverse queue until you find the sentinel
-        while(nextNode != NULL)
-        {
-            currentNode = nextNode;
-            nextNode = nextNode->next;
-        }
-
-        // Insert new node at the end of the task queue
-        struct node_t* newNode = create_new_node(task);
-        currentNode->next = newNode;
-    }
+    queue_push(queueFromHead(*head), task);
 }
 
 
@@ -170,31 +219,637 @@ int is_empty(struct node_t** head)
 
 
 ///-------------------------------------------------
-/// @brief  Traverse the queue and free all memory
-///         aside from the sentinel
+/// @brief  Free every node in the queue along with
+///         the sentinel
 ///
 /// @param[in] head The head of the queue to empty
 ///-------------------------------------------------
 void empty_queue(struct node_t** head)
 {
-    // Check if the queue is empty
-    if(is_empty(head))
+    // Check if queue is uninitialized or isn't
+    // the head of a queue
+    if((*head == NULL) || isInvalidHead(*head, __func__))
     {
         return;
     }
 
-    struct node_t* currentNode = *head;
-    struct node_t* nextNode;
+    destroy_task_queue(queueFromHead(*head));
 
-    // Traverse the queue and free each node
-    while(currentNode != NULL)
+    *head = NULL;
+}
+
+
+///-------------------------------------------------
+/// @brief  Construct a queue descriptor holding
+///         the given tasks
+///
+/// @param[in] task Array of tasks to queue
+/// @param[in] size The number of tasks to queue
+/// @param[in] pool The pool to take nodes from
+///                 (NULL: malloc)
+///
+/// @return The queue descriptor
+///-------------------------------------------------
+struct queue_t* create_task_queue(struct task_t* task, int size, struct node_pool_t* pool)
+{
+    // Validate parameters
+    if(((task == NULL) && (size > 0)) || (size < 0))
     {
-        nextNode = currentNode->next;
-        free(currentNode);
-        currentNode = nextNode;
+        return NULL;
     }
 
-    *head = NULL;
+    struct queue_t* queue = (struct queue_t*)trackedMalloc(sizeof(struct queue_t), 0);
+
+    if(queue == NULL)
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't create queue!\n", __func__);
+        return NULL;
+    }
+
+    // The sentinel sits at the base of the queue
+    queue->sentinel.task = NULL;
+    queue->sentinel.next = NULL;
+    queue->tail = &(queue->sentinel);
+    queue->size = 0;
+    queue->pool = pool;
+
+    // Create and link nodes together to form the queue
+    // NOTE: The first "true" node in the queue is linked to the sentinel
+    for(int i = 0; i < size; i++)
+    {
+        queue_push(queue, &(task[i]));
+
+        // Verify that the allocation didn't fail
+        if(queue->size != (i + 1))
+        {
+            destroy_task_queue(queue);
+            return NULL;
+        }
+    }
+
+    return queue;
+}
+
+
+///-------------------------------------------------
+/// @brief Returns the top-most task for the queue
+///
+/// @param[in] queue The queue
+/// 
+/// @return The top-most task
+///-------------------------------------------------
+struct task_t* queue_peek(struct queue_t* queue)
+{
+    if(queue_is_empty(queue))
+    {
+        return NULL;
+    }
+
+    // NOTE: The base of the queue is a sentinel
+    //       therefore the first task node is
+    //       linked to it
+    return queue->sentinel.next->task;
+}
+
+
+///-------------------------------------------------
+/// @brief  Pop the top-most task off the queue
+///
+/// @param[in] queue The queue
+///-------------------------------------------------
+void queue_pop(struct queue_t* queue)
+{
+    // Check if the queue is invalid or empty
+    if(queue_is_empty(queue))
+    {
+        return;
+    }
+
+    struct node_t* nodeToPop = queue->sentinel.next;
+
+    // Pop the top-most task node from the queue
+    queue->sentinel.next = nodeToPop->next;
+
+    // Check if the last task node was popped
+    if(queue->sentinel.next == NULL)
+    {
+        queue->tail = &(queue->sentinel);
+    }
+
+    queue->size--;
+    releaseNode(queue->pool, nodeToPop);
+}
+
+
+///-------------------------------------------------
+/// @brief  Push a new task onto the end of the
+///         queue using the tail pointer
+///
+/// @param[in] queue The queue
+/// @param[in] task The task to push onto the queue
+///-------------------------------------------------
+void queue_push(struct queue_t* queue, struct task_t* task)
+{
+    // Validate parameters
+    if((queue == NULL) || (task == NULL))
+    {
+        return;
+    }
+
+    struct node_t* newNode = allocNode(queue->pool, task);
+
+    // Verify that the allocation didn't fail
+    if(isInvalidNode(newNode, __func__))
+    {
+        return;
+    }
+
+    // Insert new node at the end of the task queue
+    // NOTE: The tail is the sentinel if the queue
+    //       is empty
+    queue->tail->next = newNode;
+    newNode->next = NULL;
+    queue->tail = newNode;
+    queue->size++;
+}
+
+
+///-------------------------------------------------
+/// @brief  Number of tasks in the queue
+///
+/// @param[in] queue The queue
+///
+/// @return The number of queued tasks
+///-------------------------------------------------
+int queue_size(struct queue_t* queue)
+{
+    return (queue != NULL) ? queue->size : 0;
+}
+
+
+///-------------------------------------------------
+/// @brief  Check if the queue is empty
+///
+/// @param[in] queue The queue
+///
+/// @return True/False
+///-------------------------------------------------
+int queue_is_empty(struct queue_t* queue)
+{
+    return ((queue == NULL) || (queue->sentinel.next == NULL));
+}
+
+
+///-------------------------------------------------
+/// @brief  Free every node in the queue and the
+///         queue descriptor itself
+///
+/// @param[in] queue The queue to free
+///-------------------------------------------------
+void destroy_task_queue(struct queue_t* queue)
+{
+    if(queue == NULL)
+    {
+        return;
+    }
+
+    while(!queue_is_empty(queue))
+    {
+        queue_pop(queue);
+    }
+
+    trackedFree(queue, sizeof(struct queue_t), 0);
+}
+
+
+///-------------------------------------------------
+/// @brief  Initialize an empty intrusive queue
+///
+/// @param[in] list The intrusive queue
+///-------------------------------------------------
+void task_list_init(struct task_list_t* list)
+{
+    list->head = NULL;
+    list->tail = NULL;
+    list->size = 0;
+}
+
+
+///-------------------------------------------------
+/// @brief Returns the top-most task for the
+///        intrusive queue
+///
+/// @param[in] list The intrusive queue
+/// 
+/// @return The top-most task link
+///-------------------------------------------------
+struct task_link_t* task_list_peek(struct task_list_t* list)
+{
+    return list->head;
+}
+
+
+///-------------------------------------------------
+/// @brief  Pop the top-most task off the intrusive
+///         queue
+///
+/// @param[in] list The intrusive queue
+///-------------------------------------------------
+void task_list_pop(struct task_list_t* list)
+{
+    if(task_list_is_empty(list))
+    {
+        return;
+    }
+
+    struct task_link_t* linkToPop = list->head;
+
+    list->head = linkToPop->next;
+    linkToPop->next = NULL;
+    list->size--;
+
+    if(list->head == NULL)
+    {
+        list->tail = NULL;
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Push a task onto the end of the
+///         intrusive queue
+///
+/// @param[in] list The intrusive queue
+/// @param[in] link The task to push onto the queue
+///-------------------------------------------------
+void task_list_push(struct task_list_t* list, struct task_link_t* link)
+{
+    if(link == NULL)
+    {
+        return;
+    }
+
+    link->next = NULL;
+
+    if(task_list_is_empty(list))
+    {
+        list->head = link;
+    }
+    else
+    {
+        list->tail->next = link;
+    }
+
+    list->tail = link;
+    list->size++;
+}
+
+
+///-------------------------------------------------
+/// @brief  Check if the intrusive queue is empty
+///
+/// @param[in] list The intrusive queue
+///
+/// @return True/False
+///-------------------------------------------------
+int task_list_is_empty(struct task_list_t* list)
+{
+    return (list->head == NULL);
+}
+
+
+///-------------------------------------------------
+/// @brief  Sort the intrusive queue with a stable
+///         bottom-up merge sort. Runs are relinked
+///         in place, so no memory is allocated.
+///
+/// @param[in] list The intrusive queue
+/// @param[in] compare Returns non-zero if taskA
+///                    must be queued after taskB
+///-------------------------------------------------
+void task_list_sort(struct task_list_t* list, int (*compare)(struct task_t* taskA, struct task_t* taskB))
+{
+    for(int width = 1; width < list->size; width *= 2)
+    {
+        struct task_link_t* remaining = list->head;
+        struct task_link_t* mergedHead = NULL;
+        struct task_link_t* mergedTail = NULL;
+
+        // Merge neighbouring runs of the current width
+        while(remaining != NULL)
+        {
+            struct task_link_t* left = remaining;
+            struct task_link_t* right = splitRun(left, width);
+            remaining = splitRun(right, width);
+
+            mergeRuns(left, right, compare, &mergedHead, &mergedTail);
+        }
+
+        list->head = mergedHead;
+        list->tail = mergedTail;
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Construct an empty node pool
+///
+/// @param[in] slabSize Number of nodes to allocate
+///                     each time the pool runs dry
+///
+/// @return The node pool
+///-------------------------------------------------
+struct node_pool_t* create_node_pool(int slabSize)
+{
+    // Validate parameters
+    if(slabSize < 1)
+    {
+        return NULL;
+    }
+
+    struct node_pool_t* pool = (struct node_pool_t*)trackedMalloc(sizeof(struct node_pool_t), 0);
+
+    if(pool == NULL)
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't create node pool!\n", __func__);
+        return NULL;
+    }
+
+    pool->slabs = NULL;
+    pool->freeList = NULL;
+    pool->slabSize = slabSize;
+    pool->slabUsed = 0;
+    pool->slabCount = 0;
+
+    return pool;
+}
+
+
+///-------------------------------------------------
+/// @brief  Take a node from the pool, recycling
+///         freed nodes before carving new ones
+///
+/// @param[in] pool The node pool
+/// @param[in] task Task to attach to the node
+///
+/// @return The node
+///-------------------------------------------------
+struct node_t* pool_alloc_node(struct node_pool_t* pool, struct task_t* task)
+{
+    if(pool == NULL)
+    {
+        return NULL;
+    }
+
+    struct node_t* newNode;
+
+    if(pool->freeList != NULL)
+    {
+        // Reuse the most recently freed node
+        newNode = pool->freeList;
+        pool->freeList = newNode->next;
+    }
+    else
+    {
+        // Allocate a new slab once the current one is used up
+        if((pool->slabs == NULL) || (pool->slabUsed == pool->slabSize))
+        {
+            struct node_slab_t* slab = (struct node_slab_t*)trackedMalloc(sizeof(struct node_slab_t) + (pool->slabSize * sizeof(struct node_t)), 0);
+
+            if(slab == NULL)
+            {
+                fprintf(stderr, "%s() ERROR: Couldn't create node slab!\n", __func__);
+                return NULL;
+            }
+
+            slab->next = pool->slabs;
+            pool->slabs = slab;
+            pool->slabUsed = 0;
+            pool->slabCount++;
+        }
+
+        newNode = &(pool->slabs->nodes[pool->slabUsed++]);
+    }
+
+    // Initialize node data members
+    newNode->task = task;
+    newNode->next = NULL;
+
+    return newNode;
+}
+
+
+///-------------------------------------------------
+/// @brief  Return a node to the pool
+///
+/// @param[in] pool The node pool
+/// @param[in] node The node to recycle
+///-------------------------------------------------
+void pool_free_node(struct node_pool_t* pool, struct node_t* node)
+{
+    if((pool == NULL) || (node == NULL))
+    {
+        return;
+    }
+
+    node->task = NULL;
+    node->next = pool->freeList;
+    pool->freeList = node;
+}
+
+
+///-------------------------------------------------
+/// @brief  Free every slab owned by the pool, then
+///         the pool itself
+///
+/// @param[in] pool The node pool to free
+///-------------------------------------------------
+void destroy_node_pool(struct node_pool_t* pool)
+{
+    if(pool == NULL)
+    {
+        return;
+    }
+
+    struct node_slab_t* slab = pool->slabs;
+
+    while(slab != NULL)
+    {
+        struct node_slab_t* nextSlab = slab->next;
+        trackedFree(slab, sizeof(struct node_slab_t) + (pool->slabSize * sizeof(struct node_t)), 0);
+        slab = nextSlab;
+    }
+
+    trackedFree(pool, sizeof(struct node_pool_t), 0);
+}
+
+
+///-------------------------------------------------
+/// @brief  Turn allocation tracking on for good
+///
+/// @return None
+///-------------------------------------------------
+void queue_alloc_enable_tracking(void)
+{
+    __atomic_store_n(&allocTracking, 1, __ATOMIC_RELAXED);
+}
+
+
+///-------------------------------------------------
+/// @brief  Read the allocation counters
+///
+/// @param[out] stats The counters
+///
+/// @return None
+///-------------------------------------------------
+void queue_alloc_stats(struct queue_alloc_stats_t* stats)
+{
+    stats->live_nodes = __atomic_load_n(&allocStats.live_nodes, __ATOMIC_RELAXED);
+    stats->peak_nodes = __atomic_load_n(&allocStats.peak_nodes, __ATOMIC_RELAXED);
+    stats->live_bytes = __atomic_load_n(&allocStats.live_bytes, __ATOMIC_RELAXED);
+    stats->peak_bytes = __atomic_load_n(&allocStats.peak_bytes, __ATOMIC_RELAXED);
+    stats->mallocs = __atomic_load_n(&allocStats.mallocs, __ATOMIC_RELAXED);
+    stats->frees = __atomic_load_n(&allocStats.frees, __ATOMIC_RELAXED);
+}
+
+
+///-------------------------------------------------
+/// @brief  Restart the peaks from the live counts
+///
+/// @return None
+///-------------------------------------------------
+void queue_alloc_reset_peak(void)
+{
+    __atomic_store_n(&allocStats.peak_nodes, __atomic_load_n(&allocStats.live_nodes, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+    __atomic_store_n(&allocStats.peak_bytes, __atomic_load_n(&allocStats.live_bytes, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+}
+
+
+///-------------------------------------------------
+/// @brief  Map the head of a queue back to its
+///         descriptor
+///
+/// @param[in] head The sentinel of the queue
+///
+/// @return The queue descriptor
+///-------------------------------------------------
+static struct queue_t* queueFromHead(struct node_t* head)
+{
+    // NOTE: The sentinel is embedded in the
+    //       descriptor
+    return (struct queue_t*)((char*)head - offsetof(struct queue_t, sentinel));
+}
+
+
+///-------------------------------------------------
+/// @brief  Construct a node from the pool, or with
+///         malloc if there is no pool
+///
+/// @param[in] pool The node pool (may be NULL)
+/// @param[in] task Task to attach to the node
+///
+/// @return The newly created task node
+///-------------------------------------------------
+static struct node_t* allocNode(struct node_pool_t* pool, struct task_t* task)
+{
+    return (pool != NULL) ? pool_alloc_node(pool, task) : create_new_node(task);
+}
+
+
+///-------------------------------------------------
+/// @brief  Return a node to the pool, or free it
+///         if there is no pool
+///
+/// @param[in] pool The node pool (may be NULL)
+/// @param[in] node The node to release
+///-------------------------------------------------
+static void releaseNode(struct node_pool_t* pool, struct node_t* node)
+{
+    if(pool != NULL)
+    {
+        pool_free_node(pool, node);
+    }
+    else
+    {
+        trackedFree(node, sizeof(struct node_t), 1);
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Cut a run of tasks off the front of a
+///         chain of links
+///
+/// @param[in] run First link of the run
+/// @param[in] length Number of links in the run
+///
+/// @return The first link after the run
+///-------------------------------------------------
+static struct task_link_t* splitRun(struct task_link_t* run, int length)
+{
+    for(int i = 1; (run != NULL) && (i < length); i++)
+    {
+        run = run->next;
+    }
+
+    if(run == NULL)
+    {
+        return NULL;
+    }
+
+    struct task_link_t* rest = run->next;
+    run->next = NULL;
+
+    return rest;
+}
+
+
+///-------------------------------------------------
+/// @brief  Merge two sorted runs onto the end of
+///         an output chain
+///
+/// @param[in] left First run (wins ties)
+/// @param[in] right Second run
+/// @param[in] compare Returns non-zero if taskA
+///                    must be queued after taskB
+/// @param[in,out] head First link of the output
+/// @param[in,out] tail Last link of the output
+///-------------------------------------------------
+static void mergeRuns(struct task_link_t* left, struct task_link_t* right, int (*compare)(struct task_t* taskA, struct task_t* taskB),
+                      struct task_link_t** head, struct task_link_t** tail)
+{
+    while((left != NULL) || (right != NULL))
+    {
+        struct task_link_t* nextLink;
+
+        // Take from the left run on ties to stay stable
+        if((right == NULL) || ((left != NULL) && !compare(&(left->task), &(right->task))))
+        {
+            nextLink = left;
+            left = left->next;
+        }
+        else
+        {
+            nextLink = right;
+            right = right->next;
+        }
+
+        if(*head == NULL)
+        {
+            *head = nextLink;
+        }
+        else
+        {
+            (*tail)->next = nextLink;
+        }
+
+        *tail = nextLink;
+    }
+
+    if(*tail != NULL)
+    {
+        (*tail)->next = NULL;
+    }
 }
 
 
@@ -215,4 +870,104 @@ static int isInvalidNode(struct node_t* node, const char* caller)
     }
 
     return 0;
+}
+
+
+///-------------------------------------------------
+/// @brief  Validates that a node is the sentinel
+///         of a queue
+///
+/// @param[in] head The node to validate
+/// @param[in] caller Should always pass in __func__
+///
+/// @return 1: Invalid head; 0: Valid head
+///-------------------------------------------------
+static int isInvalidHead(struct node_t* head, const char* caller)
+{
+    if(head == NULL)
+    {
+        fprintf(stderr, "%s() ERROR: Queue is uninitialized!\n", caller);
+        return 1;
+    }
+
+    // NOTE: Only sentinels carry no task, and
+    //       every sentinel is embedded in a queue
+    //       descriptor
+    if(head->task != NULL)
+    {
+        fprintf(stderr, "%s() ERROR: Not the head of a queue!\n", caller);
+        return 1;
+    }
+
+    return 0;
+}
+
+
+///-------------------------------------------------
+/// @brief  malloc that feeds the allocation
+///         counters while tracking is on
+///
+/// @param[in] size Bytes to allocate
+/// @param[in] nodes Nodes the bytes hold (0 or 1)
+///
+/// @return The memory, NULL on failure
+///-------------------------------------------------
+static void* trackedMalloc(size_t size, int nodes)
+{
+    void* pointer = malloc(size);
+
+    if((pointer != NULL) && __atomic_load_n(&allocTracking, __ATOMIC_RELAXED))
+    {
+        __atomic_add_fetch(&allocStats.mallocs, 1, __ATOMIC_RELAXED);
+        raisePeak(&allocStats.peak_bytes, __atomic_add_fetch(&allocStats.live_bytes, (long long)size, __ATOMIC_RELAXED));
+
+        if(nodes)
+        {
+            raisePeak(&allocStats.peak_nodes, __atomic_add_fetch(&allocStats.live_nodes, nodes, __ATOMIC_RELAXED));
+        }
+    }
+
+    return pointer;
+}
+
+
+///-------------------------------------------------
+/// @brief  free that feeds the allocation counters
+///         while tracking is on
+///
+/// @param[in] pointer Memory from trackedMalloc()
+/// @param[in] size Bytes it was allocated with
+/// @param[in] nodes Nodes the bytes hold (0 or 1)
+///
+/// @return None
+///-------------------------------------------------
+static void trackedFree(void* pointer, size_t size, int nodes)
+{
+    if((pointer != NULL) && __atomic_load_n(&allocTracking, __ATOMIC_RELAXED))
+    {
+        __atomic_add_fetch(&allocStats.frees, 1, __ATOMIC_RELAXED);
+        __atomic_sub_fetch(&allocStats.live_bytes, (long long)size, __ATOMIC_RELAXED);
+        __atomic_sub_fetch(&allocStats.live_nodes, nodes, __ATOMIC_RELAXED);
+    }
+
+    free(pointer);
+}
+
+
+///-------------------------------------------------
+/// @brief  Raise a peak counter to a live count
+///
+/// @param[in] peak The peak counter
+/// @param[in] live The live count
+///
+/// @return None
+///-------------------------------------------------
+static void raisePeak(long long* peak, long long live)
+{
+    long long seen = __atomic_load_n(peak, __ATOMIC_RELAXED);
+
+    // Retry until the peak is at least the live count
+    while((live > seen) && !__atomic_compare_exchange_n(peak, &seen, live, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
 }
\ No newline at end of file
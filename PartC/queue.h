@@ -16,6 +16,82 @@ struct node_t {
     struct node_t* next;
 };
 
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds a contiguous block of nodes owned by a Node Pool
+//----------------------------------------------------------------------------------------------------------------------------------
+struct node_slab_t {
+    // Previously allocated slab
+    struct node_slab_t* next;
+
+    // Nodes handed out by this slab
+    struct node_t nodes[];
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds the Node Pool information. Nodes are carved out of slabs in order
+/// and recycled through a free list, so steady-state push/pop never reaches malloc/free.
+//----------------------------------------------------------------------------------------------------------------------------------
+struct node_pool_t {
+    // Most recently allocated slab
+    struct node_slab_t* slabs;
+
+    // Nodes returned to the pool, linked through their next pointer
+    struct node_t* freeList;
+
+    // Number of nodes in each slab
+    int slabSize;
+
+    // Number of nodes handed out of the most recent slab
+    int slabUsed;
+
+    // Number of slabs allocated so far
+    int slabCount;
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds the Queue descriptor. The head returned by create_queue() is the
+/// address of the embedded sentinel, so the node_t** API can reach the descriptor in O(1).
+//----------------------------------------------------------------------------------------------------------------------------------
+struct queue_t {
+    // Sentinel node at the base of the queue (must stay the first member)
+    struct node_t sentinel;
+
+    // Last node in the queue (the sentinel when the queue is empty)
+    struct node_t* tail;
+
+    // Number of tasks in the queue
+    int size;
+
+    // Pool nodes are taken from (NULL: malloc/free)
+    struct node_pool_t* pool;
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds a Task together with its intrusive queue link. Queuing a task_link_t
+/// needs no node allocation.
+//----------------------------------------------------------------------------------------------------------------------------------
+struct task_link_t {
+    // Task information
+    struct task_t task;
+
+    // Pointer to the next task in the queue
+    struct task_link_t* next;
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds the Intrusive Queue information
+//----------------------------------------------------------------------------------------------------------------------------------
+struct task_list_t {
+    // First task in the queue
+    struct task_link_t* head;
+
+    // Last task in the queue
+    struct task_link_t* tail;
+
+    // Number of tasks in the queue
+    int size;
+};
+
 //----------------------------------------------------------------------------------------------------------------------------------
 /// @brief Creates a queue.
 ///
@@ -27,9 +103,10 @@ struct node_t {
 struct node_t* create_queue(struct task_t* task, int size);
 
 //----------------------------------------------------------------------------------------------------------------------------------
-/// @brief Create a new node for the queue
+/// @brief Create a new node for the queue. Without a task the node is the head of a new, empty queue
+/// (the sentinel of a queue descriptor) that push() and pop() accept.
 ///
-/// @param task The task information
+/// @param task The task information (NULL: head of an empty queue)
 ///
 /// @return a newly allocated task
 //----------------------------------------------------------------------------------------------------------------------------------
@@ -38,7 +115,8 @@ struct node_t* create_new_node(struct task_t* task);
 //----------------------------------------------------------------------------------------------------------------------------------
 /// @brief Returns the top node in the queue
 ///
-/// @param head The head of the queue
+/// @param head The head of the queue. Heads come from create_queue(), create_queue_from_pool(),
+/// create_new_node(NULL) or the sentinel of create_task_queue(); any other node is rejected
 ///
 /// @return the task at the top of the queue
 //----------------------------------------------------------------------------------------------------------------------------------
@@ -47,14 +125,14 @@ struct task_t* peek(struct node_t** head);
 //----------------------------------------------------------------------------------------------------------------------------------
 /// @brief Removes the element at the top of the queue.
 ///
-/// @param head The head of the queue.
+/// @param head The head of the queue (see peek() for where heads come from).
 //----------------------------------------------------------------------------------------------------------------------------------
 void pop(struct node_t** head);
 
 //----------------------------------------------------------------------------------------------------------------------------------
 /// @brief Push a new task into the queue
 ///
-/// @param head The head of the queue
+/// @param head The head of the queue (see peek() for where heads come from)
 /// @param task The task to be put into the queue
 //----------------------------------------------------------------------------------------------------------------------------------
 void push(struct node_t** head, struct task_t* task);
@@ -69,10 +147,218 @@ void push(struct node_t** head, struct task_t* task);
 int is_empty(struct node_t** head);
 
 //----------------------------------------------------------------------------------------------------------------------------------
-/// @brief Remove all items from the queue
+/// @brief Remove all items from the queue, along with the queue itself
 ///
-/// @param head The head of the queue
+/// @param head The head of the queue (see peek() for where heads come from)
 //----------------------------------------------------------------------------------------------------------------------------------
 void empty_queue(struct node_t** head);
 
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Creates a node pool
+///
+/// @param[in] slabSize The number of nodes allocated at once when the pool runs dry
+///
+/// @return the new node pool
+//----------------------------------------------------------------------------------------------------------------------------------
+struct node_pool_t* create_node_pool(int slabSize);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Take a node from the pool
+///
+/// @param pool The node pool
+/// @param task The task information
+///
+/// @return a node from the pool
+//----------------------------------------------------------------------------------------------------------------------------------
+struct node_t* pool_alloc_node(struct node_pool_t* pool, struct task_t* task);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Return a node to the pool
+///
+/// @param pool The node pool
+/// @param node The node to recycle
+//----------------------------------------------------------------------------------------------------------------------------------
+void pool_free_node(struct node_pool_t* pool, struct node_t* node);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Free the pool and every node it handed out
+///
+/// @param pool The node pool
+//----------------------------------------------------------------------------------------------------------------------------------
+void destroy_node_pool(struct node_pool_t* pool);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Creates a queue whose nodes come from a node pool.
+///
+/// @param[in] task The task information
+/// @param[in] size The size of the task array
+/// @param[in] pool The node pool
+///
+/// @return the head of the new queue
+//----------------------------------------------------------------------------------------------------------------------------------
+struct node_t* create_queue_from_pool(struct task_t* task, int size, struct node_pool_t* pool);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Push a new task into a queue created from a node pool
+///
+/// @param head The head of the queue
+/// @param task The task to be put into the queue
+/// @param pool The node pool
+//----------------------------------------------------------------------------------------------------------------------------------
+void push_pooled(struct node_t** head, struct task_t* task, struct node_pool_t* pool);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Removes the element at the top of a queue created from a node pool.
+///
+/// @param head The head of the queue.
+/// @param pool The node pool
+//----------------------------------------------------------------------------------------------------------------------------------
+void pop_pooled(struct node_t** head, struct node_pool_t* pool);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Creates a queue descriptor.
+///
+/// @param[in] task The task information (may be NULL if size is 0)
+/// @param[in] size The size of the task array
+/// @param[in] pool The node pool to take nodes from (NULL to use malloc)
+///
+/// @return the new queue
+//----------------------------------------------------------------------------------------------------------------------------------
+struct queue_t* create_task_queue(struct task_t* task, int size, struct node_pool_t* pool);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Returns the top task in the queue
+///
+/// @param queue The queue
+///
+/// @return the task at the top of the queue
+//----------------------------------------------------------------------------------------------------------------------------------
+struct task_t* queue_peek(struct queue_t* queue);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Removes the task at the top of the queue.
+///
+/// @param queue The queue
+//----------------------------------------------------------------------------------------------------------------------------------
+void queue_pop(struct queue_t* queue);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Push a new task onto the end of the queue in constant time
+///
+/// @param queue The queue
+/// @param task The task to be put into the queue
+//----------------------------------------------------------------------------------------------------------------------------------
+void queue_push(struct queue_t* queue, struct task_t* task);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Returns the number of tasks in the queue
+///
+/// @param queue The queue
+///
+/// @return the number of queued tasks
+//----------------------------------------------------------------------------------------------------------------------------------
+int queue_size(struct queue_t* queue);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Determines whether the queue is empty.
+///
+/// @param queue The queue
+///
+/// @return True if the queue is empty, False otherwise.
+//----------------------------------------------------------------------------------------------------------------------------------
+int queue_is_empty(struct queue_t* queue);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Free the queue descriptor and its nodes
+///
+/// @param queue The queue
+//----------------------------------------------------------------------------------------------------------------------------------
+void destroy_task_queue(struct queue_t* queue);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Initialize an empty intrusive queue
+///
+/// @param list The intrusive queue
+//----------------------------------------------------------------------------------------------------------------------------------
+void task_list_init(struct task_list_t* list);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Returns the top task in the intrusive queue
+///
+/// @param list The intrusive queue
+///
+/// @return the task link at the top of the queue
+//----------------------------------------------------------------------------------------------------------------------------------
+struct task_link_t* task_list_peek(struct task_list_t* list);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Removes the task at the top of the intrusive queue.
+///
+/// @param list The intrusive queue
+//----------------------------------------------------------------------------------------------------------------------------------
+void task_list_pop(struct task_list_t* list);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Push a task onto the end of the intrusive queue (the task must not already be queued)
+///
+/// @param list The intrusive queue
+/// @param link The task to be put into the queue
+//----------------------------------------------------------------------------------------------------------------------------------
+void task_list_push(struct task_list_t* list, struct task_link_t* link);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Determines whether the intrusive queue is empty.
+///
+/// @param list The intrusive queue
+///
+/// @return True if the queue is empty, False otherwise.
+//----------------------------------------------------------------------------------------------------------------------------------
+int task_list_is_empty(struct task_list_t* list);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Stable merge sort of the intrusive queue, relinking tasks in place
+///
+/// @param list The intrusive queue
+/// @param compare Returns non-zero if taskA must be queued after taskB
+//----------------------------------------------------------------------------------------------------------------------------------
+void task_list_sort(struct task_list_t* list, int (*compare)(struct task_t* taskA, struct task_t* taskB));
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds the queue allocation counters. Nodes are the ones create_new_node()
+/// mallocs (pooled nodes belong to their pool); bytes cover every malloc of the queue layer: nodes,
+/// queue descriptors, node pools and their slabs.
+//----------------------------------------------------------------------------------------------------------------------------------
+struct queue_alloc_stats_t {
+    // Nodes allocated and not freed yet, and the most there were at once
+    long long live_nodes;
+    long long peak_nodes;
+
+    // Bytes allocated and not freed yet, and the most there were at once
+    long long live_bytes;
+    long long peak_bytes;
+
+    // Calls to malloc and free
+    long long mallocs;
+    long long frees;
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Turn allocation tracking on (off by default). There is no way back, so a queue is never
+/// freed uncounted after being counted. Turn it on before the first queue is created: memory
+/// allocated before is still subtracted when it's freed.
+//----------------------------------------------------------------------------------------------------------------------------------
+void queue_alloc_enable_tracking(void);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Read the allocation counters
+///
+/// @param stats The counters
+//----------------------------------------------------------------------------------------------------------------------------------
+void queue_alloc_stats(struct queue_alloc_stats_t* stats);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Restart the peaks from the live counts
+//----------------------------------------------------------------------------------------------------------------------------------
+void queue_alloc_reset_peak(void);
+
 #endif // __QUEUE__
\ No newline at end of file
@@ -0,0 +1,482 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sjf.h"
+#include "queue.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC
+#endif
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Times the linked-list queue primitives in isolation across queue sizes and reports the
+/// median and median absolute deviation of ns/op and cycles/op, plus allocations/op
+///
+/// @Usage
+/// make bench   (or ./queuebench [operation]; build with CCFLAGS="-O2 ..." for optimized numbers)
+///
+/// @Note
+/// Allocations are counted by wrapping malloc/calloc/realloc at link time (-Wl,--wrap), so the
+/// queue code is measured unmodified. Cycles are time stamp counter ticks (reference cycles).
+//----------------------------------------------------------------------------------------------------------------------------------
+
+// Untimed repetitions run first, then the timed ones the medians come from
+#define BENCH_WARMUP 3
+#define BENCH_REPETITIONS 15
+
+// Each repetition runs about this many tasks through the queue, split into rounds
+#define BENCH_TASKS_PER_REPETITION (1 << 16)
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds the queues and tasks of one benchmark repetition
+//----------------------------------------------------------------------------------------------------------------------------------
+struct bench_state_t {
+    // Tasks the queues hold
+    struct task_t* task;
+    int size;
+
+    // One queue per round
+    struct node_t** head;
+    int rounds;
+
+    // Keeps the compiler from dropping peeks
+    volatile int sink;
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which describes a benchmarked primitive: prepare and cleanup are untimed
+//----------------------------------------------------------------------------------------------------------------------------------
+struct bench_case_t {
+    const char* name;
+    void (*prepare)(struct bench_state_t* state);
+    void (*run)(struct bench_state_t* state);
+    void (*cleanup)(struct bench_state_t* state);
+
+    // Non-zero if every task is one operation, otherwise every round is
+    int perTask;
+};
+
+// Allocations seen by the wrapped allocator
+static unsigned long long benchAllocations = 0;
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* pointer, size_t size);
+
+static void prepareNothing(struct bench_state_t* state);
+static void prepareEmptyQueues(struct bench_state_t* state);
+static void prepareFullQueues(struct bench_state_t* state);
+static void prepareOneQueue(struct bench_state_t* state);
+static void runCreateQueue(struct bench_state_t* state);
+static void runPush(struct bench_state_t* state);
+static void runPop(struct bench_state_t* state);
+static void runPeek(struct bench_state_t* state);
+static void runEmptyQueue(struct bench_state_t* state);
+static void cleanupQueues(struct bench_state_t* state);
+static void runCase(const struct bench_case_t* benchCase, int size);
+static double nowNanoseconds(void);
+static unsigned long long readCycles(void);
+static double median(double* value, int count);
+static double medianDeviation(const double* value, int count, double center);
+static int compareDoubles(const void* valueA, const void* valueB);
+
+static const struct bench_case_t benchCases[] = {
+    {"create_queue", prepareNothing, runCreateQueue, cleanupQueues, 0},
+    {"push", prepareEmptyQueues, runPush, cleanupQueues, 1},
+    {"pop", prepareFullQueues, runPop, cleanupQueues, 1},
+    {"peek", prepareOneQueue, runPeek, cleanupQueues, 1},
+    {"empty_queue", prepareFullQueues, runEmptyQueue, cleanupQueues, 0},
+};
+
+static const int benchSizes[] = {16, 256, 4096, 65536};
+
+
+int main(int argc, const char *argv[])
+{
+    const char* only = (argc > 1) ? argv[1] : NULL;
+
+    printf("Queue primitives: %d warmup + %d timed repetitions, median +/- MAD\n\n", BENCH_WARMUP, BENCH_REPETITIONS);
+    printf("%-16s %8s %24s %24s %12s\n", "operation", "size", "ns/op", "cycles/op", "allocs/op");
+
+    for(size_t i = 0; i < sizeof(benchCases) / sizeof(benchCases[0]); i++)
+    {
+        if((only != NULL) && (strcmp(only, benchCases[i].name) != 0))
+        {
+            continue;
+        }
+
+        for(size_t j = 0; j < sizeof(benchSizes) / sizeof(benchSizes[0]); j++)
+        {
+            runCase(&(benchCases[i]), benchSizes[j]);
+        }
+    }
+
+    return 0;
+}
+
+
+///-------------------------------------------------
+/// @brief  Counting wrappers around the allocator
+///         (linked in with -Wl,--wrap)
+///-------------------------------------------------
+void* __wrap_malloc(size_t size)
+{
+    benchAllocations++;
+    return __real_malloc(size);
+}
+
+
+void* __wrap_calloc(size_t count, size_t size)
+{
+    benchAllocations++;
+    return __real_calloc(count, size);
+}
+
+
+void* __wrap_realloc(void* pointer, size_t size)
+{
+    benchAllocations++;
+    return __real_realloc(pointer, size);
+}
+
+
+///-------------------------------------------------
+/// @brief  Times one primitive at one queue size
+///
+/// @param[in] benchCase The primitive
+/// @param[in] size Number of tasks per queue
+///
+/// @return None
+///-------------------------------------------------
+static void runCase(const struct bench_case_t* benchCase, int size)
+{
+    struct bench_state_t state;
+    double nanoseconds[BENCH_REPETITIONS];
+    double cycles[BENCH_REPETITIONS];
+    unsigned long long allocations = 0;
+
+    state.size = size;
+    state.rounds = (size < BENCH_TASKS_PER_REPETITION) ? (BENCH_TASKS_PER_REPETITION / size) : 1;
+    state.task = (struct task_t*)malloc(size * sizeof(struct task_t));
+    state.head = (struct node_t**)calloc(state.rounds, sizeof(struct node_t*));
+
+    if((state.task == NULL) || (state.head == NULL))
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't allocate the benchmark!\n", __func__);
+        free(state.task);
+        free(state.head);
+        return;
+    }
+
+    long long operations = benchCase->perTask ? ((long long)state.rounds * size) : state.rounds;
+
+    for(int repetition = 0; repetition < BENCH_WARMUP + BENCH_REPETITIONS; repetition++)
+    {
+        // Fresh tasks every repetition
+        for(int i = 0; i < size; i++)
+        {
+            state.task[i].process_id = i;
+            state.task[i].execution_time = i + 1;
+            state.task[i].waiting_time = 0;
+            state.task[i].turnaround_time = 0;
+        }
+
+        benchCase->prepare(&state);
+
+        unsigned long long allocationsBefore = benchAllocations;
+        unsigned long long cyclesBefore = readCycles();
+        double start = nowNanoseconds();
+
+        benchCase->run(&state);
+
+        double elapsed = nowNanoseconds() - start;
+        unsigned long long cyclesElapsed = readCycles() - cyclesBefore;
+        unsigned long long allocated = benchAllocations - allocationsBefore;
+
+        benchCase->cleanup(&state);
+
+        if(repetition >= BENCH_WARMUP)
+        {
+            nanoseconds[repetition - BENCH_WARMUP] = elapsed / operations;
+            cycles[repetition - BENCH_WARMUP] = (double)cyclesElapsed / operations;
+            allocations += allocated;
+        }
+    }
+
+    double nanosecondsMedian = median(nanoseconds, BENCH_REPETITIONS);
+    double cyclesMedian = median(cycles, BENCH_REPETITIONS);
+    char nanosecondsText[32];
+    char cyclesText[32];
+
+    snprintf(nanosecondsText, sizeof(nanosecondsText), "%.2f +/- %.2f", nanosecondsMedian, medianDeviation(nanoseconds, BENCH_REPETITIONS, nanosecondsMedian));
+
+#ifdef BENCH_HAVE_TSC
+    snprintf(cyclesText, sizeof(cyclesText), "%.1f +/- %.1f", cyclesMedian, medianDeviation(cycles, BENCH_REPETITIONS, cyclesMedian));
+#else
+    (void)cyclesMedian;
+    snprintf(cyclesText, sizeof(cyclesText), "n/a");
+#endif
+
+    printf("%-16s %8d %24s %24s %12.3f\n", benchCase->name, size, nanosecondsText, cyclesText,
+           (double)allocations / ((double)operations * BENCH_REPETITIONS));
+
+    free(state.task);
+    free(state.head);
+}
+
+
+///-------------------------------------------------
+/// @brief  Leaves every round without a queue
+///
+/// @param[in] state The benchmark state
+///
+/// @return None
+///-------------------------------------------------
+static void prepareNothing(struct bench_state_t* state)
+{
+    memset(state->head, 0, state->rounds * sizeof(struct node_t*));
+}
+
+
+///-------------------------------------------------
+/// @brief  Gives every round an empty queue
+///
+/// @param[in] state The benchmark state
+///
+/// @return None
+///-------------------------------------------------
+static void prepareEmptyQueues(struct bench_state_t* state)
+{
+    for(int round = 0; round < state->rounds; round++)
+    {
+        struct queue_t* queue = create_task_queue(NULL, 0, NULL);
+        state->head[round] = (queue != NULL) ? &(queue->sentinel) : NULL;
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Gives every round a queue of all tasks
+///
+/// @param[in] state The benchmark state
+///
+/// @return None
+///-------------------------------------------------
+static void prepareFullQueues(struct bench_state_t* state)
+{
+    for(int round = 0; round < state->rounds; round++)
+    {
+        state->head[round] = create_queue(state->task, state->size);
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Builds a single queue of all tasks
+///
+/// @param[in] state The benchmark state
+///
+/// @return None
+///-------------------------------------------------
+static void prepareOneQueue(struct bench_state_t* state)
+{
+    prepareNothing(state);
+    state->head[0] = create_queue(state->task, state->size);
+}
+
+
+///-------------------------------------------------
+/// @brief  Times create_queue(), once per round
+///
+/// @param[in] state The benchmark state
+///
+/// @return None
+///-------------------------------------------------
+static void runCreateQueue(struct bench_state_t* state)
+{
+    for(int round = 0; round < state->rounds; round++)
+    {
+        state->head[round] = create_queue(state->task, state->size);
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Times push(), filling every round's
+///         queue from empty
+///
+/// @param[in] state The benchmark state
+///
+/// @return None
+///-------------------------------------------------
+static void runPush(struct bench_state_t* state)
+{
+    for(int round = 0; round < state->rounds; round++)
+    {
+        for(int i = 0; i < state->size; i++)
+        {
+            push(&(state->head[round]), &(state->task[i]));
+        }
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Times pop(), draining every round's
+///         queue
+///
+/// @param[in] state The benchmark state
+///
+/// @return None
+///-------------------------------------------------
+static void runPop(struct bench_state_t* state)
+{
+    for(int round = 0; round < state->rounds; round++)
+    {
+        for(int i = 0; i < state->size; i++)
+        {
+            pop(&(state->head[round]));
+        }
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Times peek() on a single queue
+///
+/// @param[in] state The benchmark state
+///
+/// @return None
+///-------------------------------------------------
+static void runPeek(struct bench_state_t* state)
+{
+    long long operations = (long long)state->rounds * state->size;
+    int sum = 0;
+
+    for(long long i = 0; i < operations; i++)
+    {
+        sum += peek(&(state->head[0]))->process_id;
+    }
+
+    state->sink = sum;
+}
+
+
+///-------------------------------------------------
+/// @brief  Times empty_queue(), once per round
+///
+/// @param[in] state The benchmark state
+///
+/// @return None
+///-------------------------------------------------
+static void runEmptyQueue(struct bench_state_t* state)
+{
+    for(int round = 0; round < state->rounds; round++)
+    {
+        empty_queue(&(state->head[round]));
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Frees whatever queues the rounds hold
+///
+/// @param[in] state The benchmark state
+///
+/// @return None
+///-------------------------------------------------
+static void cleanupQueues(struct bench_state_t* state)
+{
+    for(int round = 0; round < state->rounds; round++)
+    {
+        empty_queue(&(state->head[round]));
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Reads the monotonic clock
+///
+/// @return Nanoseconds since an arbitrary point
+///-------------------------------------------------
+static double nowNanoseconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double)now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+
+///-------------------------------------------------
+/// @brief  Reads the time stamp counter
+///
+/// @return Ticks since an arbitrary point (0 if
+///         there is no counter)
+///-------------------------------------------------
+static unsigned long long readCycles(void)
+{
+#ifdef BENCH_HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+
+///-------------------------------------------------
+/// @brief  Median of an array (sorts it)
+///
+/// @param[in] value The array
+/// @param[in] count Number of values
+///
+/// @return The median
+///-------------------------------------------------
+static double median(double* value, int count)
+{
+    qsort(value, count, sizeof(double), compareDoubles);
+
+    return (count % 2) ? value[count / 2] : ((value[count / 2 - 1] + value[count / 2]) / 2.0);
+}
+
+
+///-------------------------------------------------
+/// @brief  Median absolute deviation of an array
+///
+/// @param[in] value The array
+/// @param[in] count Number of values
+/// @param[in] center Median of the array
+///
+/// @return The median absolute deviation
+///-------------------------------------------------
+static double medianDeviation(const double* value, int count, double center)
+{
+    double deviation[count];
+
+    for(int i = 0; i < count; i++)
+    {
+        deviation[i] = (value[i] > center) ? (value[i] - center) : (center - value[i]);
+    }
+
+    return median(deviation, count);
+}
+
+
+///-------------------------------------------------
+/// @brief  qsort() comparator for doubles
+///         (ascending)
+///
+/// @param[in] valueA Pointer to the first double
+/// @param[in] valueB Pointer to the second double
+///
+/// @return <0, 0 or >0 like strcmp()
+///-------------------------------------------------
+static int compareDoubles(const void* valueA, const void* valueB)
+{
+    double a = *(const double*)valueA;
+    double b = *(const double*)valueB;
+
+    return (a > b) - (a < b);
+}
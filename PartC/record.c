@@ -0,0 +1,333 @@
+#include <string.h>
+#include <limits.h>
+#include "record.h"
+
+
+static struct dispatch_log_t* activeLog = NULL;
+
+static int growLog(struct dispatch_log_t* log);
+
+
+///-------------------------------------------------
+/// @brief  Creates an empty dispatch log
+///
+/// @param[in] capacity Records to preallocate
+///
+/// @return The dispatch log
+///-------------------------------------------------
+struct dispatch_log_t* create_dispatch_log(size_t capacity)
+{
+    struct dispatch_log_t* log = (struct dispatch_log_t*)malloc(sizeof(struct dispatch_log_t));
+
+    if(log == NULL)
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't create dispatch log!\n", __func__);
+        return NULL;
+    }
+
+    if(capacity < 1)
+    {
+        capacity = 1;
+    }
+
+    log->records = (struct dispatch_record_t*)malloc(capacity * sizeof(struct dispatch_record_t));
+    log->size = 0;
+    log->capacity = capacity;
+    log->dropped = 0;
+
+    // Verify that malloc didn't fail
+    if(log->records == NULL)
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't create dispatch log!\n", __func__);
+        free(log);
+        return NULL;
+    }
+
+    return log;
+}
+
+
+///-------------------------------------------------
+/// @brief  Makes the schedulers record into a log
+///
+/// @param[in] log The log to record into
+///
+/// @return None
+///-------------------------------------------------
+void dispatch_log_start(struct dispatch_log_t* log)
+{
+    activeLog = log;
+}
+
+
+///-------------------------------------------------
+/// @brief  Stops recording dispatches
+///
+/// @return None
+///-------------------------------------------------
+void dispatch_log_stop(void)
+{
+    activeLog = NULL;
+}
+
+
+///-------------------------------------------------
+/// @brief  Appends a dispatch to the active log
+///
+/// @param[in] time Start of the slice
+/// @param[in] processId Task that ran
+/// @param[in] slice Length of the slice
+/// @param[in] priorityBefore Priority at dispatch
+/// @param[in] priorityAfter Priority after aging
+///
+/// @return None
+///-------------------------------------------------
+void dispatch_log_record(int time, int processId, int slice, int priorityBefore, int priorityAfter)
+{
+    dispatch_log_append(activeLog, time, processId, slice, priorityBefore, priorityAfter);
+}
+
+
+///-------------------------------------------------
+/// @brief  Appends a dispatch to a log
+///
+/// @param[in] log The log to append to
+/// @param[in] time Start of the slice
+/// @param[in] processId Task that ran
+/// @param[in] slice Length of the slice
+/// @param[in] priorityBefore Priority at dispatch
+/// @param[in] priorityAfter Priority after aging
+///
+/// @return None
+///-------------------------------------------------
+void dispatch_log_append(struct dispatch_log_t* log, int time, int processId, int slice, int priorityBefore, int priorityAfter)
+{
+    if(log == NULL)
+    {
+        return;
+    }
+
+    if((log->size == log->capacity) && (growLog(log) != 0))
+    {
+        log->dropped++;
+        return;
+    }
+
+    struct dispatch_record_t* record = &(log->records[log->size++]);
+
+    record->time = time;
+    record->process_id = processId;
+    record->slice = slice;
+    record->priority_before = priorityBefore;
+    record->priority_after = priorityAfter;
+}
+
+
+///-------------------------------------------------
+/// @brief  Returns the log being recorded into
+///
+/// @return The active log, NULL if none
+///-------------------------------------------------
+struct dispatch_log_t* dispatch_log_active(void)
+{
+    return activeLog;
+}
+
+
+///-------------------------------------------------
+/// @brief  Writes a dispatch log to a binary file
+///
+/// @param[in] log The dispatch log
+/// @param[in] path File to write
+///
+/// @return 0 on success, -1 on failure
+///-------------------------------------------------
+int dispatch_log_write(struct dispatch_log_t* log, const char* path)
+{
+    // Validate parameters
+    if((log == NULL) || (path == NULL))
+    {
+        return -1;
+    }
+
+    // The header counts records in an int
+    if(log->size > INT_MAX)
+    {
+        fprintf(stderr, "%s() ERROR: %zu records don't fit in a log file!\n", __func__, log->size);
+        return -1;
+    }
+
+    FILE* file = fopen(path, "wb");
+
+    if(file == NULL)
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't open %s!\n", __func__, path);
+        return -1;
+    }
+
+    struct dispatch_log_header_t header;
+
+    memcpy(header.magic, DISPATCH_LOG_MAGIC, sizeof(header.magic));
+    header.version = DISPATCH_LOG_VERSION;
+    header.record_size = sizeof(struct dispatch_record_t);
+    header.count = (int)log->size;
+
+    int failed = (fwrite(&header, sizeof(header), 1, file) != 1) ||
+                 (fwrite(log->records, sizeof(struct dispatch_record_t), log->size, file) != log->size);
+
+    if(fclose(file) != 0)
+    {
+        failed = 1;
+    }
+
+    if(failed)
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't write %s!\n", __func__, path);
+        return -1;
+    }
+
+    return 0;
+}
+
+
+///-------------------------------------------------
+/// @brief  Reads a dispatch log from a binary file
+///
+/// @param[in] path File to read
+///
+/// @return The dispatch log, NULL on failure
+///-------------------------------------------------
+struct dispatch_log_t* dispatch_log_read(const char* path)
+{
+    if(path == NULL)
+    {
+        return NULL;
+    }
+
+    FILE* file = fopen(path, "rb");
+
+    if(file == NULL)
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't open %s!\n", __func__, path);
+        return NULL;
+    }
+
+    struct dispatch_log_header_t header;
+
+    // Verify the file describes records of this layout
+    if((fread(&header, sizeof(header), 1, file) != 1) ||
+       (memcmp(header.magic, DISPATCH_LOG_MAGIC, sizeof(header.magic)) != 0) ||
+       (header.version != DISPATCH_LOG_VERSION) ||
+       (header.record_size != sizeof(struct dispatch_record_t)) ||
+       (header.count < 0))
+    {
+        fprintf(stderr, "%s() ERROR: %s isn't a dispatch log!\n", __func__, path);
+        fclose(file);
+        return NULL;
+    }
+
+    struct dispatch_log_t* log = create_dispatch_log(header.count);
+
+    if(log == NULL)
+    {
+        fclose(file);
+        return NULL;
+    }
+
+    log->size = fread(log->records, sizeof(struct dispatch_record_t), header.count, file);
+    fclose(file);
+
+    if(log->size != (size_t)header.count)
+    {
+        fprintf(stderr, "%s() ERROR: %s is truncated!\n", __func__, path);
+        destroy_dispatch_log(log);
+        return NULL;
+    }
+
+    return log;
+}
+
+
+///-------------------------------------------------
+/// @brief  Exports a dispatch log as Chrome
+///         trace-event JSON
+///
+/// @param[in] log The dispatch log
+/// @param[in] out Stream to write to
+///
+/// @return 0 on success, -1 on failure
+///-------------------------------------------------
+int dispatch_log_export_json(struct dispatch_log_t* log, FILE* out)
+{
+    // Validate parameters
+    if((log == NULL) || (out == NULL))
+    {
+        return -1;
+    }
+
+    fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    for(size_t i = 0; i < log->size; i++)
+    {
+        struct dispatch_record_t* record = &(log->records[i]);
+
+        // One complete ("X") event per slice, on the
+        // task's own track
+        fprintf(out, "{\"name\":\"Task[%d]\",\"cat\":\"dispatch\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+                     "\"ts\":%d,\"dur\":%d,\"args\":{\"priority_before\":%d,\"priority_after\":%d}}%s\n",
+                record->process_id, record->process_id, record->time, record->slice,
+                record->priority_before, record->priority_after, (i + 1 < log->size) ? "," : "");
+    }
+
+    fprintf(out, "]}\n");
+
+    return ferror(out) ? -1 : 0;
+}
+
+
+///-------------------------------------------------
+/// @brief  Frees a dispatch log
+///
+/// @param[in] log The dispatch log
+///
+/// @return None
+///-------------------------------------------------
+void destroy_dispatch_log(struct dispatch_log_t* log)
+{
+    if(log == NULL)
+    {
+        return;
+    }
+
+    if(activeLog == log)
+    {
+        activeLog = NULL;
+    }
+
+    free(log->records);
+    free(log);
+}
+
+
+///-------------------------------------------------
+/// @brief  Doubles the room in a dispatch log
+///
+/// @param[in] log The dispatch log
+///
+/// @return 0 on success, -1 on failure
+///-------------------------------------------------
+static int growLog(struct dispatch_log_t* log)
+{
+    size_t capacity = log->capacity * 2;
+    struct dispatch_record_t* records = (struct dispatch_record_t*)realloc(log->records, capacity * sizeof(struct dispatch_record_t));
+
+    if(records == NULL)
+    {
+        return -1;
+    }
+
+    log->records = records;
+    log->capacity = capacity;
+
+    return 0;
+}
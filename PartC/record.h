@@ -0,0 +1,144 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef __DISPATCH_RECORD__
+#define __DISPATCH_RECORD__
+
+// Identifies a dispatch log file
+#define DISPATCH_LOG_MAGIC "DLOG"
+
+// Version of the dispatch log file layout
+#define DISPATCH_LOG_VERSION 1
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds a single dispatch (fixed size, written to disk as is)
+//----------------------------------------------------------------------------------------------------------------------------------
+struct dispatch_record_t {
+    // Runtime at which the slice started
+    int time;
+
+    // Process number of the task that ran
+    int process_id;
+
+    // Length of the slice
+    int slice;
+
+    // Priority of the task when it was dispatched, and after the aging rules ran
+    int priority_before;
+    int priority_after;
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds an append-only log of dispatches
+//----------------------------------------------------------------------------------------------------------------------------------
+struct dispatch_log_t {
+    // Recorded dispatches
+    struct dispatch_record_t* records;
+
+    // Number of records, and room in the records buffer
+    size_t size;
+    size_t capacity;
+
+    // Dispatches that couldn't be recorded because the buffer couldn't grow
+    size_t dropped;
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Header of a dispatch log file (followed by the records)
+//----------------------------------------------------------------------------------------------------------------------------------
+struct dispatch_log_header_t {
+    char magic[4];
+    int version;
+    int record_size;
+    int count;
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Creates an empty dispatch log
+///
+/// @param[in] capacity Number of records to preallocate
+///
+/// @return the new dispatch log
+//----------------------------------------------------------------------------------------------------------------------------------
+struct dispatch_log_t* create_dispatch_log(size_t capacity);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Make the schedulers record their dispatches into a log
+///
+/// @param[in] log The log to record into (NULL to stop recording)
+//----------------------------------------------------------------------------------------------------------------------------------
+void dispatch_log_start(struct dispatch_log_t* log);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Stop recording dispatches
+//----------------------------------------------------------------------------------------------------------------------------------
+void dispatch_log_stop(void);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Append a dispatch to the active log (does nothing if no log is active)
+///
+/// @param[in] time Runtime at which the slice started
+/// @param[in] processId Process number of the task that ran
+/// @param[in] slice Length of the slice
+/// @param[in] priorityBefore Priority when the task was dispatched
+/// @param[in] priorityAfter Priority after the aging rules ran
+//----------------------------------------------------------------------------------------------------------------------------------
+void dispatch_log_record(int time, int processId, int slice, int priorityBefore, int priorityAfter);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Append a dispatch to a log (does nothing if the log is NULL)
+///
+/// @param[in] log The log to append to
+/// @param[in] time Runtime at which the slice started
+/// @param[in] processId Process number of the task that ran
+/// @param[in] slice Length of the slice
+/// @param[in] priorityBefore Priority when the task was dispatched
+/// @param[in] priorityAfter Priority after the aging rules ran
+//----------------------------------------------------------------------------------------------------------------------------------
+void dispatch_log_append(struct dispatch_log_t* log, int time, int processId, int slice, int priorityBefore, int priorityAfter);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Returns the log started with dispatch_log_start()
+///
+/// @return the active log, NULL if dispatches aren't being recorded
+//----------------------------------------------------------------------------------------------------------------------------------
+struct dispatch_log_t* dispatch_log_active(void);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Write a dispatch log to a binary file (logs of more than INT_MAX records are refused)
+///
+/// @param[in] log The dispatch log
+/// @param[in] path Path of the file to write
+///
+/// @return 0 on success, -1 on failure
+//----------------------------------------------------------------------------------------------------------------------------------
+int dispatch_log_write(struct dispatch_log_t* log, const char* path);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Read a dispatch log from a binary file
+///
+/// @param[in] path Path of the file to read
+///
+/// @return the dispatch log, NULL on failure
+//----------------------------------------------------------------------------------------------------------------------------------
+struct dispatch_log_t* dispatch_log_read(const char* path);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Export a dispatch log as Chrome trace-event JSON (opens in Perfetto or chrome://tracing).
+/// Each task gets its own track; one runtime unit is shown as one microsecond.
+///
+/// @param[in] log The dispatch log
+/// @param[in] out Stream to write the JSON to
+///
+/// @return 0 on success, -1 on failure
+//----------------------------------------------------------------------------------------------------------------------------------
+int dispatch_log_export_json(struct dispatch_log_t* log, FILE* out);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Free a dispatch log (stops recording if it is the active log)
+///
+/// @param[in] log The dispatch log
+//----------------------------------------------------------------------------------------------------------------------------------
+void destroy_dispatch_log(struct dispatch_log_t* log);
+
+#endif // __DISPATCH_RECORD__
@@ -0,0 +1,457 @@
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "sjf.h"
+#include "generator.h"
+#include "trace.h"
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Runs the shortest job first engines over geometrically growing workloads and fits the
+/// empirical complexity exponent of each: the slope of log(time) against log(tasks) with the work
+/// per task fixed, and against log(total work) with the task count fixed. Fails if a fit exceeds
+/// the bound, which flags a sort or queue that went quadratic.
+///
+/// @Usage
+/// ./scalebench [-f csv|json] [-b max exponent] [-t seconds per point] [-e engine] [-a tasks|work] [-s seed]
+/// Exit status is 1 if any fitted exponent exceeds the bound (no bound without -b).
+//----------------------------------------------------------------------------------------------------------------------------------
+
+// Timed runs per point (the fastest one counts)
+#define SCALE_REPETITIONS 3
+
+// Points faster than this are dominated by fixed costs and left out of the fits
+#define SCALE_MIN_FIT_SECONDS 1e-3
+
+// Task counts of the tasks axis, and the fixed count of the work axis (large enough that a
+// point takes longer than SCALE_MIN_FIT_SECONDS)
+#define SCALE_FIRST_TASKS 64
+#define SCALE_MAX_TASKS (1 << 22)
+#define SCALE_WORK_TASKS (1 << 16)
+
+// Execution times are uniform in [1, SCALE_TASK_WORK] on the tasks axis; the work axis doubles the
+// bound from SCALE_TASK_WORK until the total work would overflow the scheduler's int runtime
+#define SCALE_TASK_WORK 16
+
+// Longest sweep (points per axis)
+#define SCALE_MAX_POINTS 32
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds one measured workload
+//----------------------------------------------------------------------------------------------------------------------------------
+struct scale_point_t {
+    int tasks;
+    long long work;
+    double seconds;
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds the sweep of one engine along one axis and its fit
+//----------------------------------------------------------------------------------------------------------------------------------
+struct scale_sweep_t {
+    const char* engine;
+    const char* axis;
+    struct scale_point_t point[SCALE_MAX_POINTS];
+    int count;
+
+    // Fitted exponent (NAN with fewer than 2 points above SCALE_MIN_FIT_SECONDS)
+    double exponent;
+};
+
+// Engines to measure (parallel runs shortest_job_first_parallel() on every online CPU)
+static const struct {
+    const char* name;
+    enum sjf_engine_t engine;
+    int parallel;
+} scaleEngines[] = {
+    {"queue", SJF_ENGINE_QUEUE, 0},
+    {"prefix_sum", SJF_ENGINE_PREFIX_SUM, 0},
+    {"parallel", SJF_ENGINE_PREFIX_SUM, 1},
+};
+
+static int runSweep(struct scale_sweep_t* sweep, enum sjf_engine_t engine, int parallel, int workAxis, unsigned long long seed, double budget);
+static int measurePoint(struct scale_point_t* point, enum sjf_engine_t engine, int parallel, int tasks, int maxWork, unsigned long long seed);
+static double fitExponent(const struct scale_sweep_t* sweep, int workAxis);
+static double nowSeconds(void);
+static void printCsv(const struct scale_sweep_t* sweep, int count);
+static void printJson(const struct scale_sweep_t* sweep, int count, double bound);
+
+
+int main(int argc, char *argv[])
+{
+    const char* format = "csv";
+    const char* onlyEngine = NULL;
+    const char* onlyAxis = NULL;
+    double bound = INFINITY;
+    double budget = 0.5;
+    unsigned long long seed = 1;
+    int option;
+
+    while((option = getopt(argc, argv, "f:b:t:e:a:s:")) != -1)
+    {
+        switch(option)
+        {
+            case 'f':
+                format = optarg;
+                break;
+
+            case 'b':
+                bound = atof(optarg);
+                break;
+
+            case 't':
+                budget = atof(optarg);
+                break;
+
+            case 'e':
+                onlyEngine = optarg;
+                break;
+
+            case 'a':
+                onlyAxis = optarg;
+                break;
+
+            case 's':
+                seed = strtoull(optarg, NULL, 0);
+                break;
+
+            default:
+                fprintf(stderr, "usage: %s [-f csv|json] [-b max exponent] [-t seconds per point] [-e engine] [-a tasks|work] [-s seed]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    static struct scale_sweep_t sweep[2 * sizeof(scaleEngines) / sizeof(scaleEngines[0])];
+    int count = 0;
+
+    // The schedulers' own output would swamp the timings
+    trace_set_level(TRACE_LEVEL_OFF);
+
+    for(size_t i = 0; i < sizeof(scaleEngines) / sizeof(scaleEngines[0]); i++)
+    {
+        if((onlyEngine != NULL) && (strcmp(onlyEngine, scaleEngines[i].name) != 0))
+        {
+            continue;
+        }
+
+        for(int workAxis = 0; workAxis < 2; workAxis++)
+        {
+            const char* axis = workAxis ? "work" : "tasks";
+
+            if((onlyAxis != NULL) && (strcmp(onlyAxis, axis) != 0))
+            {
+                continue;
+            }
+
+            sweep[count].engine = scaleEngines[i].name;
+            sweep[count].axis = axis;
+
+            if(runSweep(&(sweep[count]), scaleEngines[i].engine, scaleEngines[i].parallel, workAxis, seed, budget) != 0)
+            {
+                return 1;
+            }
+
+            count++;
+        }
+    }
+
+    if(strcmp(format, "json") == 0)
+    {
+        printJson(sweep, count, bound);
+    }
+    else
+    {
+        printCsv(sweep, count);
+    }
+
+    // Flag every fit over the bound
+    int failed = 0;
+
+    for(int i = 0; i < count; i++)
+    {
+        if(sweep[i].exponent > bound)
+        {
+            fprintf(stderr, "%s: %s engine scales as %s^%.2f (bound %.2f)\n", argv[0], sweep[i].engine, sweep[i].axis, sweep[i].exponent, bound);
+            failed = 1;
+        }
+    }
+
+    return failed;
+}
+
+
+///-------------------------------------------------
+/// @brief  Measures an engine over geometrically
+///         growing workloads until a point takes
+///         longer than the budget, then fits it
+///
+/// @param[in] sweep The sweep to fill
+/// @param[in] engine The engine to run
+/// @param[in] parallel Run the parallel scheduler
+/// @param[in] workAxis Grow the work per task
+///                     instead of the task count
+/// @param[in] seed Workload generator seed
+/// @param[in] budget Seconds a point may take
+///
+/// @return 0 on success, -1 on failure
+///-------------------------------------------------
+static int runSweep(struct scale_sweep_t* sweep, enum sjf_engine_t engine, int parallel, int workAxis, unsigned long long seed, double budget)
+{
+    int tasks = workAxis ? SCALE_WORK_TASKS : SCALE_FIRST_TASKS;
+    int maxWork = SCALE_TASK_WORK;
+
+    sweep->count = 0;
+
+    while(sweep->count < SCALE_MAX_POINTS)
+    {
+        struct scale_point_t* point = &(sweep->point[sweep->count]);
+
+        if(measurePoint(point, engine, parallel, tasks, maxWork, seed) != 0)
+        {
+            return -1;
+        }
+
+        sweep->count++;
+
+        if(point->seconds > budget)
+        {
+            break;
+        }
+
+        // Double the axis while the runtime still fits
+        // in an int
+        if(workAxis)
+        {
+            if((long long)tasks * maxWork * 2 > INT_MAX)
+            {
+                break;
+            }
+
+            maxWork *= 2;
+        }
+        else
+        {
+            if((tasks * 2 > SCALE_MAX_TASKS) || ((long long)tasks * 2 * maxWork > INT_MAX))
+            {
+                break;
+            }
+
+            tasks *= 2;
+        }
+    }
+
+    sweep->exponent = fitExponent(sweep, workAxis);
+
+    return 0;
+}
+
+
+///-------------------------------------------------
+/// @brief  Times an engine on one generated
+///         workload
+///
+/// @param[in] point The point to fill
+/// @param[in] engine The engine to run
+/// @param[in] parallel Run the parallel scheduler
+/// @param[in] tasks Number of tasks
+/// @param[in] maxWork Largest execution time
+/// @param[in] seed Workload generator seed
+///
+/// @return 0 on success, -1 on failure
+///-------------------------------------------------
+static int measurePoint(struct scale_point_t* point, enum sjf_engine_t engine, int parallel, int tasks, int maxWork, unsigned long long seed)
+{
+    struct generator_config_t config;
+
+    generator_default_config(&config, seed);
+    config.execution_max = maxWork;
+
+    struct generator_t* generator = create_generator(&config);
+    struct task_t* workload = (struct task_t*)malloc(tasks * sizeof(struct task_t));
+    struct task_t* task = (struct task_t*)malloc(tasks * sizeof(struct task_t));
+
+    if((generator == NULL) || (workload == NULL) || (task == NULL))
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't create a workload of %d tasks!\n", __func__, tasks);
+        destroy_generator(generator);
+        free(workload);
+        free(task);
+        return -1;
+    }
+
+    generate_tasks(generator, workload, tasks);
+
+    point->tasks = tasks;
+    point->work = 0;
+    point->seconds = INFINITY;
+
+    for(int i = 0; i < tasks; i++)
+    {
+        point->work += workload[i].execution_time;
+    }
+
+    for(int repetition = 0; repetition < SCALE_REPETITIONS; repetition++)
+    {
+        memcpy(task, workload, tasks * sizeof(struct task_t));
+
+        double start = nowSeconds();
+        if(parallel)
+        {
+            shortest_job_first_parallel(task, tasks, 0);
+        }
+        else
+        {
+            shortest_job_first_engine(task, tasks, engine);
+        }
+        double elapsed = nowSeconds() - start;
+
+        if(elapsed < point->seconds)
+        {
+            point->seconds = elapsed;
+        }
+
+        // One run is enough when it is already slow
+        if(elapsed > 0.25)
+        {
+            break;
+        }
+    }
+
+    destroy_generator(generator);
+    free(workload);
+    free(task);
+
+    return 0;
+}
+
+
+///-------------------------------------------------
+/// @brief  Least squares slope of log(seconds)
+///         against log(size) over the points slow
+///         enough to measure the algorithm
+///
+/// @param[in] sweep The measured sweep
+/// @param[in] workAxis Fit against the total work
+///                     instead of the task count
+///
+/// @return The exponent, NAN without two points
+///-------------------------------------------------
+static double fitExponent(const struct scale_sweep_t* sweep, int workAxis)
+{
+    double sumX = 0.0;
+    double sumY = 0.0;
+    double sumXX = 0.0;
+    double sumXY = 0.0;
+    int count = 0;
+
+    for(int i = 0; i < sweep->count; i++)
+    {
+        const struct scale_point_t* point = &(sweep->point[i]);
+
+        if(point->seconds < SCALE_MIN_FIT_SECONDS)
+        {
+            continue;
+        }
+
+        double x = log(workAxis ? (double)point->work : (double)point->tasks);
+        double y = log(point->seconds);
+
+        sumX += x;
+        sumY += y;
+        sumXX += x * x;
+        sumXY += x * y;
+        count++;
+    }
+
+    double spread = count * sumXX - sumX * sumX;
+
+    if((count < 2) || (spread <= 0.0))
+    {
+        return NAN;
+    }
+
+    return (count * sumXY - sumX * sumY) / spread;
+}
+
+
+///-------------------------------------------------
+/// @brief  Reads the monotonic clock
+///
+/// @return Seconds since an arbitrary point
+///-------------------------------------------------
+static double nowSeconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double)now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+
+///-------------------------------------------------
+/// @brief  Prints the sweeps as CSV: one row per
+///         point, then one per fit
+///
+/// @param[in] sweep The sweeps
+/// @param[in] count Number of sweeps
+///
+/// @return None
+///-------------------------------------------------
+static void printCsv(const struct scale_sweep_t* sweep, int count)
+{
+    printf("record,engine,axis,tasks,work,seconds,exponent\n");
+
+    for(int i = 0; i < count; i++)
+    {
+        for(int j = 0; j < sweep[i].count; j++)
+        {
+            const struct scale_point_t* point = &(sweep[i].point[j]);
+
+            printf("point,%s,%s,%d,%lld,%.9f,\n", sweep[i].engine, sweep[i].axis, point->tasks, point->work, point->seconds);
+        }
+    }
+
+    for(int i = 0; i < count; i++)
+    {
+        printf("fit,%s,%s,,,,", sweep[i].engine, sweep[i].axis);
+        isnan(sweep[i].exponent) ? printf("\n") : printf("%.4f\n", sweep[i].exponent);
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Prints the sweeps as JSON
+///
+/// @param[in] sweep The sweeps
+/// @param[in] count Number of sweeps
+/// @param[in] bound Largest allowed exponent
+///
+/// @return None
+///-------------------------------------------------
+static void printJson(const struct scale_sweep_t* sweep, int count, double bound)
+{
+    printf("{\"scheduler\":\"sjf\",\"max_exponent\":");
+    isinf(bound) ? printf("null") : printf("%.4f", bound);
+    printf(",\"sweeps\":[\n");
+
+    for(int i = 0; i < count; i++)
+    {
+        printf("{\"engine\":\"%s\",\"axis\":\"%s\",\"exponent\":", sweep[i].engine, sweep[i].axis);
+        isnan(sweep[i].exponent) ? printf("null") : printf("%.4f", sweep[i].exponent);
+        printf(",\"points\":[");
+
+        for(int j = 0; j < sweep[i].count; j++)
+        {
+            const struct scale_point_t* point = &(sweep[i].point[j]);
+
+            printf("%s{\"tasks\":%d,\"work\":%lld,\"seconds\":%.9f}", (j > 0) ? "," : "", point->tasks, point->work, point->seconds);
+        }
+
+        printf("]}%s\n", (i + 1 < count) ? "," : "");
+    }
+
+    printf("]}\n");
+}
@@ -1,9 +1,109 @@
 #include "sjf.h"
 #include "queue.h"
+#include "sort.h"
+#include "trace.h"
+#include "record.h"
+#include "stats.h"
+#include "context.h"
+#include "workload.h"
 #include <stdio.h>
 
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Samples taken per thread to pick the sample sort splitters
+#define SJF_PARALLEL_OVERSAMPLE 32
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Shared state of the parallel scheduler workers
+//----------------------------------------------------------------------------------------------------------------------------------
+struct sjf_parallel_t {
+    // Task array and a scratch array of the same size
+    struct task_t* task;
+    struct task_t* scratch;
+
+    // Number of tasks and worker threads
+    int size;
+    int threads;
+
+    // Sample sort splitters (threads - 1 of them)
+    int* splitter;
+
+    // Tasks each worker sends to each bucket, then where they go ([worker * threads + bucket])
+    size_t* count;
+
+    // First task of each bucket (threads + 1 entries)
+    size_t* bucketStart;
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Per thread state of a parallel scheduler worker
+//----------------------------------------------------------------------------------------------------------------------------------
+struct sjf_worker_t {
+    // Shared state
+    struct sjf_parallel_t* shared;
+
+    // Worker index and the block of tasks it owns
+    int id;
+    int begin;
+    int end;
+
+    // Runtime before the first task of the block
+    unsigned int runTime;
+
+    // Sum of the block's execution, wait and turnaround times
+    unsigned int totalExecution;
+    long long totalWait;
+    long long totalTurnaround;
+
+    // Non-zero if the worker couldn't sort its bucket
+    int failed;
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Task in the ready set of the streaming scheduler
+//----------------------------------------------------------------------------------------------------------------------------------
+struct sjf_ready_t {
+    struct task_t task;
+
+    // Time at which the task arrived
+    int arrival;
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Ready set of the streaming scheduler: a binary min-heap on execution time, then process id
+//----------------------------------------------------------------------------------------------------------------------------------
+struct sjf_ready_set_t {
+    struct sjf_ready_t* heap;
+    int size;
+    int capacity;
+};
+
+static void defaultContext(struct sjf_context_t* context, enum sjf_engine_t engine);
+static void scheduleWithQueue(struct sjf_context_t* context, struct task_t* task, int size, struct online_stats_t* online);
+static void scheduleWithPrefixSum(struct sjf_context_t* context, struct task_t* task, int size, struct online_stats_t* online);
+static int prefixSumTimes(struct task_t* task, int size, int runTime);
+static void runWorkers(struct sjf_worker_t* worker, int threads, void* (*work)(void*));
+static int pickSplitters(struct sjf_parallel_t* shared);
+static int bucketOf(struct sjf_parallel_t* shared, int executionTime);
+static void* countBucketsWorker(void* arg);
+static void* scatterBucketsWorker(void* arg);
+static void* sortBucketWorker(void* arg);
+static void* sumBlockWorker(void* arg);
+static void* scanBlockWorker(void* arg);
+static int compareInts(const void* valueA, const void* valueB);
 static void swapTasks(struct task_t* taskA, struct task_t* taskB);
 static void sortTasksByExecutionTime(struct task_t* task, int size);
+static int isLongerJob(struct task_t* taskA, struct task_t* taskB);
+static int readNextArrival(struct workload_reader_t* reader, struct sjf_ready_t* next, int processId);
+static int readyPush(struct sjf_ready_set_t* ready, const struct sjf_ready_t* entry);
+static void readyPop(struct sjf_ready_set_t* ready, struct sjf_ready_t* entry);
+static int runsBefore(const struct sjf_ready_t* entryA, const struct sjf_ready_t* entryB);
 
 
 ///-------------------------------------------------
@@ -39,6 +139,190 @@ void init(struct task_t* task, int *execution, int size)
 /// @return None
 ///-------------------------------------------------
 void shortest_job_first(struct task_t* task, int size)
+{
+    shortest_job_first_engine(task, size, SJF_ENGINE_QUEUE);
+}
+
+
+///-------------------------------------------------
+/// @brief  Shortest Job First scheduler algorithm
+///         on the selected engine
+///
+/// @param[in] task The task queue array
+/// @param[in] size Size of the task queue array
+/// @param[in] engine The implementation to use
+///
+/// @return None
+///-------------------------------------------------
+void shortest_job_first_engine(struct task_t* task, int size, enum sjf_engine_t engine)
+{
+    struct sjf_context_t context;
+
+    defaultContext(&context, engine);
+    sjf_context_run(&context, task, size);
+}
+
+
+///-------------------------------------------------
+/// @brief  Creates a scheduler context
+///
+/// @param[in] engine The implementation to use
+/// @param[in] out Stream to trace to (NULL for
+///                no trace)
+///
+/// @return The context, NULL on failure
+///-------------------------------------------------
+struct sjf_context_t* create_sjf_context(enum sjf_engine_t engine, FILE* out)
+{
+    struct sjf_context_t* context = (struct sjf_context_t*)malloc(sizeof(struct sjf_context_t));
+    struct trace_buffer_t* trace = create_trace_buffer((out != NULL) ? TRACE_LEVEL_AGING : TRACE_LEVEL_OFF, out);
+
+    // Verify that malloc didn't fail
+    if((context == NULL) || (trace == NULL))
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't create scheduler context!\n", __func__);
+        destroy_trace_buffer(trace);
+        free(context);
+        return NULL;
+    }
+
+    context->engine = engine;
+    context->trace = trace;
+    context->log = NULL;
+    context->owned_log = NULL;
+    context->run_time = 0;
+    memset(&(context->stats), 0, sizeof(context->stats));
+
+    return context;
+}
+
+
+///-------------------------------------------------
+/// @brief  Shortest Job First scheduler algorithm
+///         running with a scheduler context
+///
+/// @param[in] context The scheduler context
+/// @param[in] task The task queue array
+/// @param[in] size Size of the task queue array
+///
+/// @return None
+///-------------------------------------------------
+void sjf_context_run(struct sjf_context_t* context, struct task_t* task, int size)
+{
+    // Statistics collected as tasks complete
+    struct online_stats_t online;
+    online_stats_init(&online);
+
+    context->run_time = 0;
+
+    switch(context->engine)
+    {
+        case SJF_ENGINE_PREFIX_SUM:
+            scheduleWithPrefixSum(context, task, size, &online);
+            break;
+
+        case SJF_ENGINE_QUEUE:
+        default:
+            scheduleWithQueue(context, task, size, &online);
+            break;
+    }
+
+    // Calculate average times
+    online_stats_read(&online, &(context->stats));
+
+    float avgWaitTime = (float)((double)context->stats.waitSum / size);
+    float avgTurnaroundTime = (float)((double)context->stats.turnaroundSum / size);
+
+    // Print average times
+    TRACE_TO(context->trace, TRACE_LEVEL_SUMMARY, "Average Wait Time: %f\n", avgWaitTime);
+    TRACE_TO(context->trace, TRACE_LEVEL_SUMMARY, "Average Turnaround Time: %f\n", avgTurnaroundTime);
+
+    // Write out the buffered trace
+    trace_buffer_flush(context->trace);
+}
+
+
+///-------------------------------------------------
+/// @brief  Creates a dispatch log owned by the
+///         context and records into it
+///
+/// @param[in] context The scheduler context
+/// @param[in] capacity Number of dispatches the
+///                     log holds
+///
+/// @return The log, NULL on failure
+///-------------------------------------------------
+struct dispatch_log_t* sjf_context_record(struct sjf_context_t* context, size_t capacity)
+{
+    struct dispatch_log_t* log = create_dispatch_log(capacity);
+
+    if(log == NULL)
+    {
+        return NULL;
+    }
+
+    destroy_dispatch_log(context->owned_log);
+
+    context->owned_log = log;
+    context->log = log;
+
+    return log;
+}
+
+
+///-------------------------------------------------
+/// @brief  Frees a scheduler context
+///
+/// @param[in] context The scheduler context
+///
+/// @return None
+///-------------------------------------------------
+void destroy_sjf_context(struct sjf_context_t* context)
+{
+    if(context == NULL)
+    {
+        return;
+    }
+
+    destroy_trace_buffer(context->trace);
+    destroy_dispatch_log(context->owned_log);
+    free(context);
+}
+
+
+///-------------------------------------------------
+/// @brief  Fills in a context that schedules like
+///         the context-free API: the process-wide
+///         trace and the active dispatch log
+///
+/// @param[out] context The context to fill in
+/// @param[in] engine The implementation to use
+///
+/// @return None
+///-------------------------------------------------
+static void defaultContext(struct sjf_context_t* context, enum sjf_engine_t engine)
+{
+    context->engine = engine;
+    context->trace = &trace_default;
+    context->log = dispatch_log_active();
+    context->owned_log = NULL;
+    context->run_time = 0;
+}
+
+
+///-------------------------------------------------
+/// @brief  Runs the sorted tasks through a linked
+///         task queue
+///
+/// @param[in] context The scheduler context
+/// @param[in] task The task queue array
+/// @param[in] size Size of the task queue array
+/// @param[in] online Statistics updated as tasks
+///                   complete
+///
+/// @return None
+///-------------------------------------------------
+static void scheduleWithQueue(struct sjf_context_t* context, struct task_t* task, int size, struct online_stats_t* online)
 {
     // Sort the task queue based on execution time (ascending order)
     sortTasksByExecutionTime(task, size);
@@ -47,7 +331,9 @@ void shortest_job_first(struct task_t* task, int size)
     int runTime = 0;
 
     // Construct a task queue from the task array
-    struct node_t* queue = create_queue(task, size);
+    // NOTE: Every task fits in a single slab
+    struct node_pool_t* pool = create_node_pool(size);
+    struct node_t* queue = create_queue_from_pool(task, size, pool);
     struct task_t* currentTask;
 
     while(!is_empty(&queue))
@@ -58,106 +344,997 @@ void shortest_job_first(struct task_t* task, int size)
         runTime += currentTask->execution_time;
         currentTask->turnaround_time = runTime;
 
-        pop(&queue);
+        pop_pooled(&queue, pool);
+        online_stats_add(online, currentTask);
 
         // Print times to console
-        printf("\nTask[%d] Execution Time: %d\n", currentTask->process_id, currentTask->execution_time);
-        printf("Task[%d] Wait Time: %d\n", currentTask->process_id, currentTask->waiting_time);
-        printf("Task[%d] Turnaround Time: %d\n", currentTask->process_id, currentTask->turnaround_time);
+        TRACE_TO(context->trace, TRACE_LEVEL_TASK, "\nTask[%d] Execution Time: %d\n", currentTask->process_id, currentTask->execution_time);
+        TRACE_TO(context->trace, TRACE_LEVEL_TASK, "Task[%d] Wait Time: %d\n", currentTask->process_id, currentTask->waiting_time);
+        TRACE_TO(context->trace, TRACE_LEVEL_TASK, "Task[%d] Turnaround Time: %d\n", currentTask->process_id, currentTask->turnaround_time);
+
+        // Record the dispatch (SJF has no priorities)
+        dispatch_log_append(context->log, currentTask->waiting_time, currentTask->process_id, currentTask->execution_time, 0, 0);
     }
-    
-    // Calculate average times
-    float avgWaitTime = calculate_average_wait_time(task, size);
-    float avgTurnaroundTime = calculate_average_turn_around_time(task, size);
 
-    // Print average times
-    printf("Average Wait Time: %f\n", avgWaitTime);
-    printf("Average Turnaround Time: %f\n", avgTurnaroundTime);
+    context->run_time = runTime;
 
     // Cleanup
-    free(queue->next);
-    free(queue);
+    empty_queue(&queue);
+    destroy_node_pool(pool);
 }
 
 
 ///-------------------------------------------------
-/// @brief  Calculate the average wait time of
-///         the tasks in the queue
+/// @brief  Computes the times of the sorted tasks
+///         directly: each task waits for the sum
+///         of the execution times before it
 ///
+/// @param[in] context The scheduler context
 /// @param[in] task The task queue array
 /// @param[in] size Size of the task queue array
+/// @param[in] online Statistics updated as tasks
+///                   complete
 ///
-/// @return Average wait time of all tasks in 
-///         the queue
+/// @return None
 ///-------------------------------------------------
-float calculate_average_wait_time(struct task_t* task, int size)
+static void scheduleWithPrefixSum(struct sjf_context_t* context, struct task_t* task, int size, struct online_stats_t* online)
 {
-    float totalTime = 0;
+    // Sort the task queue based on execution time (ascending order)
+    sortTasksByExecutionTime(task, size);
 
+    context->run_time = prefixSumTimes(task, size, 0);
+
+    // Print times to console
     for(int i = 0; i < size; i++)
     {
-        totalTime += task[i].waiting_time;
+        TRACE_TO(context->trace, TRACE_LEVEL_TASK, "\nTask[%d] Execution Time: %d\n", task[i].process_id, task[i].execution_time);
+        TRACE_TO(context->trace, TRACE_LEVEL_TASK, "Task[%d] Wait Time: %d\n", task[i].process_id, task[i].waiting_time);
+        TRACE_TO(context->trace, TRACE_LEVEL_TASK, "Task[%d] Turnaround Time: %d\n", task[i].process_id, task[i].turnaround_time);
+
+        // Record the dispatch (SJF has no priorities)
+        dispatch_log_append(context->log, task[i].waiting_time, task[i].process_id, task[i].execution_time, 0, 0);
+
+        online_stats_add(online, &(task[i]));
     }
-    
-    return totalTime / size;
 }
 
 
 ///-------------------------------------------------
-/// @brief  Calculate the average turnaround time of
-///         the tasks in the queue
+/// @brief  Writes the exclusive (wait time) and
+///         inclusive (turnaround time) prefix sums
+///         of the execution times. With SSE2, four
+///         tasks are transposed into registers and
+///         scanned at once.
 ///
-/// @return None
+/// @param[in] task The task array (in run order)
+/// @param[in] size Size of the task array
+/// @param[in] runTime Runtime before the first
+///                    task starts
+///
+/// @return Runtime after the last task completes
 ///-------------------------------------------------
-float calculate_average_turn_around_time(struct task_t* task, int size)
+static int prefixSumTimes(struct task_t* task, int size, int runTime)
 {
-    float totalTime = 0;
+    int i = 0;
+
+#ifdef __SSE2__
+    // NOTE: The kernel treats each task as one row
+    //       of four ints
+    _Static_assert(sizeof(struct task_t) == 4 * sizeof(int), "task_t must be four ints");
+
+    __m128i carry = _mm_set1_epi32(runTime);
+
+    for(; i + 4 <= size; i += 4)
+    {
+        __m128i* block = (__m128i*)&(task[i]);
+
+        // Transpose four tasks into id, execution,
+        // wait and turnaround columns
+        __m128i row0 = _mm_loadu_si128(block);
+        __m128i row1 = _mm_loadu_si128(block + 1);
+        __m128i row2 = _mm_loadu_si128(block + 2);
+        __m128i row3 = _mm_loadu_si128(block + 3);
+
+        __m128i low01 = _mm_unpacklo_epi32(row0, row1);
+        __m128i low23 = _mm_unpacklo_epi32(row2, row3);
+
+        __m128i processId = _mm_unpacklo_epi64(low01, low23);
+        __m128i execution = _mm_unpackhi_epi64(low01, low23);
+
+        // In-register inclusive scan of the column
+        __m128i sum = _mm_add_epi32(execution, _mm_slli_si128(execution, 4));
+        sum = _mm_add_epi32(sum, _mm_slli_si128(sum, 8));
+
+        __m128i turnaround = _mm_add_epi32(sum, carry);
+        __m128i waiting = _mm_sub_epi32(turnaround, execution);
+
+        // Broadcast the last turnaround time into the
+        // next block
+        carry = _mm_shuffle_epi32(turnaround, _MM_SHUFFLE(3, 3, 3, 3));
+
+        // Transpose back and store
+        __m128i idExecLow = _mm_unpacklo_epi32(processId, execution);
+        __m128i idExecHigh = _mm_unpackhi_epi32(processId, execution);
+        __m128i timesLow = _mm_unpacklo_epi32(waiting, turnaround);
+        __m128i timesHigh = _mm_unpackhi_epi32(waiting, turnaround);
+
+        _mm_storeu_si128(block, _mm_unpacklo_epi64(idExecLow, timesLow));
+        _mm_storeu_si128(block + 1, _mm_unpackhi_epi64(idExecLow, timesLow));
+        _mm_storeu_si128(block + 2, _mm_unpacklo_epi64(idExecHigh, timesHigh));
+        _mm_storeu_si128(block + 3, _mm_unpackhi_epi64(idExecHigh, timesHigh));
+    }
+
+    runTime = _mm_cvtsi128_si32(carry);
+#endif
 
+    // Remaining tasks
+    // NOTE: Wraps like the vector adds on overflow
+    for(; i < size; i++)
+    {
+        task[i].waiting_time = runTime;
+        runTime = (int)((unsigned int)runTime + (unsigned int)task[i].execution_time);
+        task[i].turnaround_time = runTime;
+    }
+
+    return runTime;
+}
+
+
+///-------------------------------------------------
+/// @brief  Initializes an array of linked tasks
+///
+/// @param[in] task The linked task array
+/// @param[in] execution Array containing the
+///                      execution times of each
+///                      task
+/// @param[in] size Size of the linked task array
+///
+/// @return None
+///-------------------------------------------------
+void init_linked(struct task_link_t* task, int *execution, int size)
+{
     for(int i = 0; i < size; i++)
     {
-        totalTime += task[i].turnaround_time;
+        task[i].task.process_id = i;
+        task[i].task.execution_time = execution[i];
+        task[i].task.waiting_time = 0;
+        task[i].task.turnaround_time = 0;
+        task[i].next = NULL;
     }
-    
-    return totalTime / size;
 }
 
 
 ///-------------------------------------------------
-/// @brief  Sorts the task array by execution time
-///         (ascending). Leverages bubble sort.
+/// @brief  Shortest Job First scheduler algorithm
+///         over an intrusive task queue
 ///
-/// @param[in] task The task array to sort
-/// @param[in] size The number of elements in the
-///                 task array
+/// @param[in] task The linked task array
+/// @param[in] size Size of the linked task array
 ///
 /// @return None
 ///-------------------------------------------------
-static void sortTasksByExecutionTime(struct task_t* task, int size)
+void shortest_job_first_linked(struct task_link_t* task, int size)
 {
-    for(int i = 0; i < size - 1; i++)
+    struct sjf_context_t defaults;
+    struct sjf_context_t* context = &defaults;
+
+    defaultContext(context, SJF_ENGINE_QUEUE);
+
+    // Track scheduler runtime
+    int runTime = 0;
+
+    // Construct a task queue from the linked task array
+    struct task_list_t queue;
+    task_list_init(&queue);
+
+    // Statistics collected as tasks complete
+    struct online_stats_t online;
+    online_stats_init(&online);
+
+    for(int i = 0; i < size; i++)
     {
-        for(int j = 0; j < size - i - 1; j++)
-        {
-            if(task[j].execution_time > task[j + 1].execution_time)
-            {
-                swapTasks(&task[j], &task[j + 1]);      
-            }
-        }
+        task_list_push(&queue, &(task[i]));
+    }
+
+    // Sort the task queue based on execution time (ascending order)
+    task_list_sort(&queue, isLongerJob);
+
+    while(!task_list_is_empty(&queue))
+    {
+        // "Execute" the first task
+        struct task_t* currentTask = &(task_list_peek(&queue)->task);
+        currentTask->waiting_time = runTime;
+        runTime += currentTask->execution_time;
+        currentTask->turnaround_time = runTime;
+
+        task_list_pop(&queue);
+        online_stats_add(&online, currentTask);
+
+        // Print times to console
+        TRACE_TO(context->trace, TRACE_LEVEL_TASK, "\nTask[%d] Execution Time: %d\n", currentTask->process_id, currentTask->execution_time);
+        TRACE_TO(context->trace, TRACE_LEVEL_TASK, "Task[%d] Wait Time: %d\n", currentTask->process_id, currentTask->waiting_time);
+        TRACE_TO(context->trace, TRACE_LEVEL_TASK, "Task[%d] Turnaround Time: %d\n", currentTask->process_id, currentTask->turnaround_time);
+
+        // Record the dispatch (SJF has no priorities)
+        dispatch_log_append(context->log, currentTask->waiting_time, currentTask->process_id, currentTask->execution_time, 0, 0);
     }
+
+    // Calculate average times
+    struct time_stats_t stats;
+    online_stats_read(&online, &stats);
+
+    // Print average times
+    TRACE_TO(context->trace, TRACE_LEVEL_SUMMARY, "Average Wait Time: %f\n", (float)((double)stats.waitSum / size));
+    TRACE_TO(context->trace, TRACE_LEVEL_SUMMARY, "Average Turnaround Time: %f\n", (float)((double)stats.turnaroundSum / size));
+
+    // Write out the buffered trace
+    trace_buffer_flush(context->trace);
 }
 
 
 ///-------------------------------------------------
-/// @brief  Swap two tasks within the task array
+/// @brief  Shortest Job First scheduler algorithm
+///         on several threads
 ///
-/// @param[in] taskA First task
-/// @param[in] taskB Second task
+/// @param[in] task The task queue array
+/// @param[in] size Size of the task queue array
+/// @param[in] threads Number of worker threads
+///                    (0 for one per online CPU)
 ///
 /// @return None
 ///-------------------------------------------------
-static void swapTasks(struct task_t* taskA, struct task_t* taskB)
+void shortest_job_first_parallel(struct task_t* task, int size, int threads)
 {
-    struct task_t temp = *taskA;
-    *taskA = *taskB;
-    *taskB = temp;
-}
\ No newline at end of file
+    struct sjf_context_t defaults;
+    struct sjf_context_t* context = &defaults;
+
+    defaultContext(context, SJF_ENGINE_PREFIX_SUM);
+
+    if(threads <= 0)
+    {
+        threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+
+    if(threads > SJF_PARALLEL_MAX_THREADS)
+    {
+        threads = SJF_PARALLEL_MAX_THREADS;
+    }
+
+    // Small batches aren't worth the threads
+    if((threads <= 1) || (size < SJF_PARALLEL_MIN_TASKS))
+    {
+        shortest_job_first_engine(task, size, SJF_ENGINE_PREFIX_SUM);
+        return;
+    }
+
+    struct sjf_parallel_t shared;
+    struct sjf_worker_t worker[SJF_PARALLEL_MAX_THREADS];
+
+    shared.task = task;
+    shared.size = size;
+    shared.threads = threads;
+    shared.scratch = (struct task_t*)malloc(size * sizeof(struct task_t));
+    shared.splitter = (int*)malloc(threads * sizeof(int));
+    shared.count = (size_t*)malloc(threads * threads * sizeof(size_t));
+    shared.bucketStart = (size_t*)malloc((threads + 1) * sizeof(size_t));
+
+    // Verify that malloc didn't fail
+    if((shared.scratch == NULL) || (shared.splitter == NULL) || (shared.count == NULL) || (shared.bucketStart == NULL) ||
+       (pickSplitters(&shared) != 0))
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't allocate parallel buffers!\n", __func__);
+        free(shared.scratch);
+        free(shared.splitter);
+        free(shared.count);
+        free(shared.bucketStart);
+
+        shortest_job_first_engine(task, size, SJF_ENGINE_PREFIX_SUM);
+        return;
+    }
+
+    // Give each worker an equal block of the array
+    for(int i = 0; i < threads; i++)
+    {
+        worker[i].shared = &shared;
+        worker[i].id = i;
+        worker[i].begin = (int)(((long long)size * i) / threads);
+        worker[i].end = (int)(((long long)size * (i + 1)) / threads);
+        worker[i].failed = 0;
+    }
+
+    // Sample sort: count, scatter, then sort each
+    // bucket (equal execution times always share a
+    // bucket and keep their order, so it is stable)
+    runWorkers(worker, threads, countBucketsWorker);
+
+    size_t offset = 0;
+
+    for(int bucket = 0; bucket < threads; bucket++)
+    {
+        shared.bucketStart[bucket] = offset;
+
+        for(int i = 0; i < threads; i++)
+        {
+            size_t bucketCount = shared.count[(i * threads) + bucket];
+            shared.count[(i * threads) + bucket] = offset;
+            offset += bucketCount;
+        }
+    }
+
+    shared.bucketStart[threads] = offset;
+
+    runWorkers(worker, threads, scatterBucketsWorker);
+    runWorkers(worker, threads, sortBucketWorker);
+
+    for(int i = 0; i < threads; i++)
+    {
+        if(worker[i].failed)
+        {
+            // Buckets that couldn't be sorted kept their
+            // order, so a stable sort of the array fixes it
+            sortTasksByExecutionTime(task, size);
+            break;
+        }
+    }
+
+    // Two-pass blocked prefix sum: block totals, then
+    // each block scanned from its starting runtime
+    runWorkers(worker, threads, sumBlockWorker);
+
+    unsigned int runTime = 0;
+
+    for(int i = 0; i < threads; i++)
+    {
+        worker[i].runTime = runTime;
+        runTime += worker[i].totalExecution;
+    }
+
+    runWorkers(worker, threads, scanBlockWorker);
+
+    // Print times to console
+    for(int i = 0; i < size; i++)
+    {
+        TRACE_TO(context->trace, TRACE_LEVEL_TASK, "\nTask[%d] Execution Time: %d\n", task[i].process_id, task[i].execution_time);
+        TRACE_TO(context->trace, TRACE_LEVEL_TASK, "Task[%d] Wait Time: %d\n", task[i].process_id, task[i].waiting_time);
+        TRACE_TO(context->trace, TRACE_LEVEL_TASK, "Task[%d] Turnaround Time: %d\n", task[i].process_id, task[i].turnaround_time);
+
+        // Record the dispatch (SJF has no priorities)
+        dispatch_log_append(context->log, task[i].waiting_time, task[i].process_id, task[i].execution_time, 0, 0);
+    }
+
+    // Reduce the per block totals into the averages
+    long long totalWaitTime = 0;
+    long long totalTurnaroundTime = 0;
+
+    for(int i = 0; i < threads; i++)
+    {
+        totalWaitTime += worker[i].totalWait;
+        totalTurnaroundTime += worker[i].totalTurnaround;
+    }
+
+    // Print average times
+    TRACE_TO(context->trace, TRACE_LEVEL_SUMMARY, "Average Wait Time: %f\n", (float)((double)totalWaitTime / size));
+    TRACE_TO(context->trace, TRACE_LEVEL_SUMMARY, "Average Turnaround Time: %f\n", (float)((double)totalTurnaroundTime / size));
+
+    // Write out the buffered trace
+    trace_buffer_flush(context->trace);
+
+    // Cleanup
+    free(shared.scratch);
+    free(shared.splitter);
+    free(shared.count);
+    free(shared.bucketStart);
+}
+
+
+///-------------------------------------------------
+/// @brief  Schedules tasks read from a descriptor
+///         as they arrive, keeping only the ready
+///         set in memory
+///
+/// @param[in] input Descriptor to read tasks from
+/// @param[in] output Stream for completion records
+/// @param[out] stats Statistics of every task
+///
+/// @return Number of tasks, -1 on failure
+///-------------------------------------------------
+long long shortest_job_first_stream(int input, FILE* output, struct time_stats_t* stats)
+{
+    struct sjf_context_t defaults;
+    struct sjf_context_t* context = &defaults;
+
+    defaultContext(context, SJF_ENGINE_QUEUE);
+
+    // Validate parameters
+    if(output == NULL)
+    {
+        return -1;
+    }
+
+    struct workload_reader_t* reader = create_workload_reader(input);
+
+    if(reader == NULL)
+    {
+        return -1;
+    }
+
+    struct sjf_ready_set_t ready = {NULL, 0, 0};
+    struct online_stats_t online;
+    online_stats_init(&online);
+
+    // Track scheduler runtime (it can outgrow an int
+    // long before the times of a single task do)
+    long long runTime = 0;
+
+    // The next task read that hasn't been admitted
+    struct sjf_ready_t next;
+    int processId = 0;
+    int pending = readNextArrival(reader, &next, processId++);
+
+    fprintf(output, "process_id,execution_time,waiting_time,turnaround_time\n");
+
+    while((pending > 0) || (ready.size > 0))
+    {
+        // Admit every task that has arrived by now
+        while((pending > 0) && (next.arrival <= runTime))
+        {
+            int arrival = next.arrival;
+
+            if(readyPush(&ready, &next) != 0)
+            {
+                pending = -1;
+                break;
+            }
+
+            pending = readNextArrival(reader, &next, processId++);
+
+            if((pending > 0) && (next.arrival < arrival))
+            {
+                fprintf(stderr, "%s() ERROR: Task[%d] arrives before Task[%d]!\n", __func__, next.task.process_id, next.task.process_id - 1);
+                pending = -1;
+            }
+        }
+
+        if(pending < 0)
+        {
+            break;
+        }
+
+        // Nothing is ready: idle until the next arrival
+        if(ready.size == 0)
+        {
+            runTime = next.arrival;
+            continue;
+        }
+
+        // "Execute" the shortest ready task
+        struct sjf_ready_t current;
+        readyPop(&ready, &current);
+
+        struct task_t* currentTask = &(current.task);
+        currentTask->waiting_time = (int)(runTime - current.arrival);
+        runTime += currentTask->execution_time;
+        currentTask->turnaround_time = (int)(runTime - current.arrival);
+
+        // Emit the completion record
+        fprintf(output, "%d,%d,%d,%d\n", currentTask->process_id, currentTask->execution_time,
+                currentTask->waiting_time, currentTask->turnaround_time);
+
+        // Record the dispatch (SJF has no priorities)
+        dispatch_log_append(context->log, (int)(runTime - currentTask->execution_time), currentTask->process_id, currentTask->execution_time, 0, 0);
+
+        online_stats_add(&online, currentTask);
+    }
+
+    // Cleanup
+    free(ready.heap);
+    destroy_workload_reader(reader);
+
+    if(pending < 0)
+    {
+        return -1;
+    }
+
+    // Calculate average times
+    struct time_stats_t summary;
+    online_stats_read(&online, &summary);
+
+    if(stats != NULL)
+    {
+        *stats = summary;
+    }
+
+    // Print average times
+    if(summary.count > 0)
+    {
+        TRACE_TO(context->trace, TRACE_LEVEL_SUMMARY, "Average Wait Time: %f\n", (float)((double)summary.waitSum / summary.count));
+        TRACE_TO(context->trace, TRACE_LEVEL_SUMMARY, "Average Turnaround Time: %f\n", (float)((double)summary.turnaroundSum / summary.count));
+    }
+
+    // Write out the buffered trace
+    trace_buffer_flush(context->trace);
+
+    return summary.count;
+}
+
+
+///-------------------------------------------------
+/// @brief  Calculate the average wait time of
+///         the tasks in the queue
+///
+/// @param[in] task The task queue array
+/// @param[in] size Size of the task queue array
+///
+/// @return Average wait time of all tasks in 
+///         the queue
+///-------------------------------------------------
+float calculate_average_wait_time(struct task_t* task, int size)
+{
+    struct time_stats_t stats;
+
+    calculate_time_stats(task, size, &stats);
+
+    return (float)((double)stats.waitSum / size);
+}
+
+
+///-------------------------------------------------
+/// @brief  Calculate the average turnaround time of
+///         the tasks in the queue
+///
+/// @return None
+///-------------------------------------------------
+float calculate_average_turn_around_time(struct task_t* task, int size)
+{
+    struct time_stats_t stats;
+
+    calculate_time_stats(task, size, &stats);
+
+    return (float)((double)stats.turnaroundSum / size);
+}
+
+
+///-------------------------------------------------
+/// @brief  Sorts the task array by execution time
+///         (ascending). Leverages a linear time
+///         counting/radix sort, and falls back to
+///         bubble sort if it can't allocate.
+///
+/// @param[in] task The task array to sort
+/// @param[in] size The number of elements in the
+///                 task array
+///
+/// @return None
+///-------------------------------------------------
+static void sortTasksByExecutionTime(struct task_t* task, int size)
+{
+    if(sort_tasks_by_execution_time(task, size) == 0)
+    {
+        return;
+    }
+
+    for(int i = 0; i < size - 1; i++)
+    {
+        for(int j = 0; j < size - i - 1; j++)
+        {
+            if(task[j].execution_time > task[j + 1].execution_time)
+            {
+                swapTasks(&task[j], &task[j + 1]);      
+            }
+        }
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Orders tasks by execution time
+///         (ascending) for task_list_sort()
+///
+/// @param[in] taskA First task
+/// @param[in] taskB Second task
+///
+/// @return True if taskA must run after taskB
+///-------------------------------------------------
+static int isLongerJob(struct task_t* taskA, struct task_t* taskB)
+{
+    return (taskA->execution_time > taskB->execution_time);
+}
+
+
+///-------------------------------------------------
+/// @brief  Swap two tasks within the task array
+///
+/// @param[in] taskA First task
+/// @param[in] taskB Second task
+///
+/// @return None
+///-------------------------------------------------
+static void swapTasks(struct task_t* taskA, struct task_t* taskB)
+{
+    struct task_t temp = *taskA;
+    *taskA = *taskB;
+    *taskB = temp;
+}
+
+
+///-------------------------------------------------
+/// @brief  Runs a phase on every worker and waits
+///         for all of them. A worker whose thread
+///         can't be created runs on the caller.
+///
+/// @param[in] worker The worker states
+/// @param[in] threads Number of workers
+/// @param[in] work The phase to run
+///
+/// @return None
+///-------------------------------------------------
+static void runWorkers(struct sjf_worker_t* worker, int threads, void* (*work)(void*))
+{
+    pthread_t thread[SJF_PARALLEL_MAX_THREADS];
+    int started[SJF_PARALLEL_MAX_THREADS];
+
+    // The caller runs the first block itself
+    for(int i = 1; i < threads; i++)
+    {
+        started[i] = (pthread_create(&thread[i], NULL, work, &worker[i]) == 0);
+
+        if(!started[i])
+        {
+            work(&worker[i]);
+        }
+    }
+
+    work(&worker[0]);
+
+    for(int i = 1; i < threads; i++)
+    {
+        if(started[i])
+        {
+            pthread_join(thread[i], NULL);
+        }
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Picks the sample sort splitters from an
+///         evenly spaced sample of the tasks
+///
+/// @param[in] shared The shared scheduler state
+///
+/// @return 0 on success, -1 on failure
+///-------------------------------------------------
+static int pickSplitters(struct sjf_parallel_t* shared)
+{
+    int sampleCount = shared->threads * SJF_PARALLEL_OVERSAMPLE;
+    int* sample = (int*)malloc(sampleCount * sizeof(int));
+
+    if(sample == NULL)
+    {
+        return -1;
+    }
+
+    for(int i = 0; i < sampleCount; i++)
+    {
+        sample[i] = shared->task[(int)(((long long)shared->size * i) / sampleCount)].execution_time;
+    }
+
+    qsort(sample, sampleCount, sizeof(int), compareInts);
+
+    for(int bucket = 0; bucket < shared->threads - 1; bucket++)
+    {
+        shared->splitter[bucket] = sample[(bucket + 1) * SJF_PARALLEL_OVERSAMPLE];
+    }
+
+    free(sample);
+
+    return 0;
+}
+
+
+///-------------------------------------------------
+/// @brief  Returns the bucket of an execution time:
+///         the number of splitters below it
+///
+/// @param[in] shared The shared scheduler state
+/// @param[in] executionTime The execution time
+///
+/// @return The bucket index
+///-------------------------------------------------
+static int bucketOf(struct sjf_parallel_t* shared, int executionTime)
+{
+    int low = 0;
+    int high = shared->threads - 1;
+
+    while(low < high)
+    {
+        int middle = (low + high) / 2;
+
+        if(shared->splitter[middle] < executionTime)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+
+///-------------------------------------------------
+/// @brief  Counts the tasks of a block that go to
+///         each bucket
+///
+/// @param[in] arg The worker state
+///
+/// @return NULL
+///-------------------------------------------------
+static void* countBucketsWorker(void* arg)
+{
+    struct sjf_worker_t* worker = (struct sjf_worker_t*)arg;
+    struct sjf_parallel_t* shared = worker->shared;
+    size_t* count = &(shared->count[worker->id * shared->threads]);
+
+    memset(count, 0, shared->threads * sizeof(size_t));
+
+    for(int i = worker->begin; i < worker->end; i++)
+    {
+        count[bucketOf(shared, shared->task[i].execution_time)]++;
+    }
+
+    return NULL;
+}
+
+
+///-------------------------------------------------
+/// @brief  Moves the tasks of a block into their
+///         buckets, in block order
+///
+/// @param[in] arg The worker state
+///
+/// @return NULL
+///-------------------------------------------------
+static void* scatterBucketsWorker(void* arg)
+{
+    struct sjf_worker_t* worker = (struct sjf_worker_t*)arg;
+    struct sjf_parallel_t* shared = worker->shared;
+    size_t* offset = &(shared->count[worker->id * shared->threads]);
+
+    for(int i = worker->begin; i < worker->end; i++)
+    {
+        shared->scratch[offset[bucketOf(shared, shared->task[i].execution_time)]++] = shared->task[i];
+    }
+
+    return NULL;
+}
+
+
+///-------------------------------------------------
+/// @brief  Sorts the worker's bucket and copies it
+///         back into the task array
+///
+/// @param[in] arg The worker state
+///
+/// @return NULL
+///-------------------------------------------------
+static void* sortBucketWorker(void* arg)
+{
+    struct sjf_worker_t* worker = (struct sjf_worker_t*)arg;
+    struct sjf_parallel_t* shared = worker->shared;
+    size_t begin = shared->bucketStart[worker->id];
+    size_t length = shared->bucketStart[worker->id + 1] - begin;
+
+    worker->failed = (sort_tasks_by_execution_time(&(shared->scratch[begin]), (int)length) != 0);
+
+    memcpy(&(shared->task[begin]), &(shared->scratch[begin]), length * sizeof(struct task_t));
+
+    return NULL;
+}
+
+
+///-------------------------------------------------
+/// @brief  Sums the execution times of a block
+///
+/// @param[in] arg The worker state
+///
+/// @return NULL
+///-------------------------------------------------
+static void* sumBlockWorker(void* arg)
+{
+    struct sjf_worker_t* worker = (struct sjf_worker_t*)arg;
+    struct task_t* task = worker->shared->task;
+
+    worker->totalExecution = 0;
+
+    for(int i = worker->begin; i < worker->end; i++)
+    {
+        worker->totalExecution += (unsigned int)task[i].execution_time;
+    }
+
+    return NULL;
+}
+
+
+///-------------------------------------------------
+/// @brief  Writes the times of a block from its
+///         starting runtime and sums them for the
+///         averages
+///
+/// @param[in] arg The worker state
+///
+/// @return NULL
+///-------------------------------------------------
+static void* scanBlockWorker(void* arg)
+{
+    struct sjf_worker_t* worker = (struct sjf_worker_t*)arg;
+    struct task_t* task = worker->shared->task;
+
+    prefixSumTimes(&(task[worker->begin]), worker->end - worker->begin, (int)worker->runTime);
+
+    worker->totalWait = 0;
+    worker->totalTurnaround = 0;
+
+    for(int i = worker->begin; i < worker->end; i++)
+    {
+        worker->totalWait += task[i].waiting_time;
+        worker->totalTurnaround += task[i].turnaround_time;
+    }
+
+    return NULL;
+}
+
+
+///-------------------------------------------------
+/// @brief  qsort() comparator for ints (ascending)
+///
+/// @param[in] valueA Pointer to the first int
+/// @param[in] valueB Pointer to the second int
+///
+/// @return <0, 0 or >0 like strcmp()
+///-------------------------------------------------
+static int compareInts(const void* valueA, const void* valueB)
+{
+    int a = *(const int*)valueA;
+    int b = *(const int*)valueB;
+
+    return (a > b) - (a < b);
+}
+
+
+///-------------------------------------------------
+/// @brief  Reads the next task of the stream
+///
+/// @param[in] reader The task reader
+/// @param[out] next The task read
+/// @param[in] processId Number of the task
+///
+/// @return 1 for a task, 0 at the end, -1 on
+///         failure
+///-------------------------------------------------
+static int readNextArrival(struct workload_reader_t* reader, struct sjf_ready_t* next, int processId)
+{
+    int value[3];
+    int result = workload_reader_next(reader, value);
+
+    if(result > 0)
+    {
+        next->task.process_id = processId;
+        next->task.execution_time = value[0];
+        next->task.waiting_time = 0;
+        next->task.turnaround_time = 0;
+        next->arrival = value[2];
+    }
+
+    return result;
+}
+
+
+///-------------------------------------------------
+/// @brief  Adds a task to the ready set
+///
+/// @param[in] ready The ready set
+/// @param[in] entry The task to add
+///
+/// @return 0 on success, -1 on failure
+///-------------------------------------------------
+static int readyPush(struct sjf_ready_set_t* ready, const struct sjf_ready_t* entry)
+{
+    // Double the heap when it is full
+    if(ready->size == ready->capacity)
+    {
+        int capacity = (ready->capacity > 0) ? (ready->capacity * 2) : 64;
+        struct sjf_ready_t* heap = (struct sjf_ready_t*)realloc(ready->heap, capacity * sizeof(struct sjf_ready_t));
+
+        if(heap == NULL)
+        {
+            fprintf(stderr, "%s() ERROR: Couldn't grow the ready set!\n", __func__);
+            return -1;
+        }
+
+        ready->heap = heap;
+        ready->capacity = capacity;
+    }
+
+    // Sift the new task up from the bottom
+    int child = ready->size++;
+
+    while(child > 0)
+    {
+        int parent = (child - 1) / 2;
+
+        if(!runsBefore(entry, &(ready->heap[parent])))
+        {
+            break;
+        }
+
+        ready->heap[child] = ready->heap[parent];
+        child = parent;
+    }
+
+    ready->heap[child] = *entry;
+
+    return 0;
+}
+
+
+///-------------------------------------------------
+/// @brief  Removes the shortest task from the
+///         ready set
+///
+/// @param[in] ready The ready set (not empty)
+/// @param[out] entry The task removed
+///
+/// @return None
+///-------------------------------------------------
+static void readyPop(struct sjf_ready_set_t* ready, struct sjf_ready_t* entry)
+{
+    *entry = ready->heap[0];
+
+    // Sift the last task down from the top
+    struct sjf_ready_t last = ready->heap[--ready->size];
+    int parent = 0;
+
+    while(1)
+    {
+        int child = (2 * parent) + 1;
+
+        if(child >= ready->size)
+        {
+            break;
+        }
+
+        if((child + 1 < ready->size) && runsBefore(&(ready->heap[child + 1]), &(ready->heap[child])))
+        {
+            child++;
+        }
+
+        if(!runsBefore(&(ready->heap[child]), &last))
+        {
+            break;
+        }
+
+        ready->heap[parent] = ready->heap[child];
+        parent = child;
+    }
+
+    ready->heap[parent] = last;
+}
+
+
+///-------------------------------------------------
+/// @brief  Orders the ready set: shorter tasks
+///         first, ties in arrival order
+///
+/// @param[in] entryA First task
+/// @param[in] entryB Second task
+///
+/// @return 1 if entryA runs before entryB
+///-------------------------------------------------
+static int runsBefore(const struct sjf_ready_t* entryA, const struct sjf_ready_t* entryB)
+{
+    return (entryA->task.execution_time < entryB->task.execution_time) ||
+           ((entryA->task.execution_time == entryB->task.execution_time) && (entryA->task.process_id < entryB->task.process_id));
+}
@@ -1,4 +1,6 @@
 
+#include <stdio.h>
+
 #ifndef __SHORTEST_JOB_FIRST__
 #define __SHORTEST_JOB_FIRST__
 //----------------------------------------------------------------------------------------------------------------------------------
@@ -19,6 +21,25 @@ struct task_t {
     int turnaround_time;
 };
 
+// Below this many tasks shortest_job_first_parallel() runs single threaded
+#define SJF_PARALLEL_MIN_TASKS (1 << 16)
+
+// Upper bound on the worker threads of shortest_job_first_parallel()
+#define SJF_PARALLEL_MAX_THREADS 64
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Implementations the shortest job first scheduler can run on
+//----------------------------------------------------------------------------------------------------------------------------------
+enum sjf_engine_t {
+
+    // Linked queue built from the sorted tasks and popped one task at a time
+    SJF_ENGINE_QUEUE,
+
+    // No queue: wait and turn around times are the exclusive and inclusive prefix sums of the
+    // sorted execution times, computed with a vectorized scan
+    SJF_ENGINE_PREFIX_SUM
+};
+
 //----------------------------------------------------------------------------------------------------------------------------------
 /// @brief Intialize the task array
 ///
@@ -37,6 +58,74 @@ void init(struct task_t *task, int *execution, int size);
 //----------------------------------------------------------------------------------------------------------------------------------
 void shortest_job_first(struct task_t *task, int size);
 
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Run the shortest job first algorithm on the selected engine. Every engine produces the
+/// same wait and turn around times.
+///
+/// @param[in] task The buffer containing task data
+/// @param[in] size The size of the buffer
+/// @param[in] engine The implementation to schedule with
+//----------------------------------------------------------------------------------------------------------------------------------
+void shortest_job_first_engine(struct task_t *task, int size, enum sjf_engine_t engine);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Task with an intrusive queue link (defined in queue.h)
+//----------------------------------------------------------------------------------------------------------------------------------
+struct task_link_t;
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Intialize an array of linked tasks
+///
+/// @param[in] task The buffer containing linked task data
+/// @param[in] execution The execution time for each task
+/// @param[in] size The size of the buffer
+//----------------------------------------------------------------------------------------------------------------------------------
+void init_linked(struct task_link_t *task, int *execution, int size);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Run the shortest job first algorithm on linked tasks without allocating any queue nodes.
+/// The buffer keeps its order; each task gets the same wait and turn around time as with
+/// shortest_job_first().
+///
+/// @param[in] task The buffer containing linked task data
+/// @param[in] size The size of the buffer
+//----------------------------------------------------------------------------------------------------------------------------------
+void shortest_job_first_linked(struct task_link_t *task, int size);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Run the shortest job first algorithm on several threads: a stable sample sort, a two-pass
+/// blocked prefix sum and a parallel reduction for the averages. Batches smaller than
+/// SJF_PARALLEL_MIN_TASKS (or a single thread) run on the SJF_ENGINE_PREFIX_SUM engine. Each task
+/// gets the same wait and turn around time as with shortest_job_first().
+///
+/// @param[in] task The buffer containing task data
+/// @param[in] size The size of the buffer
+/// @param[in] threads Number of worker threads (0 for one per online CPU)
+//----------------------------------------------------------------------------------------------------------------------------------
+void shortest_job_first_parallel(struct task_t *task, int size, int threads);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Fused time statistics (defined in stats.h)
+//----------------------------------------------------------------------------------------------------------------------------------
+struct time_stats_t;
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Run the shortest job first algorithm over tasks read from a file descriptor as they
+/// arrive. The input is CSV like workload_load() takes, `execution[,priority[,arrival]]` with the
+/// arrival times in order (priorities are ignored); tasks are numbered in input order. Only the
+/// tasks that have arrived and not yet run are kept in memory. Whenever the processor is free the
+/// shortest of them runs to completion, and a `process_id,execution_time,waiting_time,
+/// turnaround_time` line is written for it. Wait and turn around times count from the arrival, so
+/// with every arrival at 0 each task gets the same times as with shortest_job_first().
+///
+/// @param[in] input File descriptor to read the tasks from (a pipe, stdin or a file)
+/// @param[in] output Stream to write the completion records to
+/// @param[out] stats Statistics of every completed task (may be NULL)
+///
+/// @return the number of tasks scheduled, -1 on failure
+//----------------------------------------------------------------------------------------------------------------------------------
+long long shortest_job_first_stream(int input, FILE* output, struct time_stats_t* stats);
+
 //----------------------------------------------------------------------------------------------------------------------------------
 /// @brief Calculates the average wait time.
 ///
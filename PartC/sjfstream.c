@@ -0,0 +1,56 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+#include "sjf.h"
+#include "stats.h"
+#include "trace.h"
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Runs the streaming shortest job first scheduler over a CSV task trace, writing a completion
+/// record per task to stdout and the averages to stderr. Memory grows with the ready set only.
+///
+/// @Usage
+/// ./sjfstream [tasks.csv]   (reads stdin without an input path, so it can sit at the end of a pipe)
+//----------------------------------------------------------------------------------------------------------------------------------
+
+int main(int argc, const char *argv[])
+{
+    if(argc > 2)
+    {
+        fprintf(stderr, "usage: %s [tasks.csv]\n", argv[0]);
+        return 1;
+    }
+
+    int input = (argc == 2) ? open(argv[1], O_RDONLY) : STDIN_FILENO;
+
+    if(input < 0)
+    {
+        fprintf(stderr, "%s: Couldn't open %s!\n", argv[0], argv[1]);
+        return 1;
+    }
+
+    // stdout carries the records only
+    trace_set_level(TRACE_LEVEL_OFF);
+
+    struct time_stats_t stats;
+    long long count = shortest_job_first_stream(input, stdout, &stats);
+
+    if(input != STDIN_FILENO)
+    {
+        close(input);
+    }
+
+    if(count < 0)
+    {
+        return 1;
+    }
+
+    if(count > 0)
+    {
+        fprintf(stderr, "Tasks: %lld\n", count);
+        fprintf(stderr, "Average Wait Time: %f\n", (double)stats.waitSum / count);
+        fprintf(stderr, "Average Turnaround Time: %f\n", (double)stats.turnaroundSum / count);
+    }
+
+    return (fflush(stdout) == 0) ? 0 : 1;
+}
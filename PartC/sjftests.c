@@ -1,7 +1,65 @@
 #include <stdlib.h>
+#include <string.h>
+#include <limits.h>
 #include "ctest.h"
+#include "trace.h"
+#include "record.h"
+#include "stats.h"
+#include "workload.h"
+#include "generator.h"
 #include "sjf.h"
+#include "queue.h"
+#include "sort.h"
+#include "context.h"
+#include <pthread.h>
 #include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+///-------------------------------------------------
+/// @brief  Live queue nodes, for the leak check
+///
+/// @return The number of live nodes
+///-------------------------------------------------
+static intmax_t liveQueueNodes(void)
+{
+    struct queue_alloc_stats_t stats;
+
+    queue_alloc_stats(&stats);
+
+    return stats.live_nodes;
+}
+
+
+///-------------------------------------------------
+/// @brief  Live queue bytes, for the leak check
+///
+/// @return The number of live bytes
+///-------------------------------------------------
+static intmax_t liveQueueBytes(void)
+{
+    struct queue_alloc_stats_t stats;
+
+    queue_alloc_stats(&stats);
+
+    return stats.live_bytes;
+}
+
+
+///-------------------------------------------------
+/// @brief  Track the queue allocations from the
+///         start, so every test fails if it leaks
+///         queue memory
+///
+/// @return None
+///-------------------------------------------------
+__attribute__((constructor)) static void trackQueueAllocations(void)
+{
+    queue_alloc_enable_tracking();
+    ctest_track_leaks("queue nodes", liveQueueNodes);
+    ctest_track_leaks("queue bytes", liveQueueBytes);
+}
 
 
 ///-------------------------------------------------
@@ -222,4 +280,1172 @@ CTEST2(customeSJF, nullQueue_process)
         ASSERT_EQUAL(turnaroundTime[i], data->task[i].turnaround_time);
         ASSERT_EQUAL(i, data->task[i].process_id);
     }
-}
\ No newline at end of file
+}
+
+/******************************
+ *    NODE POOL UNIT TEST     *
+ ******************************/
+
+
+///-------------------------------------------------
+/// @brief  Validate that push/pop cycles on a
+///         pooled queue recycle nodes instead of
+///         allocating new slabs
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(nodePool, recycle_process)
+{
+    struct task_t task[3];
+    struct node_pool_t* pool = create_node_pool(5);
+    struct node_t* queue = create_queue_from_pool(task, 3, pool);
+
+    for(int i = 0; i < 1000; i++)
+    {
+        struct task_t* topTask = peek(&queue);
+
+        push_pooled(&queue, topTask, pool);
+        pop_pooled(&queue, pool);
+    }
+
+    ASSERT_EQUAL(1, pool->slabCount);
+    ASSERT_TRUE(peek(&queue) == &(task[1]));
+
+    empty_queue(&queue);
+    destroy_node_pool(pool);
+}
+
+
+/******************************
+ * QUEUE DESCRIPTOR UNIT TEST *
+ ******************************/
+
+
+///-------------------------------------------------
+/// @brief  Validate that the queue descriptor
+///         tracks its size and tail while tasks
+///         are pushed and popped
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(queueDescriptor, sizeAndTail_process)
+{
+    struct task_t task[4];
+    struct queue_t* queue = create_task_queue(task, 3, NULL);
+
+    ASSERT_EQUAL(3, queue_size(queue));
+    ASSERT_TRUE(queue->tail->task == &(task[2]));
+
+    queue_push(queue, &(task[3]));
+    ASSERT_EQUAL(4, queue_size(queue));
+    ASSERT_TRUE(queue->tail->task == &(task[3]));
+
+    for(int i = 0; i < 4; i++)
+    {
+        ASSERT_TRUE(queue_peek(queue) == &(task[i]));
+        queue_pop(queue);
+    }
+
+    ASSERT_TRUE(queue_is_empty(queue));
+    ASSERT_EQUAL(0, queue_size(queue));
+    ASSERT_TRUE(queue->tail == &(queue->sentinel));
+
+    destroy_task_queue(queue);
+}
+
+
+///-------------------------------------------------
+/// @brief  Validate that the head made by
+///         create_new_node(NULL) works with the
+///         node_t** API and that a task node is
+///         rejected as a head
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(queueDescriptor, nodeHead_process)
+{
+    struct task_t task[3];
+    struct node_t* head = create_new_node(NULL);
+
+    ASSERT_NOT_NULL(head);
+    ASSERT_TRUE(is_empty(&head));
+
+    push(&head, &(task[0]));
+    push(&head, &(task[1]));
+    ASSERT_TRUE(peek(&head) == &(task[0]));
+    pop(&head);
+    ASSERT_TRUE(peek(&head) == &(task[1]));
+
+    // A task node isn't the head of a queue
+    struct node_t* node = head->next;
+    struct node_t* next = node->next;
+
+    push(&node, &(task[2]));
+    ASSERT_TRUE(node->next == next);
+    ASSERT_NULL(peek(&node));
+
+    empty_queue(&head);
+    ASSERT_NULL(head);
+}
+
+
+/******************************
+ *  INTRUSIVE QUEUE UNIT TEST *
+ ******************************/
+
+
+///-------------------------------------------------
+/// @brief  Dataset for the linked SJF unit-test
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST_DATA(sjfLinked)
+{
+    struct task_link_t task[5];
+    int size;
+};
+
+
+///-------------------------------------------------
+/// @brief  Setup the linked SJF unit-test
+//
+/// @retval  None
+///-------------------------------------------------
+CTEST_SETUP(sjfLinked)
+{
+    int execution[] = {4, 2, 4, 1, 3};
+    data->size = sizeof(execution) / sizeof(execution[0]);
+
+    init_linked(data->task, execution, data->size);
+    shortest_job_first_linked(data->task, data->size);
+}
+
+
+///-------------------------------------------------
+/// @brief  Validate the wait and turnaround times
+///         of each linked task (the buffer keeps
+///         its original order)
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST2(sjfLinked, times_process)
+{
+    int waitTime[] = {6, 1, 10, 0, 3};
+    int turnaroundTime[] = {10, 3, 14, 1, 6};
+
+    for(int i = 0; i < data->size; i++)
+    {
+        ASSERT_EQUAL(i, data->task[i].task.process_id);
+        ASSERT_EQUAL(waitTime[i], data->task[i].task.waiting_time);
+        ASSERT_EQUAL(turnaroundTime[i], data->task[i].task.turnaround_time);
+    }
+}
+
+
+/******************************
+ *  PREFIX SUM ENGINE TEST    *
+ ******************************/
+
+
+///-------------------------------------------------
+/// @brief  Dataset for the prefix sum engine
+///         unit-test
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST_DATA(sjfPrefixSum)
+{
+    struct task_t queueTask[11];
+    struct task_t prefixTask[11];
+    int size;
+};
+
+
+///-------------------------------------------------
+/// @brief  Setup the prefix sum engine unit-test
+///         (the size isn't a multiple of the
+///         vector width)
+//
+/// @retval  None
+///-------------------------------------------------
+CTEST_SETUP(sjfPrefixSum)
+{
+    int execution[] = {9, 2, 7, 2, 0, 15, 4, 1, 8, 3, 6};
+    data->size = sizeof(execution) / sizeof(execution[0]);
+
+    init(data->queueTask, execution, data->size);
+    init(data->prefixTask, execution, data->size);
+
+    shortest_job_first_engine(data->queueTask, data->size, SJF_ENGINE_QUEUE);
+    shortest_job_first_engine(data->prefixTask, data->size, SJF_ENGINE_PREFIX_SUM);
+}
+
+
+///-------------------------------------------------
+/// @brief  Validate that the prefix sum engine
+///         produces the same times as the queue
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST2(sjfPrefixSum, matchesQueue_process)
+{
+    for(int i = 0; i < data->size; i++)
+    {
+        ASSERT_EQUAL(data->queueTask[i].process_id, data->prefixTask[i].process_id);
+        ASSERT_EQUAL(data->queueTask[i].execution_time, data->prefixTask[i].execution_time);
+        ASSERT_EQUAL(data->queueTask[i].waiting_time, data->prefixTask[i].waiting_time);
+        ASSERT_EQUAL(data->queueTask[i].turnaround_time, data->prefixTask[i].turnaround_time);
+    }
+}
+
+
+/******************************
+ *   LINEAR SORT UNIT TEST    *
+ ******************************/
+
+
+///-------------------------------------------------
+/// @brief  Validate that the counting and radix
+///         sorts order tasks by execution time and
+///         keep equal tasks in process_id order
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(taskSort, stable_process)
+{
+    int size = 1000;
+    int* execution = (int*)malloc(size * sizeof(int));
+    struct task_t* task = (struct task_t*)malloc(size * sizeof(struct task_t));
+    unsigned int seed = 12345;
+
+    ASSERT_TRUE(execution != NULL);
+    ASSERT_TRUE(task != NULL);
+
+    // Small range (counting sort) then full range (radix sort)
+    unsigned int ranges[] = {50, 0x7fffffff};
+
+    for(int r = 0; r < 2; r++)
+    {
+        for(int i = 0; i < size; i++)
+        {
+            seed = (seed * 1103515245) + 12345;
+            execution[i] = (int)((seed >> 1) % ranges[r]);
+
+            // Force ties in the wide range as well
+            if((i % 10) == 0)
+            {
+                execution[i] = 7;
+            }
+        }
+
+        init(task, execution, size);
+        ASSERT_EQUAL(0, sort_tasks_by_execution_time(task, size));
+
+        for(int i = 1; i < size; i++)
+        {
+            ASSERT_TRUE(task[i - 1].execution_time <= task[i].execution_time);
+
+            if(task[i - 1].execution_time == task[i].execution_time)
+            {
+                ASSERT_TRUE(task[i - 1].process_id < task[i].process_id);
+            }
+        }
+    }
+
+    free(execution);
+    free(task);
+}
+
+
+/******************************
+ * PARALLEL SJF UNIT TEST     *
+ ******************************/
+
+
+///-------------------------------------------------
+/// @brief  Validate that the parallel scheduler
+///         produces the same times as the queue on
+///         a batch large enough to use threads
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(sjfParallel, matchesQueue_process)
+{
+    int size = SJF_PARALLEL_MIN_TASKS;
+    int* execution = (int*)malloc(size * sizeof(int));
+    struct task_t* queueTask = (struct task_t*)malloc(size * sizeof(struct task_t));
+    struct task_t* parallelTask = (struct task_t*)malloc(size * sizeof(struct task_t));
+    unsigned int seed = 6789;
+
+    ASSERT_TRUE(execution != NULL);
+    ASSERT_TRUE(queueTask != NULL);
+    ASSERT_TRUE(parallelTask != NULL);
+
+    for(int i = 0; i < size; i++)
+    {
+        seed = (seed * 1103515245) + 12345;
+        execution[i] = (int)((seed >> 16) % 500);
+    }
+
+    init(queueTask, execution, size);
+    init(parallelTask, execution, size);
+
+    // Silence the per task output of both runs
+    fflush(stdout);
+    int savedStdout = dup(STDOUT_FILENO);
+    int devNull = open("/dev/null", O_WRONLY);
+    dup2(devNull, STDOUT_FILENO);
+
+    shortest_job_first(queueTask, size);
+    shortest_job_first_parallel(parallelTask, size, 4);
+
+    fflush(stdout);
+    dup2(savedStdout, STDOUT_FILENO);
+    close(savedStdout);
+    close(devNull);
+
+    for(int i = 0; i < size; i++)
+    {
+        ASSERT_EQUAL(queueTask[i].process_id, parallelTask[i].process_id);
+        ASSERT_EQUAL(queueTask[i].waiting_time, parallelTask[i].waiting_time);
+        ASSERT_EQUAL(queueTask[i].turnaround_time, parallelTask[i].turnaround_time);
+    }
+
+    free(execution);
+    free(queueTask);
+    free(parallelTask);
+}
+
+
+/******************************
+ *      TRACE UNIT TEST       *
+ ******************************/
+
+
+///-------------------------------------------------
+/// @brief  Validate that the runtime level filters
+///         trace output and that the ring sink
+///         keeps it in memory
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(trace, ringLevel_process)
+{
+    struct task_t task[3];
+    char output[TRACE_BUFFER_SIZE];
+    int execution[] = {3, 1, 2};
+
+    trace_set_sink(TRACE_SINK_RING);
+    trace_set_level(TRACE_LEVEL_SUMMARY);
+
+    init(task, execution, 3);
+    shortest_job_first(task, 3);
+
+    trace_snapshot(output, sizeof(output));
+
+    // Restore the defaults (writes out the retained lines)
+    trace_set_level(TRACE_LEVEL_AGING);
+    trace_set_sink(TRACE_SINK_STDOUT);
+
+    // Release builds compile every trace out
+#if TRACE_COMPILE_LEVEL >= TRACE_LEVEL_SUMMARY
+    ASSERT_NOT_NULL(strstr(output, "Average Wait Time"));
+#endif
+    ASSERT_NULL(strstr(output, "Task["));
+}
+
+
+/******************************
+ *   DISPATCH LOG UNIT TEST   *
+ ******************************/
+
+
+///-------------------------------------------------
+/// @brief  Validate that every dispatch is recorded
+///         and survives a round trip through the
+///         binary file and the JSON exporter
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(dispatchLog, roundTrip_process)
+{
+    struct task_t task[3];
+    int execution[] = {3, 1, 2};
+    const char* path = "dispatch_test.log";
+    struct dispatch_log_t* log = create_dispatch_log(1);
+
+    ASSERT_NOT_NULL(log);
+
+    dispatch_log_start(log);
+    init(task, execution, 3);
+    shortest_job_first(task, 3);
+    dispatch_log_stop();
+
+    ASSERT_EQUAL(0, dispatch_log_write(log, path));
+
+    struct dispatch_log_t* copy = dispatch_log_read(path);
+    remove(path);
+
+    ASSERT_NOT_NULL(copy);
+    ASSERT_EQUAL(log->size, copy->size);
+    ASSERT_EQUAL(0, log->dropped);
+
+    // Tasks run shortest first, back to back
+    int order[] = {1, 2, 0};
+    int start[] = {0, 1, 3};
+
+    for(int i = 0; i < 3; i++)
+    {
+        ASSERT_EQUAL(order[i], copy->records[i].process_id);
+        ASSERT_EQUAL(start[i], copy->records[i].time);
+        ASSERT_EQUAL(execution[order[i]], copy->records[i].slice);
+    }
+
+    FILE* json = tmpfile();
+
+    ASSERT_NOT_NULL(json);
+    ASSERT_EQUAL(0, dispatch_log_export_json(copy, json));
+    fclose(json);
+
+    // A log too long for the header's count is refused
+    // before anything is written
+    struct dispatch_log_t oversized = *copy;
+    oversized.size = (size_t)INT_MAX + 1;
+
+    ASSERT_EQUAL(-1, dispatch_log_write(&oversized, path));
+    ASSERT_NULL(fopen(path, "rb"));
+
+    destroy_dispatch_log(log);
+    destroy_dispatch_log(copy);
+}
+
+
+/******************************
+ *   LATENCY HISTOGRAM TEST   *
+ ******************************/
+
+
+///-------------------------------------------------
+/// @brief  Validate the histogram percentiles and
+///         that merging two halves gives the same
+///         histogram as recording everything
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(latencyHistogram, percentiles_process)
+{
+    static struct histogram_t all;
+    static struct histogram_t low;
+    static struct histogram_t high;
+
+    histogram_init(&all);
+    histogram_init(&low);
+    histogram_init(&high);
+
+    for(int value = 1; value <= 1000; value++)
+    {
+        histogram_record(&all, value);
+        histogram_record((value <= 500) ? &low : &high, value);
+    }
+
+    histogram_merge(&low, &high);
+
+    struct latency_summary_t summary;
+    histogram_summary(&low, &summary);
+
+    // Within the histogram's precision (under 1%)
+    ASSERT_EQUAL(1000, summary.count);
+    ASSERT_DBL_NEAR_TOL(500.5, summary.mean, 1e-9);
+    ASSERT_INTERVAL(500, 505, summary.p50);
+    ASSERT_INTERVAL(900, 909, summary.p90);
+    ASSERT_INTERVAL(990, 1000, summary.p99);
+    ASSERT_INTERVAL(999, 1000, summary.p999);
+    ASSERT_EQUAL(1000, summary.max);
+
+    // Small values are exact
+    ASSERT_EQUAL(100, histogram_percentile(&all, 10.0));
+    ASSERT_EQUAL(summary.p99, histogram_percentile(&all, 99.0));
+}
+
+
+/******************************
+ *   FUSED STATS UNIT TEST    *
+ ******************************/
+
+
+///-------------------------------------------------
+/// @brief  Validate the single pass sum, min, max
+///         and variance of the task times
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(timeStats, fused_process)
+{
+    struct task_t task[5];
+    int waitTime[] = {0, 1, 3, 6, 10};
+    int turnaroundTime[] = {1, 3, 6, 10, 15};
+    struct time_stats_t stats;
+
+    for(int i = 0; i < 5; i++)
+    {
+        task[i].process_id = i;
+        task[i].execution_time = turnaroundTime[i] - waitTime[i];
+        task[i].waiting_time = waitTime[i];
+        task[i].turnaround_time = turnaroundTime[i];
+    }
+
+    calculate_time_stats(task, 5, &stats);
+
+    ASSERT_EQUAL(5, stats.count);
+    ASSERT_EQUAL(20, stats.waitSum);
+    ASSERT_EQUAL(0, stats.waitMin);
+    ASSERT_EQUAL(10, stats.waitMax);
+    ASSERT_DBL_NEAR_TOL(13.2, stats.waitVariance, 1e-9);
+    ASSERT_EQUAL(35, stats.turnaroundSum);
+    ASSERT_EQUAL(1, stats.turnaroundMin);
+    ASSERT_EQUAL(15, stats.turnaroundMax);
+    ASSERT_DBL_NEAR_TOL(25.2, stats.turnaroundVariance, 1e-9);
+}
+
+
+/******************************
+ *  ONLINE STATS UNIT TEST    *
+ ******************************/
+
+
+///-------------------------------------------------
+/// @brief  Validate that statistics collected as
+///         tasks complete can be read mid-way and
+///         match the post pass once all are added
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(onlineStats, matchesPostPass_process)
+{
+    struct task_t task[5];
+    int execution[] = {1, 2, 3, 4, 5};
+    struct online_stats_t online;
+    struct time_stats_t running;
+    struct time_stats_t stats;
+
+    init(task, execution, 5);
+    online_stats_init(&online);
+
+    // Complete the tasks in shortest job first order
+    int runTime = 0;
+
+    for(int i = 0; i < 5; i++)
+    {
+        task[i].waiting_time = runTime;
+        runTime += task[i].execution_time;
+        task[i].turnaround_time = runTime;
+
+        online_stats_add(&online, &(task[i]));
+
+        // Running statistics cover the completed tasks
+        if(i == 1)
+        {
+            online_stats_read(&online, &running);
+
+            ASSERT_EQUAL(2, running.count);
+            ASSERT_EQUAL(1, running.waitSum);
+            ASSERT_EQUAL(3, running.turnaroundMax);
+        }
+    }
+
+    online_stats_read(&online, &running);
+    calculate_time_stats(task, 5, &stats);
+
+    ASSERT_EQUAL(stats.count, running.count);
+    ASSERT_EQUAL(stats.waitSum, running.waitSum);
+    ASSERT_EQUAL(stats.waitMin, running.waitMin);
+    ASSERT_EQUAL(stats.waitMax, running.waitMax);
+    ASSERT_DBL_NEAR_TOL(stats.waitVariance, running.waitVariance, 1e-9);
+    ASSERT_EQUAL(stats.turnaroundSum, running.turnaroundSum);
+    ASSERT_EQUAL(stats.turnaroundMin, running.turnaroundMin);
+    ASSERT_EQUAL(stats.turnaroundMax, running.turnaroundMax);
+    ASSERT_DBL_NEAR_TOL(stats.turnaroundVariance, running.turnaroundVariance, 1e-9);
+}
+
+
+/******************************
+ *   WORKLOAD LOADER TEST     *
+ ******************************/
+
+
+///-------------------------------------------------
+/// @brief  Validate loading a CSV workload (header,
+///         CRLF, blank and unterminated lines) and
+///         its round trip through the packed format
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(workload, csvAndPacked_process)
+{
+    const char* csvPath = "workload_test.csv";
+    const char* packedPath = "workload_test.bin";
+    FILE* file = fopen(csvPath, "w");
+
+    ASSERT_NOT_NULL(file);
+    fputs("execution,priority,arrival\n12345678901\n", file);
+    fclose(file);
+
+    // Values past INT_MAX are rejected
+    ASSERT_NULL(workload_load(csvPath));
+
+    file = fopen(csvPath, "w");
+
+    ASSERT_NOT_NULL(file);
+    fputs("execution,priority,arrival\r\n3\r\n\r\n123456789, 4,7\n1,2", file);
+    fclose(file);
+
+    struct workload_t* workload = workload_load(csvPath);
+    remove(csvPath);
+
+    ASSERT_NOT_NULL(workload);
+    ASSERT_EQUAL(3, workload->size);
+
+    int execution[] = {3, 123456789, 1};
+    int priority[] = {0, 4, 2};
+    int arrival[] = {0, 7, 0};
+
+    for(int i = 0; i < 3; i++)
+    {
+        ASSERT_EQUAL(execution[i], workload->execution[i]);
+        ASSERT_EQUAL(priority[i], workload->priority[i]);
+        ASSERT_EQUAL(arrival[i], workload->arrival[i]);
+    }
+
+    ASSERT_EQUAL(0, workload_write(workload, packedPath));
+
+    struct workload_t* packed = workload_load(packedPath);
+    remove(packedPath);
+
+    ASSERT_NOT_NULL(packed);
+    ASSERT_EQUAL(3, packed->size);
+    ASSERT_DATA((unsigned char*)workload->arrival, 3 * sizeof(int), (unsigned char*)packed->arrival, 3 * sizeof(int));
+
+    struct task_t task[3];
+    workload_init_tasks(packed, task);
+
+    ASSERT_EQUAL(2, task[2].process_id);
+    ASSERT_EQUAL(123456789, task[1].execution_time);
+
+    destroy_workload(workload);
+    destroy_workload(packed);
+}
+
+
+/******************************
+ *   STREAMING SJF UNIT TEST  *
+ ******************************/
+
+
+///-------------------------------------------------
+/// @brief  Validate the streaming scheduler over a
+///         pipe: tasks run in arrival order until
+///         several are ready, and the processor
+///         idles until a late arrival
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(sjfStream, arrivals_process)
+{
+    const char* input = "execution,priority,arrival\n8,0,0\n4,0,1\n9,0,2\n5,0,3\n2,0,30";
+    int pipeFd[2];
+
+    ASSERT_EQUAL(0, pipe(pipeFd));
+    ASSERT_EQUAL(strlen(input), write(pipeFd[1], input, strlen(input)));
+    close(pipeFd[1]);
+
+    FILE* output = tmpfile();
+    struct time_stats_t stats;
+
+    ASSERT_NOT_NULL(output);
+
+    trace_set_level(TRACE_LEVEL_OFF);
+    long long count = shortest_job_first_stream(pipeFd[0], output, &stats);
+    trace_set_level(TRACE_LEVEL_AGING);
+    close(pipeFd[0]);
+
+    ASSERT_EQUAL(5, count);
+
+    // Task[0] runs alone, then the shortest of the
+    // three that arrived meanwhile
+    int processId[] = {0, 1, 3, 2, 4};
+    int waitTime[] = {0, 7, 9, 15, 0};
+    char line[64];
+
+    rewind(output);
+    ASSERT_NOT_NULL(fgets(line, sizeof(line), output));
+    ASSERT_STR("process_id,execution_time,waiting_time,turnaround_time\n", line);
+
+    for(int i = 0; i < 5; i++)
+    {
+        int record[4];
+
+        ASSERT_EQUAL(4, fscanf(output, "%d,%d,%d,%d", &record[0], &record[1], &record[2], &record[3]));
+        ASSERT_EQUAL(processId[i], record[0]);
+        ASSERT_EQUAL(waitTime[i], record[2]);
+        ASSERT_EQUAL(record[1] + record[2], record[3]);
+    }
+
+    fclose(output);
+
+    ASSERT_EQUAL(31, stats.waitSum);
+    ASSERT_EQUAL(59, stats.turnaroundSum);
+}
+
+
+/******************************
+ *  WORKLOAD GENERATOR TEST   *
+ ******************************/
+
+
+///-------------------------------------------------
+/// @brief  Validate that a seed always generates
+///         the same tasks, whichever output they
+///         go to, and that they stay in range
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(generator, deterministic_process)
+{
+    struct generator_config_t config;
+    struct task_t task[256];
+
+    generator_default_config(&config, 2024);
+    config.execution = GENERATOR_PARETO;
+    config.execution_max = 50;
+    config.arrival_rate = 0.5;
+
+    struct generator_t* first = create_generator(&config);
+    struct generator_t* second = create_generator(&config);
+
+    ASSERT_NOT_NULL(first);
+    ASSERT_NOT_NULL(second);
+
+    generate_tasks(first, task, 256);
+    struct workload_t* workload = generate_workload(second, 256);
+
+    ASSERT_NOT_NULL(workload);
+
+    int lastArrival = 0;
+
+    for(int i = 0; i < 256; i++)
+    {
+        ASSERT_EQUAL(i, task[i].process_id);
+        ASSERT_EQUAL(workload->execution[i], task[i].execution_time);
+        ASSERT_INTERVAL(1, 50, task[i].execution_time);
+        ASSERT_INTERVAL(1, 10, workload->priority[i]);
+
+        // Arrivals never go back in time
+        ASSERT_TRUE(workload->arrival[i] >= lastArrival);
+        lastArrival = workload->arrival[i];
+    }
+
+    // Another seed gives other tasks
+    config.seed++;
+    destroy_generator(first);
+    first = create_generator(&config);
+
+    int value[3];
+    int differ = 0;
+
+    for(int i = 0; i < 256; i++)
+    {
+        generator_next(first, value);
+        differ += (value[0] != task[i].execution_time);
+    }
+
+    ASSERT_TRUE(differ > 0);
+
+    destroy_workload(workload);
+    destroy_generator(first);
+    destroy_generator(second);
+}
+
+
+/******************************
+ *   SJF PERFORMANCE BUDGET   *
+ ******************************/
+
+// Size of the generated workload the budget holds for
+#define SJF_BUDGET_TASKS (1 << 16)
+
+
+///-------------------------------------------------
+/// @brief  Dataset for the SJF budget test
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST_DATA(sjfBudget)
+{
+    struct task_t* generated;
+    struct task_t* task;
+    int traceLevel;
+};
+
+
+///-------------------------------------------------
+/// @brief  Setup the SJF budget test: the workload
+///         is generated once and the trace turned
+///         off
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST_SETUP(sjfBudget)
+{
+    struct generator_config_t config;
+
+    generator_default_config(&config, 7);
+
+    data->traceLevel = trace_default.level;
+    data->generated = (struct task_t*)malloc(SJF_BUDGET_TASKS * sizeof(struct task_t));
+    data->task = (struct task_t*)malloc(SJF_BUDGET_TASKS * sizeof(struct task_t));
+
+    struct generator_t* generator = create_generator(&config);
+
+    ASSERT_NOT_NULL(generator);
+    ASSERT_NOT_NULL(data->generated);
+    ASSERT_NOT_NULL(data->task);
+
+    generate_tasks(generator, data->generated, SJF_BUDGET_TASKS);
+    destroy_generator(generator);
+
+    trace_set_level(TRACE_LEVEL_OFF);
+}
+
+
+///-------------------------------------------------
+/// @brief  Restore the trace level and free the
+///         workload, whether or not the test passed
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST_TEARDOWN(sjfBudget)
+{
+    trace_set_level(data->traceLevel);
+    free(data->generated);
+    free(data->task);
+}
+
+
+///-------------------------------------------------
+/// @brief  Validate that shortest_job_first stays
+///         within its time and allocation budget
+///         on a large generated workload
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST2_BENCH(sjfBudget, largeWorkload_process, 5)
+{
+    // Every iteration schedules the same workload
+    memcpy(data->task, data->generated, SJF_BUDGET_TASKS * sizeof(struct task_t));
+
+    // The queue nodes come from pool slabs, so a
+    // malloc per node shows up as a regression
+    ASSERT_ALLOCS_AT_MOST(8, ASSERT_FASTER_THAN(100, shortest_job_first(data->task, SJF_BUDGET_TASKS)));
+}
+
+
+/******************************
+ *  QUEUE ALLOCATION TRACKER  *
+ ******************************/
+
+// Length of the tracked queue (far past what valgrind checks in reasonable time)
+#define QUEUE_TRACKER_TASKS (1 << 20)
+
+
+///-------------------------------------------------
+/// @brief  Validate the live, peak and call counts
+///         of the queue allocation tracker over a
+///         million node queue
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(queueAlloc, millionNodes_process)
+{
+    struct task_t* task = (struct task_t*)calloc(QUEUE_TRACKER_TASKS, sizeof(struct task_t));
+    struct queue_alloc_stats_t before;
+    struct queue_alloc_stats_t stats;
+
+    ASSERT_NOT_NULL(task);
+
+    queue_alloc_stats(&before);
+    queue_alloc_reset_peak();
+
+    struct node_t* head = create_queue(task, QUEUE_TRACKER_TASKS);
+
+    ASSERT_NOT_NULL(head);
+
+    // One node per task plus the descriptor
+    queue_alloc_stats(&stats);
+    ASSERT_EQUAL(before.live_nodes + QUEUE_TRACKER_TASKS, stats.live_nodes);
+    ASSERT_EQUAL(before.live_bytes + sizeof(struct queue_t) + QUEUE_TRACKER_TASKS * sizeof(struct node_t), stats.live_bytes);
+    ASSERT_EQUAL(before.mallocs + QUEUE_TRACKER_TASKS + 1, stats.mallocs);
+
+    for(int i = 0; i < QUEUE_TRACKER_TASKS / 2; i++)
+    {
+        pop(&head);
+    }
+
+    // Popping frees nodes, the peak stays
+    queue_alloc_stats(&stats);
+    ASSERT_EQUAL(before.live_nodes + QUEUE_TRACKER_TASKS / 2, stats.live_nodes);
+    ASSERT_EQUAL(before.live_nodes + QUEUE_TRACKER_TASKS, stats.peak_nodes);
+
+    empty_queue(&head);
+
+    queue_alloc_stats(&stats);
+    ASSERT_EQUAL(before.live_nodes, stats.live_nodes);
+    ASSERT_EQUAL(before.live_bytes, stats.live_bytes);
+    ASSERT_EQUAL(stats.mallocs - before.mallocs, stats.frees - before.frees);
+
+    free(task);
+}
+
+
+/******************************
+ *  SCHEDULER CONTEXT TEST    *
+ ******************************/
+
+// Threads, and simulations per thread, in the scheduler context test
+#define CONTEXT_THREADS 4
+#define CONTEXT_RUNS 3
+
+// Size of each simulated task set
+#define CONTEXT_TASKS 1000
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds the simulations run by one thread of the scheduler context test
+//----------------------------------------------------------------------------------------------------------------------------------
+struct context_worker_t {
+    enum sjf_engine_t engine;
+    int seed;
+
+    // Task sets as generated, and as scheduled by the thread
+    struct task_t generated[CONTEXT_RUNS][CONTEXT_TASKS];
+    struct task_t scheduled[CONTEXT_RUNS][CONTEXT_TASKS];
+
+    // Clock and completed tasks of each simulation
+    int runTime[CONTEXT_RUNS];
+    long long completed[CONTEXT_RUNS];
+
+    // Summaries written to the thread's trace stream
+    int traced;
+};
+
+
+///-------------------------------------------------
+/// @brief  Runs the simulations of one thread on
+///         its own scheduler context
+///
+/// @param[in] arg The context_worker_t to run
+///
+/// @return NULL
+///-------------------------------------------------
+static void* runContextWorker(void* arg)
+{
+    struct context_worker_t* worker = (struct context_worker_t*)arg;
+    struct generator_config_t config;
+    char line[TRACE_LINE_SIZE];
+
+    generator_default_config(&config, worker->seed);
+
+    // Each context traces the summaries into its
+    // own stream
+    FILE* out = tmpfile();
+    struct generator_t* generator = create_generator(&config);
+    struct sjf_context_t* context = create_sjf_context(worker->engine, out);
+
+    if((out == NULL) || (generator == NULL) || (context == NULL))
+    {
+        destroy_sjf_context(context);
+        destroy_generator(generator);
+
+        if(out != NULL)
+        {
+            fclose(out);
+        }
+
+        return NULL;
+    }
+
+    context->trace->level = TRACE_LEVEL_SUMMARY;
+
+    for(int run = 0; run < CONTEXT_RUNS; run++)
+    {
+        generate_tasks(generator, worker->generated[run], CONTEXT_TASKS);
+        memcpy(worker->scheduled[run], worker->generated[run], sizeof(worker->generated[run]));
+
+        sjf_context_run(context, worker->scheduled[run], CONTEXT_TASKS);
+
+        worker->runTime[run] = context->run_time;
+        worker->completed[run] = context->stats.count;
+    }
+
+    destroy_sjf_context(context);
+    destroy_generator(generator);
+
+    rewind(out);
+
+    while(fgets(line, sizeof(line), out) != NULL)
+    {
+        worker->traced += (strncmp(line, "Average Wait Time", 17) == 0);
+    }
+
+    fclose(out);
+
+    return NULL;
+}
+
+
+///-------------------------------------------------
+/// @brief  Process-wide trace settings the
+///         scheduler context test changes
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST_DATA(schedulerContext)
+{
+    int traceLevel;
+    enum trace_sink_t traceSink;
+};
+
+
+///-------------------------------------------------
+/// @brief  Setup the scheduler context test by
+///         saving the trace settings
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST_SETUP(schedulerContext)
+{
+    data->traceLevel = trace_default.level;
+    data->traceSink = trace_default.sink;
+}
+
+
+///-------------------------------------------------
+/// @brief  Restore the trace settings, whether or
+///         not the test passed
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST_TEARDOWN(schedulerContext)
+{
+    trace_set_sink(data->traceSink);
+    trace_set_level(data->traceLevel);
+}
+
+
+///-------------------------------------------------
+/// @brief  Validate that simulations on separate
+///         contexts run concurrently, match the
+///         context-free scheduler and keep their
+///         output out of the process-wide trace
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST2(schedulerContext, threads_process)
+{
+    static struct context_worker_t worker[CONTEXT_THREADS];
+    pthread_t thread[CONTEXT_THREADS];
+    char output[TRACE_BUFFER_SIZE];
+    enum sjf_engine_t engine[] = {SJF_ENGINE_QUEUE, SJF_ENGINE_PREFIX_SUM};
+
+    memset(worker, 0, sizeof(worker));
+
+    // Anything written to the process-wide trace
+    // stays in the ring
+    trace_set_sink(TRACE_SINK_RING);
+
+    for(int i = 0; i < CONTEXT_THREADS; i++)
+    {
+        worker[i].engine = engine[i % 2];
+        worker[i].seed = 11 + i;
+        ASSERT_EQUAL(0, pthread_create(&thread[i], NULL, runContextWorker, &worker[i]));
+    }
+
+    for(int i = 0; i < CONTEXT_THREADS; i++)
+    {
+        pthread_join(thread[i], NULL);
+    }
+
+    ASSERT_EQUAL(0, trace_snapshot(output, sizeof(output)));
+
+    // Replay every task set on the context-free
+    // scheduler
+    trace_set_level(TRACE_LEVEL_OFF);
+
+    for(int i = 0; i < CONTEXT_THREADS; i++)
+    {
+        for(int run = 0; run < CONTEXT_RUNS; run++)
+        {
+            struct task_t* expected = worker[i].generated[run];
+            struct task_t* actual = worker[i].scheduled[run];
+            int work = 0;
+
+            shortest_job_first_engine(expected, CONTEXT_TASKS, worker[i].engine);
+
+            for(int j = 0; j < CONTEXT_TASKS; j++)
+            {
+                ASSERT_EQUAL(expected[j].process_id, actual[j].process_id);
+                ASSERT_EQUAL(expected[j].waiting_time, actual[j].waiting_time);
+                ASSERT_EQUAL(expected[j].turnaround_time, actual[j].turnaround_time);
+                work += expected[j].execution_time;
+            }
+
+            ASSERT_EQUAL(work, worker[i].runTime[run]);
+            ASSERT_EQUAL(CONTEXT_TASKS, worker[i].completed[run]);
+        }
+
+        // Release builds compile every trace out
+#if TRACE_COMPILE_LEVEL >= TRACE_LEVEL_SUMMARY
+        ASSERT_EQUAL(CONTEXT_RUNS, worker[i].traced);
+#endif
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Validate that a context records its
+///         dispatches into a log it owns, and only
+///         its own
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(schedulerContext, record_process)
+{
+    struct task_t task[3];
+    int execution[] = {3, 1, 2};
+    struct sjf_context_t* context = create_sjf_context(SJF_ENGINE_QUEUE, NULL);
+
+    ASSERT_NOT_NULL(context);
+
+    struct dispatch_log_t* log = sjf_context_record(context, 16);
+
+    ASSERT_NOT_NULL(log);
+    ASSERT_TRUE(context->log == log);
+    ASSERT_NULL(dispatch_log_active());
+
+    init(task, execution, 3);
+    sjf_context_run(context, task, 3);
+
+    // Shortest first, back to back
+    int order[] = {1, 2, 0};
+    int start[] = {0, 1, 3};
+
+    ASSERT_EQUAL(3, log->size);
+
+    for(int i = 0; i < 3; i++)
+    {
+        ASSERT_EQUAL(order[i], log->records[i].process_id);
+        ASSERT_EQUAL(start[i], log->records[i].time);
+        ASSERT_EQUAL(execution[order[i]], log->records[i].slice);
+    }
+
+    // The log goes with the context
+    destroy_sjf_context(context);
+}
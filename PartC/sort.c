@@ -0,0 +1,256 @@
+#include <string.h>
+#include "sort.h"
+
+
+static void insertionSortTasks(struct task_t* task, int size);
+static unsigned int sortKey(struct task_t* task, int minTime);
+
+
+///-------------------------------------------------
+/// @brief  Sorts the task array on execution time
+///         with the cheapest stable sort for the
+///         data
+///
+/// @param[in] task The task queue array
+/// @param[in] size Size of the task queue array
+///
+/// @return 0 on success, -1 on failure
+///-------------------------------------------------
+int sort_tasks_by_execution_time(struct task_t* task, int size)
+{
+    // Validate parameters
+    if((task == NULL) || (size < 2))
+    {
+        return 0;
+    }
+
+    if(size < SORT_INSERTION_THRESHOLD)
+    {
+        insertionSortTasks(task, size);
+        return 0;
+    }
+
+    // Find the range of the keys
+    int minTime = task[0].execution_time;
+    int maxTime = task[0].execution_time;
+
+    for(int i = 1; i < size; i++)
+    {
+        if(task[i].execution_time < minTime)
+        {
+            minTime = task[i].execution_time;
+        }
+        else if(task[i].execution_time > maxTime)
+        {
+            maxTime = task[i].execution_time;
+        }
+    }
+
+    // NOTE: Computed unsigned so that the full int
+    //       range doesn't overflow
+    unsigned int range = (unsigned int)maxTime - (unsigned int)minTime;
+
+    if((range < SORT_COUNTING_MAX_RANGE) || (range < (unsigned int)size))
+    {
+        return counting_sort_tasks(task, size, minTime, maxTime);
+    }
+
+    return radix_sort_tasks(task, size, minTime, maxTime);
+}
+
+
+///-------------------------------------------------
+/// @brief  Counting sort on execution time. Each
+///         task is placed after every task with a
+///         smaller key and every earlier task with
+///         the same key.
+///
+/// @param[in] task The task queue array
+/// @param[in] size Size of the task queue array
+/// @param[in] minTime Smallest execution time
+/// @param[in] maxTime Largest execution time
+///
+/// @return 0 on success, -1 on failure
+///-------------------------------------------------
+int counting_sort_tasks(struct task_t* task, int size, int minTime, int maxTime)
+{
+    // Validate parameters
+    if((task == NULL) || (size < 2) || (maxTime < minTime))
+    {
+        return 0;
+    }
+
+    size_t buckets = (size_t)((unsigned int)maxTime - (unsigned int)minTime) + 1;
+    size_t* count = (size_t*)calloc(buckets, sizeof(size_t));
+    struct task_t* sorted = (struct task_t*)malloc(size * sizeof(struct task_t));
+
+    // Verify that malloc didn't fail
+    if((count == NULL) || (sorted == NULL))
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't allocate sort buffers!\n", __func__);
+        free(count);
+        free(sorted);
+        return -1;
+    }
+
+    // Histogram of the keys
+    for(int i = 0; i < size; i++)
+    {
+        count[sortKey(&task[i], minTime)]++;
+    }
+
+    // Turn the histogram into bucket start offsets
+    size_t offset = 0;
+
+    for(size_t key = 0; key < buckets; key++)
+    {
+        size_t keyCount = count[key];
+        count[key] = offset;
+        offset += keyCount;
+    }
+
+    // Scatter in input order to keep the sort stable
+    for(int i = 0; i < size; i++)
+    {
+        sorted[count[sortKey(&task[i], minTime)]++] = task[i];
+    }
+
+    memcpy(task, sorted, size * sizeof(struct task_t));
+
+    // Cleanup
+    free(count);
+    free(sorted);
+
+    return 0;
+}
+
+
+///-------------------------------------------------
+/// @brief  LSD radix sort on execution time, one
+///         SORT_RADIX_BITS digit per pass
+///
+/// @param[in] task The task queue array
+/// @param[in] size Size of the task queue array
+/// @param[in] minTime Smallest execution time
+/// @param[in] maxTime Largest execution time
+///
+/// @return 0 on success, -1 on failure
+///-------------------------------------------------
+int radix_sort_tasks(struct task_t* task, int size, int minTime, int maxTime)
+{
+    // Validate parameters
+    if((task == NULL) || (size < 2) || (maxTime < minTime))
+    {
+        return 0;
+    }
+
+    struct task_t* scratch = (struct task_t*)malloc(size * sizeof(struct task_t));
+
+    // Verify that malloc didn't fail
+    if(scratch == NULL)
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't allocate sort buffer!\n", __func__);
+        return -1;
+    }
+
+    unsigned int range = (unsigned int)maxTime - (unsigned int)minTime;
+    unsigned int digitMask = (1u << SORT_RADIX_BITS) - 1;
+    size_t count[1 << SORT_RADIX_BITS];
+
+    struct task_t* source = task;
+    struct task_t* destination = scratch;
+
+    // Only the digits below the top set bit of the
+    // range can differ between tasks
+    for(int shift = 0; (shift < 32) && ((range >> shift) != 0); shift += SORT_RADIX_BITS)
+    {
+        memset(count, 0, sizeof(count));
+
+        for(int i = 0; i < size; i++)
+        {
+            count[(sortKey(&source[i], minTime) >> shift) & digitMask]++;
+        }
+
+        // Skip a pass where every task has the same digit
+        if(count[(sortKey(&source[0], minTime) >> shift) & digitMask] == (size_t)size)
+        {
+            continue;
+        }
+
+        // Turn the histogram into bucket start offsets
+        size_t offset = 0;
+
+        for(unsigned int digit = 0; digit <= digitMask; digit++)
+        {
+            size_t digitCount = count[digit];
+            count[digit] = offset;
+            offset += digitCount;
+        }
+
+        // Scatter in source order to keep the sort stable
+        for(int i = 0; i < size; i++)
+        {
+            destination[count[(sortKey(&source[i], minTime) >> shift) & digitMask]++] = source[i];
+        }
+
+        struct task_t* temp = source;
+        source = destination;
+        destination = temp;
+    }
+
+    // An odd number of passes leaves the result in
+    // the scratch buffer
+    if(source != task)
+    {
+        memcpy(task, source, size * sizeof(struct task_t));
+    }
+
+    // Cleanup
+    free(scratch);
+
+    return 0;
+}
+
+
+///-------------------------------------------------
+/// @brief  Stable insertion sort on execution time
+///         for small arrays
+///
+/// @param[in] task The task queue array
+/// @param[in] size Size of the task queue array
+///
+/// @return None
+///-------------------------------------------------
+static void insertionSortTasks(struct task_t* task, int size)
+{
+    for(int i = 1; i < size; i++)
+    {
+        struct task_t current = task[i];
+        int j = i - 1;
+
+        // Shift longer jobs right (equal ones stay put)
+        while((j >= 0) && (task[j].execution_time > current.execution_time))
+        {
+            task[j + 1] = task[j];
+            j--;
+        }
+
+        task[j + 1] = current;
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Returns the execution time of a task
+///         relative to the smallest one, so that
+///         every key is non-negative
+///
+/// @param[in] task The task
+/// @param[in] minTime Smallest execution time
+///
+/// @return The sort key
+///-------------------------------------------------
+static unsigned int sortKey(struct task_t* task, int minTime)
+{
+    return (unsigned int)task->execution_time - (unsigned int)minTime;
+}
@@ -0,0 +1,53 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "sjf.h"
+
+#ifndef __TASK_SORT__
+#define __TASK_SORT__
+
+// Below this many tasks an insertion sort beats setting up the buckets
+#define SORT_INSERTION_THRESHOLD 32
+
+// Largest range of execution times handled by the counting sort
+#define SORT_COUNTING_MAX_RANGE (1 << 16)
+
+// Width of a radix sort digit in bits (three passes cover a 32-bit key)
+#define SORT_RADIX_BITS 11
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Stable sort of the task array on execution time (ascending). Picks an insertion sort for
+/// small arrays, a counting sort for small value ranges and an LSD radix sort otherwise.
+///
+/// @param[in] task The buffer containing task data
+/// @param[in] size The size of the buffer
+///
+/// @return 0 on success, -1 if the scratch buffer couldn't be allocated (the buffer is unchanged)
+//----------------------------------------------------------------------------------------------------------------------------------
+int sort_tasks_by_execution_time(struct task_t* task, int size);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Stable counting sort of the task array on execution time (ascending)
+///
+/// @param[in] task The buffer containing task data
+/// @param[in] size The size of the buffer
+/// @param[in] minTime The smallest execution time in the buffer
+/// @param[in] maxTime The largest execution time in the buffer
+///
+/// @return 0 on success, -1 if the scratch buffers couldn't be allocated (the buffer is unchanged)
+//----------------------------------------------------------------------------------------------------------------------------------
+int counting_sort_tasks(struct task_t* task, int size, int minTime, int maxTime);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Stable LSD radix sort of the task array on execution time (ascending). Digits that are the
+/// same for every task are skipped.
+///
+/// @param[in] task The buffer containing task data
+/// @param[in] size The size of the buffer
+/// @param[in] minTime The smallest execution time in the buffer
+/// @param[in] maxTime The largest execution time in the buffer
+///
+/// @return 0 on success, -1 if the scratch buffer couldn't be allocated (the buffer is unchanged)
+//----------------------------------------------------------------------------------------------------------------------------------
+int radix_sort_tasks(struct task_t* task, int size, int minTime, int maxTime);
+
+#endif // __TASK_SORT__
@@ -0,0 +1,585 @@
+#include <limits.h>
+#include <stddef.h>
+#include <string.h>
+#include "stats.h"
+#include "trace.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define STATS_HAVE_AVX2 1
+#endif
+
+static int bucketIndex(int value);
+static int bucketUpperBound(int index);
+static void accumulateTimes(struct online_stats_t* totals, int waitTime, int turnaroundTime);
+static double populationVariance(long long count, long long sum, unsigned __int128 sumSquares);
+#ifdef STATS_HAVE_AVX2
+static int accumulateTimesAvx2(struct task_t* task, int size, struct online_stats_t* totals);
+#endif
+
+
+///-------------------------------------------------
+/// @brief  Computes the wait and turnaround time
+///         statistics in a single pass
+///
+/// @param[in] task The task queue array
+/// @param[in] size Size of the task queue array
+/// @param[out] stats The statistics
+///
+/// @return None
+///-------------------------------------------------
+void calculate_time_stats(struct task_t* task, int size, struct time_stats_t* stats)
+{
+    struct online_stats_t totals;
+    int done = 0;
+
+    online_stats_init(&totals);
+
+    if((task == NULL) || (size < 1))
+    {
+        online_stats_read(&totals, stats);
+        return;
+    }
+
+#ifdef STATS_HAVE_AVX2
+    if(__builtin_cpu_supports("avx2"))
+    {
+        done = accumulateTimesAvx2(task, size, &totals);
+    }
+#endif
+
+    // Remaining tasks
+    for(int i = done; i < size; i++)
+    {
+        accumulateTimes(&totals, task[i].waiting_time, task[i].turnaround_time);
+    }
+
+    totals.count = size;
+
+    online_stats_read(&totals, stats);
+}
+
+
+///-------------------------------------------------
+/// @brief  Empties an online statistics
+///         accumulator
+///
+/// @param[in] online The accumulator
+///
+/// @return None
+///-------------------------------------------------
+void online_stats_init(struct online_stats_t* online)
+{
+    if(online == NULL)
+    {
+        return;
+    }
+
+    online->count = 0;
+
+    for(int field = 0; field < 2; field++)
+    {
+        online->sum[field] = 0;
+        online->sumSquares[field] = 0;
+        online->min[field] = INT_MAX;
+        online->max[field] = INT_MIN;
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Adds a completed task to the running
+///         totals
+///
+/// @param[in] online The accumulator
+/// @param[in] task The completed task
+///
+/// @return None
+///-------------------------------------------------
+void online_stats_add(struct online_stats_t* online, const struct task_t* task)
+{
+    if((online == NULL) || (task == NULL))
+    {
+        return;
+    }
+
+    online->count++;
+    accumulateTimes(online, task->waiting_time, task->turnaround_time);
+}
+
+
+///-------------------------------------------------
+/// @brief  Reads the statistics of the tasks added
+///         so far
+///
+/// @param[in] online The accumulator
+/// @param[out] stats The statistics
+///
+/// @return None
+///-------------------------------------------------
+void online_stats_read(const struct online_stats_t* online, struct time_stats_t* stats)
+{
+    if(stats == NULL)
+    {
+        return;
+    }
+
+    memset(stats, 0, sizeof(struct time_stats_t));
+
+    if((online == NULL) || (online->count < 1))
+    {
+        return;
+    }
+
+    stats->count = online->count;
+
+    stats->waitSum = online->sum[0];
+    stats->waitMin = online->min[0];
+    stats->waitMax = online->max[0];
+    stats->waitVariance = populationVariance(online->count, online->sum[0], online->sumSquares[0]);
+
+    stats->turnaroundSum = online->sum[1];
+    stats->turnaroundMin = online->min[1];
+    stats->turnaroundMax = online->max[1];
+    stats->turnaroundVariance = populationVariance(online->count, online->sum[1], online->sumSquares[1]);
+}
+
+
+///-------------------------------------------------
+/// @brief  Empties a histogram
+///
+/// @param[in] histogram The histogram
+///
+/// @return None
+///-------------------------------------------------
+void histogram_init(struct histogram_t* histogram)
+{
+    if(histogram == NULL)
+    {
+        return;
+    }
+
+    memset(histogram->counts, 0, sizeof(histogram->counts));
+    histogram->total = 0;
+    histogram->sum = 0;
+    histogram->min = INT_MAX;
+    histogram->max = 0;
+}
+
+
+///-------------------------------------------------
+/// @brief  Records a value
+///
+/// @param[in] histogram The histogram
+/// @param[in] value The value to record
+///
+/// @return None
+///-------------------------------------------------
+void histogram_record(struct histogram_t* histogram, int value)
+{
+    if(histogram == NULL)
+    {
+        return;
+    }
+
+    if(value < 0)
+    {
+        value = 0;
+    }
+
+    histogram->counts[bucketIndex(value)]++;
+    histogram->total++;
+    histogram->sum += value;
+
+    if(value < histogram->min)
+    {
+        histogram->min = value;
+    }
+
+    if(value > histogram->max)
+    {
+        histogram->max = value;
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Adds the values of one histogram to
+///         another
+///
+/// @param[in] histogram The histogram to add to
+/// @param[in] other The histogram to add
+///
+/// @return None
+///-------------------------------------------------
+void histogram_merge(struct histogram_t* histogram, const struct histogram_t* other)
+{
+    if((histogram == NULL) || (other == NULL))
+    {
+        return;
+    }
+
+    for(int i = 0; i < HISTOGRAM_BUCKETS; i++)
+    {
+        histogram->counts[i] += other->counts[i];
+    }
+
+    histogram->total += other->total;
+    histogram->sum += other->sum;
+
+    if(other->min < histogram->min)
+    {
+        histogram->min = other->min;
+    }
+
+    if(other->max > histogram->max)
+    {
+        histogram->max = other->max;
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Finds the value at a percentile
+///
+/// @param[in] histogram The histogram
+/// @param[in] percentile The percentile [0, 100]
+///
+/// @return The percentile value
+///-------------------------------------------------
+int histogram_percentile(const struct histogram_t* histogram, double percentile)
+{
+    if((histogram == NULL) || (histogram->total == 0))
+    {
+        return 0;
+    }
+
+    // Rank of the value to find, rounded up (at
+    // least the first)
+    double exactRank = (percentile / 100.0) * histogram->total;
+    long long rank = (long long)exactRank;
+
+    if(rank < exactRank)
+    {
+        rank++;
+    }
+
+    if(rank < 1)
+    {
+        rank = 1;
+    }
+
+    long long seen = 0;
+
+    for(int i = 0; i < HISTOGRAM_BUCKETS; i++)
+    {
+        seen += histogram->counts[i];
+
+        if(seen >= rank)
+        {
+            int value = bucketUpperBound(i);
+            return (value < histogram->max) ? value : histogram->max;
+        }
+    }
+
+    return histogram->max;
+}
+
+
+///-------------------------------------------------
+/// @brief  Summarizes a histogram
+///
+/// @param[in] histogram The histogram
+/// @param[out] summary The summary
+///
+/// @return None
+///-------------------------------------------------
+void histogram_summary(const struct histogram_t* histogram, struct latency_summary_t* summary)
+{
+    if((histogram == NULL) || (summary == NULL))
+    {
+        return;
+    }
+
+    summary->count = histogram->total;
+    summary->mean = (histogram->total > 0) ? ((double)histogram->sum / histogram->total) : 0.0;
+    summary->p50 = histogram_percentile(histogram, 50.0);
+    summary->p90 = histogram_percentile(histogram, 90.0);
+    summary->p99 = histogram_percentile(histogram, 99.0);
+    summary->p999 = histogram_percentile(histogram, 99.9);
+    summary->max = histogram->max;
+}
+
+
+///-------------------------------------------------
+/// @brief  Prints the summary of a histogram
+///
+/// @param[in] name Label for the summary line
+/// @param[in] histogram The histogram
+///
+/// @return None
+///-------------------------------------------------
+void histogram_print(const char* name, const struct histogram_t* histogram)
+{
+    struct latency_summary_t summary;
+
+    histogram_summary(histogram, &summary);
+
+    TRACE(TRACE_LEVEL_SUMMARY, "%s: count %lld mean %f p50 %d p90 %d p99 %d p99.9 %d max %d\n",
+          name, summary.count, summary.mean, summary.p50, summary.p90, summary.p99, summary.p999, summary.max);
+    trace_flush();
+}
+
+
+///-------------------------------------------------
+/// @brief  Records the wait time of every task
+///
+/// @param[in] histogram The histogram
+/// @param[in] task The task queue array
+/// @param[in] size Size of the task queue array
+///
+/// @return None
+///-------------------------------------------------
+void histogram_record_wait_times(struct histogram_t* histogram, struct task_t* task, int size)
+{
+    for(int i = 0; i < size; i++)
+    {
+        histogram_record(histogram, task[i].waiting_time);
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Records the turnaround time of every
+///         task
+///
+/// @param[in] histogram The histogram
+/// @param[in] task The task queue array
+/// @param[in] size Size of the task queue array
+///
+/// @return None
+///-------------------------------------------------
+void histogram_record_turnaround_times(struct histogram_t* histogram, struct task_t* task, int size)
+{
+    for(int i = 0; i < size; i++)
+    {
+        histogram_record(histogram, task[i].turnaround_time);
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Maps a value to its bucket. Values below
+///         2^HISTOGRAM_PRECISION_BITS get their own
+///         bucket; above that each power of two is
+///         split into half as many linear buckets.
+///
+/// @param[in] value The value (non-negative)
+///
+/// @return The bucket index
+///-------------------------------------------------
+static int bucketIndex(int value)
+{
+    int linearBuckets = 1 << HISTOGRAM_PRECISION_BITS;
+
+    if(value < linearBuckets)
+    {
+        return value;
+    }
+
+    int topBit = 31 - __builtin_clz((unsigned int)value);
+    int shift = topBit - HISTOGRAM_PRECISION_BITS + 1;
+    int halfBuckets = linearBuckets / 2;
+
+    return linearBuckets + ((shift - 1) * halfBuckets) + ((value >> shift) - halfBuckets);
+}
+
+
+///-------------------------------------------------
+/// @brief  Returns the largest value that maps to
+///         a bucket
+///
+/// @param[in] index The bucket index
+///
+/// @return The upper bound of the bucket
+///-------------------------------------------------
+static int bucketUpperBound(int index)
+{
+    int linearBuckets = 1 << HISTOGRAM_PRECISION_BITS;
+
+    if(index < linearBuckets)
+    {
+        return index;
+    }
+
+    int halfBuckets = linearBuckets / 2;
+    int shift = ((index - linearBuckets) / halfBuckets) + 1;
+    long long mantissa = ((index - linearBuckets) % halfBuckets) + halfBuckets;
+    long long upper = ((mantissa + 1) << shift) - 1;
+
+    return (upper > INT_MAX) ? INT_MAX : (int)upper;
+}
+
+
+///-------------------------------------------------
+/// @brief  Adds one task's times to the totals
+///
+/// @param[in] totals The running totals
+/// @param[in] waitTime The task's wait time
+/// @param[in] turnaroundTime The task's turnaround
+///                           time
+///
+/// @return None
+///-------------------------------------------------
+static void accumulateTimes(struct online_stats_t* totals, int waitTime, int turnaroundTime)
+{
+    int value[2] = {waitTime, turnaroundTime};
+
+    for(int field = 0; field < 2; field++)
+    {
+        totals->sum[field] += value[field];
+        totals->sumSquares[field] += (unsigned __int128)((long long)value[field] * value[field]);
+
+        if(value[field] < totals->min[field])
+        {
+            totals->min[field] = value[field];
+        }
+
+        if(value[field] > totals->max[field])
+        {
+            totals->max[field] = value[field];
+        }
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Computes a population variance from
+///         exact sums: (n * sum(x^2) - sum(x)^2)
+///         / n^2
+///
+/// @param[in] count Number of values
+/// @param[in] sum Sum of the values
+/// @param[in] sumSquares Sum of their squares
+///
+/// @return The variance
+///-------------------------------------------------
+static double populationVariance(long long count, long long sum, unsigned __int128 sumSquares)
+{
+    if(count < 1)
+    {
+        return 0.0;
+    }
+
+    __int128 spread = ((__int128)count * (__int128)sumSquares) - ((__int128)sum * sum);
+
+    return (double)((long double)spread / count / count);
+}
+
+
+#ifdef STATS_HAVE_AVX2
+///-------------------------------------------------
+/// @brief  AVX2 part of the fused reduction. One
+///         unaligned load starting at a task's
+///         wait time covers the wait and turnaround
+///         times of that task and the next one, so
+///         no gather is needed. Squares are built
+///         from 16-bit halves so that the 64-bit
+///         lanes can't overflow.
+///
+/// @param[in] task The task queue array
+/// @param[in] size Size of the task queue array
+/// @param[in] totals The running totals
+///
+/// @return Number of tasks accumulated (always
+///         from the start of the array)
+///-------------------------------------------------
+__attribute__((target("avx2")))
+static int accumulateTimesAvx2(struct task_t* task, int size, struct online_stats_t* totals)
+{
+    // Lanes of the times in a load that starts at
+    // the first task's wait time
+    const int taskLanes = sizeof(struct task_t) / sizeof(int);
+    const int turnaroundLane = (offsetof(struct task_t, turnaround_time) - offsetof(struct task_t, waiting_time)) / sizeof(int);
+
+    _Static_assert((sizeof(struct task_t) % sizeof(int)) == 0, "task_t must be made of ints");
+    _Static_assert(offsetof(struct task_t, turnaround_time) > offsetof(struct task_t, waiting_time), "turnaround must follow wait");
+
+    if((taskLanes + turnaroundLane) > 7)
+    {
+        return 0;
+    }
+
+    // Gather [wait A, wait B, turnaround A, turnaround B]
+    // into the low half
+    __m256i lanes = _mm256_setr_epi32(0, taskLanes, turnaroundLane, taskLanes + turnaroundLane, 0, 0, 0, 0);
+    __m256i lowMask = _mm256_set1_epi64x(0xffff);
+
+    __m128i minimum = _mm_set1_epi32(INT_MAX);
+    __m128i maximum = _mm_set1_epi32(INT_MIN);
+    __m256i sum = _mm256_setzero_si256();
+    __m256i squareHigh = _mm256_setzero_si256();
+    __m256i squareMiddle = _mm256_setzero_si256();
+    __m256i squareLow = _mm256_setzero_si256();
+
+    // Stop while the 32 byte load stays inside the array
+    const char* end = (const char*)(task + size);
+    int i = 0;
+
+    for(; (i + 1 < size) && ((const char*)&(task[i].waiting_time) + sizeof(__m256i) <= end); i += 2)
+    {
+        __m256i row = _mm256_loadu_si256((const __m256i*)&(task[i].waiting_time));
+        __m128i times = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(row, lanes));
+
+        minimum = _mm_min_epi32(minimum, times);
+        maximum = _mm_max_epi32(maximum, times);
+
+        __m256i wide = _mm256_cvtepi32_epi64(times);
+        sum = _mm256_add_epi64(sum, wide);
+
+        // |x|^2 = (h * 2^16 + l)^2 with h, l < 2^16
+        __m256i magnitude = _mm256_cvtepu32_epi64(_mm_abs_epi32(times));
+        __m256i high = _mm256_srli_epi64(magnitude, 16);
+        __m256i low = _mm256_and_si256(magnitude, lowMask);
+
+        squareHigh = _mm256_add_epi64(squareHigh, _mm256_mul_epu32(high, high));
+        squareMiddle = _mm256_add_epi64(squareMiddle, _mm256_mul_epu32(high, low));
+        squareLow = _mm256_add_epi64(squareLow, _mm256_mul_epu32(low, low));
+    }
+
+    int minimumLane[4];
+    int maximumLane[4];
+    long long sumLane[4];
+    unsigned long long highLane[4];
+    unsigned long long middleLane[4];
+    unsigned long long lowLane[4];
+
+    _mm_storeu_si128((__m128i*)minimumLane, minimum);
+    _mm_storeu_si128((__m128i*)maximumLane, maximum);
+    _mm256_storeu_si256((__m256i*)sumLane, sum);
+    _mm256_storeu_si256((__m256i*)highLane, squareHigh);
+    _mm256_storeu_si256((__m256i*)middleLane, squareMiddle);
+    _mm256_storeu_si256((__m256i*)lowLane, squareLow);
+
+    // Lanes 0-1 hold wait times, lanes 2-3 turnaround
+    for(int lane = 0; lane < 4; lane++)
+    {
+        int field = lane / 2;
+
+        totals->sum[field] += sumLane[lane];
+        totals->sumSquares[field] += ((unsigned __int128)highLane[lane] << 32) + ((unsigned __int128)middleLane[lane] << 17) + lowLane[lane];
+
+        if(minimumLane[lane] < totals->min[field])
+        {
+            totals->min[field] = minimumLane[lane];
+        }
+
+        if(maximumLane[lane] > totals->max[field])
+        {
+            totals->max[field] = maximumLane[lane];
+        }
+    }
+
+    return i;
+}
+#endif
@@ -0,0 +1,848 @@
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "sjf.h"
+#include "context.h"
+#include "generator.h"
+#include "stats.h"
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Monte Carlo sweep of the SJF scheduler: runs many generated task sets for every
+/// configuration (task count and execution time distribution) on a pool of threads, and
+/// reports the wait and turn around time distribution of each configuration. Each thread runs on
+/// its own scheduler context and owns a range of the scenarios; an idle thread steals half of the
+/// range of another. Every scenario is seeded from its own index, so the results don't depend on
+/// the number of threads or on which thread ran what.
+///
+/// @Usage
+/// ./sweep [-n tasks,...] [-d distribution,...] [-r scenarios per configuration] [-j threads]
+///         [-e engine] [-s seed] [-f csv|json]
+/// Distributions are uniform, exponential, bimodal and pareto; -j defaults to every online CPU.
+//----------------------------------------------------------------------------------------------------------------------------------
+
+// Most values in one list option
+#define SWEEP_MAX_VALUES 16
+
+// Most threads in the pool
+#define SWEEP_MAX_THREADS 256
+
+// Scenarios a thread takes from its own range at a time (never across configurations)
+#define SWEEP_BATCH 8
+
+// Largest task set of one scenario
+#define SWEEP_MAX_TASKS (1 << 20)
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds the running totals of a number of scenarios
+//----------------------------------------------------------------------------------------------------------------------------------
+struct sweep_totals_t {
+    // Wait and turn around time of every task
+    struct histogram_t wait;
+    struct histogram_t turnaround;
+
+    // Scenarios added, with the sums and sums of squares of their total wait and turn around times
+    // (exact, so that the spread of the scenario means doesn't depend on the order of the additions)
+    long long scenarios;
+    long long waitSum;
+    long long turnaroundSum;
+    unsigned __int128 waitSquares;
+    unsigned __int128 turnaroundSquares;
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds one configuration and its results
+//----------------------------------------------------------------------------------------------------------------------------------
+struct sweep_config_t {
+    int tasks;
+    int distribution;
+
+    // Results of every thread, merged when a thread moves on from the configuration
+    pthread_mutex_t lock;
+    struct sweep_totals_t totals;
+};
+
+struct sweep_t;
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds one thread of the pool. The range fields are guarded by the lock:
+/// the owner takes scenarios from the front, thieves take the back half.
+//----------------------------------------------------------------------------------------------------------------------------------
+struct sweep_worker_t {
+    pthread_mutex_t lock;
+    long long next;
+    long long end;
+
+    struct sweep_t* sweep;
+    int id;
+    pthread_t thread;
+
+    // Scenarios run and ranges stolen
+    long long scenarios;
+    long long steals;
+
+    // Totals of the configuration being run (-1 for none), merged when it changes
+    int config;
+    struct sweep_totals_t local;
+} __attribute__((aligned(64)));
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds the whole sweep
+//----------------------------------------------------------------------------------------------------------------------------------
+struct sweep_t {
+    struct sweep_config_t* config;
+    int configs;
+
+    // Scenario i runs configuration i / trials
+    long long trials;
+    long long total;
+
+    enum sjf_engine_t engine;
+    unsigned long long seed;
+
+    struct sweep_worker_t* worker;
+    int threads;
+
+    // Set if a thread couldn't allocate its scenarios
+    int failed;
+};
+
+static const char* sweepDistributions[] = {"uniform", "exponential", "bimodal", "pareto"};
+
+static const struct {
+    const char* name;
+    enum sjf_engine_t engine;
+} sweepEngines[] = {
+    {"queue", SJF_ENGINE_QUEUE},
+    {"prefix_sum", SJF_ENGINE_PREFIX_SUM},
+};
+
+static void* runWorker(void* arg);
+static int takeBatch(struct sweep_worker_t* worker, long long* first, long long* last);
+static int stealRange(struct sweep_worker_t* worker);
+static void runScenario(struct sweep_worker_t* worker, struct sjf_context_t* context, struct task_t* task, long long scenario);
+static void mergeLocal(struct sweep_worker_t* worker);
+static void totalsInit(struct sweep_totals_t* totals);
+static unsigned long long scenarioSeed(unsigned long long seed, long long scenario);
+static double meanInterval(long long count, long long sum, unsigned __int128 squares, int tasks);
+static int parseInts(const char* text, int* values);
+static int parseDistributions(const char* text, int* values);
+static double nowSeconds(void);
+static void printValue(double value, const char* missing);
+static void printCsv(const struct sweep_t* sweep);
+static void printJson(const struct sweep_t* sweep, const char* engine, double seconds);
+
+
+int main(int argc, char *argv[])
+{
+    const char* format = "csv";
+    const char* engineName = "queue";
+    int tasks[SWEEP_MAX_VALUES] = {256, 4096, 65536};
+    int distributions[SWEEP_MAX_VALUES] = {0, 1, 2, 3};
+    int taskCount = 3;
+    int distributionCount = 4;
+    long long trials = 200;
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned long long seed = 1;
+    int option;
+
+    while((option = getopt(argc, argv, "n:d:r:j:e:s:f:")) != -1)
+    {
+        switch(option)
+        {
+            case 'n':
+                taskCount = parseInts(optarg, tasks);
+                break;
+
+            case 'd':
+                distributionCount = parseDistributions(optarg, distributions);
+                break;
+
+            case 'r':
+                trials = atoll(optarg);
+                break;
+
+            case 'j':
+                threads = atol(optarg);
+                break;
+
+            case 'e':
+                engineName = optarg;
+                break;
+
+            case 's':
+                seed = strtoull(optarg, NULL, 0);
+                break;
+
+            case 'f':
+                format = optarg;
+                break;
+
+            default:
+                taskCount = -1;
+                break;
+        }
+    }
+
+    int engine = -1;
+
+    for(size_t i = 0; i < sizeof(sweepEngines) / sizeof(sweepEngines[0]); i++)
+    {
+        if(strcmp(engineName, sweepEngines[i].name) == 0)
+        {
+            engine = sweepEngines[i].engine;
+        }
+    }
+
+    // Validate parameters
+    if((taskCount < 1) || (distributionCount < 1) || (trials < 1) || (engine < 0))
+    {
+        fprintf(stderr, "usage: %s [-n tasks,...] [-d distribution,...] [-r scenarios per configuration] [-j threads]\n"
+                        "       [-e queue|prefix_sum] [-s seed] [-f csv|json]\n", argv[0]);
+        return 1;
+    }
+
+    for(int i = 0; i < taskCount; i++)
+    {
+        if((tasks[i] < 1) || (tasks[i] > SWEEP_MAX_TASKS))
+        {
+            fprintf(stderr, "%s: task counts must be in [1, %d]\n", argv[0], SWEEP_MAX_TASKS);
+            return 1;
+        }
+    }
+
+    if(threads < 1)
+    {
+        threads = 1;
+    }
+
+    if(threads > SWEEP_MAX_THREADS)
+    {
+        threads = SWEEP_MAX_THREADS;
+    }
+
+    struct sweep_t sweep;
+
+    sweep.configs = taskCount * distributionCount;
+    sweep.trials = trials;
+    sweep.total = sweep.configs * trials;
+    sweep.engine = (enum sjf_engine_t)engine;
+    sweep.seed = seed;
+    sweep.threads = (int)threads;
+    sweep.failed = 0;
+    sweep.config = (struct sweep_config_t*)malloc(sweep.configs * sizeof(struct sweep_config_t));
+
+    // Threads' ranges sit on their own cache lines
+    if(posix_memalign((void**)&(sweep.worker), 64, sweep.threads * sizeof(struct sweep_worker_t)) != 0)
+    {
+        sweep.worker = NULL;
+    }
+
+    if((sweep.config == NULL) || (sweep.worker == NULL))
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't create the sweep!\n", __func__);
+        free(sweep.config);
+        free(sweep.worker);
+        return 1;
+    }
+
+    // Every combination, task count outermost
+    int index = 0;
+
+    for(int i = 0; i < taskCount; i++)
+    {
+        for(int j = 0; j < distributionCount; j++)
+        {
+            struct sweep_config_t* config = &(sweep.config[index++]);
+
+            config->tasks = tasks[i];
+            config->distribution = distributions[j];
+            pthread_mutex_init(&(config->lock), NULL);
+            totalsInit(&(config->totals));
+        }
+    }
+
+    // Hand every thread an equal share of the scenarios
+    // (stealing evens out the cost differences)
+    for(int i = 0; i < sweep.threads; i++)
+    {
+        struct sweep_worker_t* worker = &(sweep.worker[i]);
+
+        pthread_mutex_init(&(worker->lock), NULL);
+        worker->next = sweep.total * i / sweep.threads;
+        worker->end = sweep.total * (i + 1) / sweep.threads;
+        worker->sweep = &sweep;
+        worker->id = i;
+        worker->scenarios = 0;
+        worker->steals = 0;
+        worker->config = -1;
+        totalsInit(&(worker->local));
+    }
+
+    double start = nowSeconds();
+    int started = 0;
+
+    for(int i = 0; i < sweep.threads; i++)
+    {
+        if(pthread_create(&(sweep.worker[i].thread), NULL, runWorker, &(sweep.worker[i])) != 0)
+        {
+            break;
+        }
+
+        started++;
+    }
+
+    // Threads that didn't start leave their ranges to
+    // be stolen; without any, run on this thread
+    if(started == 0)
+    {
+        runWorker(&(sweep.worker[0]));
+    }
+
+    for(int i = 0; i < started; i++)
+    {
+        pthread_join(sweep.worker[i].thread, NULL);
+    }
+
+    double seconds = nowSeconds() - start;
+    long long scenarios = 0;
+    long long steals = 0;
+
+    for(int i = 0; i < sweep.threads; i++)
+    {
+        scenarios += sweep.worker[i].scenarios;
+        steals += sweep.worker[i].steals;
+    }
+
+    if(strcmp(format, "json") == 0)
+    {
+        printJson(&sweep, engineName, seconds);
+    }
+    else
+    {
+        printCsv(&sweep);
+    }
+
+    fprintf(stderr, "%lld scenarios on %d threads in %.3f s (%.0f scenarios/s, %lld steals)\n",
+            scenarios, sweep.threads, seconds, scenarios / seconds, steals);
+
+    int failed = sweep.failed || (scenarios != sweep.total);
+
+    for(int i = 0; i < sweep.configs; i++)
+    {
+        pthread_mutex_destroy(&(sweep.config[i].lock));
+    }
+
+    for(int i = 0; i < sweep.threads; i++)
+    {
+        pthread_mutex_destroy(&(sweep.worker[i].lock));
+    }
+
+    free(sweep.config);
+    free(sweep.worker);
+
+    return failed;
+}
+
+
+///-------------------------------------------------
+/// @brief  Runs scenarios from the thread's own
+///         range, then from stolen ranges, until
+///         none are left anywhere
+///
+/// @param[in] arg The sweep_worker_t to run
+///
+/// @return NULL
+///-------------------------------------------------
+static void* runWorker(void* arg)
+{
+    struct sweep_worker_t* worker = (struct sweep_worker_t*)arg;
+    struct sweep_t* sweep = worker->sweep;
+    int largest = 0;
+
+    for(int i = 0; i < sweep->configs; i++)
+    {
+        if(sweep->config[i].tasks > largest)
+        {
+            largest = sweep->config[i].tasks;
+        }
+    }
+
+    struct task_t* task = (struct task_t*)malloc(largest * sizeof(struct task_t));
+    struct sjf_context_t* context = create_sjf_context(sweep->engine, NULL);
+
+    if((task == NULL) || (context == NULL))
+    {
+        // The thread's range is left for the others
+        fprintf(stderr, "%s() ERROR: Couldn't create a scheduler context!\n", __func__);
+        __atomic_store_n(&(sweep->failed), 1, __ATOMIC_RELAXED);
+        destroy_sjf_context(context);
+        free(task);
+        return NULL;
+    }
+
+    long long first = 0;
+    long long last = 0;
+
+    // NOTE: A stolen range can itself be stolen from
+    //       before it is taken, so steal until there
+    //       is nothing left anywhere
+    while(takeBatch(worker, &first, &last) || stealRange(worker))
+    {
+        for(long long scenario = first; scenario < last; scenario++)
+        {
+            runScenario(worker, context, task, scenario);
+        }
+
+        first = last = 0;
+    }
+
+    mergeLocal(worker);
+
+    destroy_sjf_context(context);
+    free(task);
+
+    return NULL;
+}
+
+
+///-------------------------------------------------
+/// @brief  Takes the next scenarios from the front
+///         of the thread's own range
+///
+/// @param[in] worker The thread
+/// @param[out] first First scenario taken
+/// @param[out] last One past the last scenario
+///
+/// @return 1 if scenarios were taken, 0 if the
+///         range is empty
+///-------------------------------------------------
+static int takeBatch(struct sweep_worker_t* worker, long long* first, long long* last)
+{
+    long long trials = worker->sweep->trials;
+
+    pthread_mutex_lock(&(worker->lock));
+
+    if(worker->next >= worker->end)
+    {
+        pthread_mutex_unlock(&(worker->lock));
+        return 0;
+    }
+
+    // Stop at the end of the configuration, so that
+    // a batch adds to a single set of totals
+    long long limit = (worker->next / trials + 1) * trials;
+
+    *first = worker->next;
+    *last = worker->next + SWEEP_BATCH;
+
+    if(*last > worker->end)
+    {
+        *last = worker->end;
+    }
+
+    if(*last > limit)
+    {
+        *last = limit;
+    }
+
+    worker->next = *last;
+
+    pthread_mutex_unlock(&(worker->lock));
+
+    return 1;
+}
+
+
+///-------------------------------------------------
+/// @brief  Moves the back half of another thread's
+///         range into the thread's own (empty)
+///         range
+///
+/// @param[in] worker The idle thread
+///
+/// @return 1 if a range was stolen, 0 if there is
+///         nothing left to steal
+///-------------------------------------------------
+static int stealRange(struct sweep_worker_t* worker)
+{
+    struct sweep_t* sweep = worker->sweep;
+
+    for(int i = 1; i < sweep->threads; i++)
+    {
+        struct sweep_worker_t* victim = &(sweep->worker[(worker->id + i) % sweep->threads]);
+
+        pthread_mutex_lock(&(victim->lock));
+
+        long long remaining = victim->end - victim->next;
+
+        // The victim's next scenario stays with it
+        if(remaining < 2)
+        {
+            pthread_mutex_unlock(&(victim->lock));
+            continue;
+        }
+
+        long long middle = victim->end - remaining / 2;
+        long long end = victim->end;
+
+        victim->end = middle;
+
+        pthread_mutex_unlock(&(victim->lock));
+
+        pthread_mutex_lock(&(worker->lock));
+        worker->next = middle;
+        worker->end = end;
+        pthread_mutex_unlock(&(worker->lock));
+
+        worker->steals++;
+
+        return 1;
+    }
+
+    return 0;
+}
+
+
+///-------------------------------------------------
+/// @brief  Generates and schedules one scenario
+///         and adds it to the thread's totals
+///
+/// @param[in] worker The thread
+/// @param[in] context The thread's scheduler
+///                    context
+/// @param[in] task Room for the largest task set
+/// @param[in] scenario Index of the scenario
+///
+/// @return None
+///-------------------------------------------------
+static void runScenario(struct sweep_worker_t* worker, struct sjf_context_t* context, struct task_t* task, long long scenario)
+{
+    struct sweep_t* sweep = worker->sweep;
+    int index = (int)(scenario / sweep->trials);
+    struct sweep_config_t* config = &(sweep->config[index]);
+    struct generator_config_t generatorConfig;
+
+    // Moving on to another configuration
+    if(worker->config != index)
+    {
+        mergeLocal(worker);
+        worker->config = index;
+    }
+
+    generator_default_config(&generatorConfig, scenarioSeed(sweep->seed, scenario));
+    generatorConfig.execution = (enum generator_distribution_t)config->distribution;
+
+    struct generator_t* generator = create_generator(&generatorConfig);
+
+    if(generator == NULL)
+    {
+        __atomic_store_n(&(sweep->failed), 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    generate_tasks(generator, task, config->tasks);
+    destroy_generator(generator);
+
+    sjf_context_run(context, task, config->tasks);
+
+    struct sweep_totals_t* local = &(worker->local);
+
+    histogram_record_wait_times(&(local->wait), task, config->tasks);
+    histogram_record_turnaround_times(&(local->turnaround), task, config->tasks);
+
+    local->scenarios++;
+    local->waitSum += context->stats.waitSum;
+    local->turnaroundSum += context->stats.turnaroundSum;
+    local->waitSquares += (unsigned __int128)context->stats.waitSum * context->stats.waitSum;
+    local->turnaroundSquares += (unsigned __int128)context->stats.turnaroundSum * context->stats.turnaroundSum;
+
+    worker->scenarios++;
+}
+
+
+///-------------------------------------------------
+/// @brief  Adds the thread's totals to those of
+///         their configuration and clears them
+///
+/// @param[in] worker The thread
+///
+/// @return None
+///-------------------------------------------------
+static void mergeLocal(struct sweep_worker_t* worker)
+{
+    struct sweep_totals_t* local = &(worker->local);
+
+    if(worker->config < 0)
+    {
+        return;
+    }
+
+    struct sweep_config_t* config = &(worker->sweep->config[worker->config]);
+
+    if(local->scenarios > 0)
+    {
+        pthread_mutex_lock(&(config->lock));
+
+        histogram_merge(&(config->totals.wait), &(local->wait));
+        histogram_merge(&(config->totals.turnaround), &(local->turnaround));
+        config->totals.scenarios += local->scenarios;
+        config->totals.waitSum += local->waitSum;
+        config->totals.turnaroundSum += local->turnaroundSum;
+        config->totals.waitSquares += local->waitSquares;
+        config->totals.turnaroundSquares += local->turnaroundSquares;
+
+        pthread_mutex_unlock(&(config->lock));
+    }
+
+    totalsInit(local);
+    worker->config = -1;
+}
+
+
+///-------------------------------------------------
+/// @brief  Empties a set of totals
+///
+/// @param[in] totals The totals
+///
+/// @return None
+///-------------------------------------------------
+static void totalsInit(struct sweep_totals_t* totals)
+{
+    histogram_init(&(totals->wait));
+    histogram_init(&(totals->turnaround));
+    totals->scenarios = 0;
+    totals->waitSum = 0;
+    totals->turnaroundSum = 0;
+    totals->waitSquares = 0;
+    totals->turnaroundSquares = 0;
+}
+
+
+///-------------------------------------------------
+/// @brief  Derives the generator seed of a
+///         scenario (SplitMix64 of the sweep seed
+///         and the scenario index)
+///
+/// @param[in] seed Seed of the sweep
+/// @param[in] scenario Index of the scenario
+///
+/// @return The scenario's seed
+///-------------------------------------------------
+static unsigned long long scenarioSeed(unsigned long long seed, long long scenario)
+{
+    unsigned long long value = seed + (unsigned long long)scenario * 0x9e3779b97f4a7c15ULL;
+
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+
+    return value ^ (value >> 31);
+}
+
+
+///-------------------------------------------------
+/// @brief  Half width of the 95% confidence
+///         interval of the mean time per task,
+///         from the spread of the scenario means
+///
+/// @param[in] count Number of scenarios
+/// @param[in] sum Sum of the scenario totals
+/// @param[in] squares Sum of their squares
+/// @param[in] tasks Tasks per scenario
+///
+/// @return The half width, NAN with fewer than
+///         two scenarios
+///-------------------------------------------------
+static double meanInterval(long long count, long long sum, unsigned __int128 squares, int tasks)
+{
+    if(count < 2)
+    {
+        return NAN;
+    }
+
+    // n * sum(x^2) - sum(x)^2 is exact and never
+    // negative
+    unsigned __int128 spread = (unsigned __int128)count * squares - (unsigned __int128)sum * sum;
+    double variance = (double)spread / ((double)count * (count - 1)) / ((double)tasks * tasks);
+
+    return 1.96 * sqrt(variance / count);
+}
+
+
+///-------------------------------------------------
+/// @brief  Parses a comma separated list of ints
+///
+/// @param[in] text The list
+/// @param[out] values Room for SWEEP_MAX_VALUES
+///
+/// @return Number of values, -1 if malformed
+///-------------------------------------------------
+static int parseInts(const char* text, int* values)
+{
+    int count = 0;
+
+    while(*text != '\0')
+    {
+        char* end;
+        long value = strtol(text, &end, 10);
+
+        if((end == text) || (count == SWEEP_MAX_VALUES) || ((*end != ',') && (*end != '\0')))
+        {
+            return -1;
+        }
+
+        values[count++] = (int)value;
+        text = (*end == ',') ? end + 1 : end;
+    }
+
+    return (count > 0) ? count : -1;
+}
+
+
+///-------------------------------------------------
+/// @brief  Parses a comma separated list of
+///         distribution names
+///
+/// @param[in] text The list
+/// @param[out] values Room for SWEEP_MAX_VALUES
+///
+/// @return Number of values, -1 if malformed
+///-------------------------------------------------
+static int parseDistributions(const char* text, int* values)
+{
+    int count = 0;
+
+    while(*text != '\0')
+    {
+        size_t length = strcspn(text, ",");
+        int found = -1;
+
+        for(int i = 0; i < 4; i++)
+        {
+            if((strlen(sweepDistributions[i]) == length) && (strncmp(text, sweepDistributions[i], length) == 0))
+            {
+                found = i;
+            }
+        }
+
+        if((found < 0) || (count == SWEEP_MAX_VALUES))
+        {
+            return -1;
+        }
+
+        values[count++] = found;
+        text += (text[length] == ',') ? length + 1 : length;
+    }
+
+    return (count > 0) ? count : -1;
+}
+
+
+///-------------------------------------------------
+/// @brief  Reads the monotonic clock
+///
+/// @return Seconds since an arbitrary point
+///-------------------------------------------------
+static double nowSeconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double)now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+
+///-------------------------------------------------
+/// @brief  Prints a number, or a placeholder if it
+///         is NAN
+///
+/// @param[in] value The number
+/// @param[in] missing Printed instead of NAN
+///
+/// @return None
+///-------------------------------------------------
+static void printValue(double value, const char* missing)
+{
+    isnan(value) ? printf("%s", missing) : printf("%.3f", value);
+}
+
+
+///-------------------------------------------------
+/// @brief  Prints one row per configuration as CSV
+///
+/// @param[in] sweep The finished sweep
+///
+/// @return None
+///-------------------------------------------------
+static void printCsv(const struct sweep_t* sweep)
+{
+    printf("tasks,distribution,scenarios,"
+           "wait_mean,wait_mean_ci95,wait_p50,wait_p90,wait_p99,wait_max,"
+           "turnaround_mean,turnaround_mean_ci95,turnaround_p50,turnaround_p90,turnaround_p99,turnaround_max\n");
+
+    for(int i = 0; i < sweep->configs; i++)
+    {
+        const struct sweep_config_t* config = &(sweep->config[i]);
+        const struct sweep_totals_t* totals = &(config->totals);
+        struct latency_summary_t wait;
+        struct latency_summary_t turnaround;
+
+        histogram_summary(&(totals->wait), &wait);
+        histogram_summary(&(totals->turnaround), &turnaround);
+
+        printf("%d,%s,%lld,%.3f,", config->tasks, sweepDistributions[config->distribution], totals->scenarios, wait.mean);
+        printValue(meanInterval(totals->scenarios, totals->waitSum, totals->waitSquares, config->tasks), "");
+        printf(",%d,%d,%d,%d,%.3f,", wait.p50, wait.p90, wait.p99, wait.max, turnaround.mean);
+        printValue(meanInterval(totals->scenarios, totals->turnaroundSum, totals->turnaroundSquares, config->tasks), "");
+        printf(",%d,%d,%d,%d\n", turnaround.p50, turnaround.p90, turnaround.p99, turnaround.max);
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Prints the sweep as JSON
+///
+/// @param[in] sweep The finished sweep
+/// @param[in] engine Name of the engine used
+/// @param[in] seconds Wall time of the sweep
+///
+/// @return None
+///-------------------------------------------------
+static void printJson(const struct sweep_t* sweep, const char* engine, double seconds)
+{
+    printf("{\"scheduler\":\"sjf\",\"engine\":\"%s\",\"seed\":%llu,\"scenarios_per_configuration\":%lld,"
+           "\"threads\":%d,\"seconds\":%.3f,\"configurations\":[\n", engine, sweep->seed, sweep->trials, sweep->threads, seconds);
+
+    for(int i = 0; i < sweep->configs; i++)
+    {
+        const struct sweep_config_t* config = &(sweep->config[i]);
+        const struct sweep_totals_t* totals = &(config->totals);
+        const struct histogram_t* histogram[] = {&(totals->wait), &(totals->turnaround)};
+        const char* name[] = {"wait", "turnaround"};
+        long long sum[] = {totals->waitSum, totals->turnaroundSum};
+        unsigned __int128 squares[] = {totals->waitSquares, totals->turnaroundSquares};
+
+        printf("{\"tasks\":%d,\"distribution\":\"%s\",\"scenarios\":%lld",
+               config->tasks, sweepDistributions[config->distribution], totals->scenarios);
+
+        for(int j = 0; j < 2; j++)
+        {
+            struct latency_summary_t summary;
+            double interval = meanInterval(totals->scenarios, sum[j], squares[j], config->tasks);
+
+            histogram_summary(histogram[j], &summary);
+
+            printf(",\"%s\":{\"mean\":%.3f,\"mean_ci95\":", name[j], summary.mean);
+            printValue(interval, "null");
+            printf(",\"p50\":%d,\"p90\":%d,\"p99\":%d,\"p999\":%d,\"max\":%d}",
+                   summary.p50, summary.p90, summary.p99, summary.p999, summary.max);
+        }
+
+        printf("}%s\n", (i + 1 < sweep->configs) ? "," : "");
+    }
+
+    printf("]}\n");
+}
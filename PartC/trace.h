@@ -0,0 +1,171 @@
+#include <stdio.h>
+
+#ifndef __TRACE__
+#define __TRACE__
+
+// Trace levels (each level includes the ones below it)
+#define TRACE_LEVEL_OFF 0
+#define TRACE_LEVEL_SUMMARY 1
+#define TRACE_LEVEL_TASK 2
+#define TRACE_LEVEL_AGING 3
+
+// Highest level compiled in. Release builds (NDEBUG) compile every trace call out; override with
+// -DTRACE_COMPILE_LEVEL=<level>.
+#ifndef TRACE_COMPILE_LEVEL
+#ifdef NDEBUG
+#define TRACE_COMPILE_LEVEL TRACE_LEVEL_OFF
+#else
+#define TRACE_COMPILE_LEVEL TRACE_LEVEL_AGING
+#endif
+#endif
+
+// Size of the preallocated trace buffer in bytes
+#define TRACE_BUFFER_SIZE (64 * 1024)
+
+// Longest single trace message in bytes (longer messages are truncated)
+#define TRACE_LINE_SIZE 256
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Where buffered trace output goes
+//----------------------------------------------------------------------------------------------------------------------------------
+enum trace_sink_t {
+
+    // Written to the buffer's stream (stdout by default) in bulk whenever the buffer fills up and
+    // on trace_flush()
+    TRACE_SINK_STDOUT,
+
+    // Kept in memory: once the buffer is full the oldest output is overwritten. What is retained
+    // can be read with trace_snapshot() and is written to the stream when the sink changes.
+    TRACE_SINK_RING
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds a trace level and the buffered output of one trace. The trace_*()
+/// functions work on trace_default; a simulation with its own buffer shares no state with others.
+//----------------------------------------------------------------------------------------------------------------------------------
+struct trace_buffer_t {
+    // Runtime trace level (messages above it are skipped without being formatted)
+    int level;
+
+    // Where buffered output goes, and the stream it is written to (stdout if NULL)
+    enum trace_sink_t sink;
+    FILE* out;
+
+    // Buffered output (a ring of retained output with the ring sink)
+    char data[TRACE_BUFFER_SIZE];
+    size_t start;
+    size_t length;
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Process-wide trace written to stdout (used by the trace_*() functions and TRACE())
+//----------------------------------------------------------------------------------------------------------------------------------
+extern struct trace_buffer_t trace_default;
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Emit a trace message at the given level into a trace buffer. Compiles to nothing when the
+/// level is above TRACE_COMPILE_LEVEL.
+//----------------------------------------------------------------------------------------------------------------------------------
+#define TRACE_TO(trace, messageLevel, ...)                                              \
+    do                                                                                  \
+    {                                                                                   \
+        if(((messageLevel) <= TRACE_COMPILE_LEVEL) && ((messageLevel) <= (trace)->level)) \
+        {                                                                               \
+            trace_buffer_printf((trace), __VA_ARGS__);                                  \
+        }                                                                               \
+    } while(0)
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Emit a trace message at the given level into the process-wide trace
+//----------------------------------------------------------------------------------------------------------------------------------
+#define TRACE(level, ...) TRACE_TO(&trace_default, level, __VA_ARGS__)
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Set the runtime trace level
+///
+/// @param[in] level One of the TRACE_LEVEL_* values
+//----------------------------------------------------------------------------------------------------------------------------------
+void trace_set_level(int level);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Select the trace sink. Buffered output (including a retained ring) is written out first.
+///
+/// @param[in] sink The new sink
+//----------------------------------------------------------------------------------------------------------------------------------
+void trace_set_sink(enum trace_sink_t sink);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Format a message into the trace buffer (use TRACE() so that it can be compiled out)
+///
+/// @param[in] format printf() style format string
+//----------------------------------------------------------------------------------------------------------------------------------
+void trace_printf(const char* format, ...) __attribute__((format(printf, 1, 2)));
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Write the buffered trace output to its stream and empty the buffer (the ring sink keeps its
+/// output in memory)
+//----------------------------------------------------------------------------------------------------------------------------------
+void trace_flush(void);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Copy the buffered trace output (oldest first) without consuming it
+///
+/// @param[out] buffer Destination, NUL terminated
+/// @param[in] size Size of the destination in bytes
+///
+/// @return the number of bytes copied (excluding the NUL)
+//----------------------------------------------------------------------------------------------------------------------------------
+size_t trace_snapshot(char* buffer, size_t size);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Creates an empty trace buffer with the stream sink
+///
+/// @param[in] level One of the TRACE_LEVEL_* values
+/// @param[in] out Stream the output is written to (stdout if NULL)
+///
+/// @return the new trace buffer
+//----------------------------------------------------------------------------------------------------------------------------------
+struct trace_buffer_t* create_trace_buffer(int level, FILE* out);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Select the sink of a trace buffer (see trace_set_sink())
+///
+/// @param[in] trace The trace buffer
+/// @param[in] sink The new sink
+//----------------------------------------------------------------------------------------------------------------------------------
+void trace_buffer_set_sink(struct trace_buffer_t* trace, enum trace_sink_t sink);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Format a message into a trace buffer (use TRACE_TO() so that it can be compiled out)
+///
+/// @param[in] trace The trace buffer
+/// @param[in] format printf() style format string
+//----------------------------------------------------------------------------------------------------------------------------------
+void trace_buffer_printf(struct trace_buffer_t* trace, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Write the output buffered in a trace buffer to its stream (see trace_flush())
+///
+/// @param[in] trace The trace buffer
+//----------------------------------------------------------------------------------------------------------------------------------
+void trace_buffer_flush(struct trace_buffer_t* trace);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Copy the output buffered in a trace buffer (see trace_snapshot())
+///
+/// @param[in] trace The trace buffer
+/// @param[out] buffer Destination, NUL terminated
+/// @param[in] size Size of the destination in bytes
+///
+/// @return the number of bytes copied (excluding the NUL)
+//----------------------------------------------------------------------------------------------------------------------------------
+size_t trace_buffer_snapshot(struct trace_buffer_t* trace, char* buffer, size_t size);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Write out and free a trace buffer
+///
+/// @param[in] trace The trace buffer
+//----------------------------------------------------------------------------------------------------------------------------------
+void destroy_trace_buffer(struct trace_buffer_t* trace);
+
+#endif // __TRACE__
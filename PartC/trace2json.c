@@ -0,0 +1,45 @@
+#include <stdio.h>
+#include "record.h"
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Converts a binary dispatch log into Chrome trace-event JSON
+///
+/// @Usage
+/// ./trace2json <dispatch log> [output.json]   (writes to stdout without an output path)
+//----------------------------------------------------------------------------------------------------------------------------------
+
+int main(int argc, const char *argv[])
+{
+    if((argc < 2) || (argc > 3))
+    {
+        fprintf(stderr, "usage: %s <dispatch log> [output.json]\n", argv[0]);
+        return 1;
+    }
+
+    struct dispatch_log_t* log = dispatch_log_read(argv[1]);
+
+    if(log == NULL)
+    {
+        return 1;
+    }
+
+    FILE* out = (argc == 3) ? fopen(argv[2], "w") : stdout;
+
+    if(out == NULL)
+    {
+        fprintf(stderr, "%s: Couldn't open %s!\n", argv[0], argv[2]);
+        destroy_dispatch_log(log);
+        return 1;
+    }
+
+    int result = dispatch_log_export_json(log, out);
+
+    if(out != stdout)
+    {
+        result |= fclose(out);
+    }
+
+    destroy_dispatch_log(log);
+
+    return (result == 0) ? 0 : 1;
+}
@@ -0,0 +1,131 @@
+#include <stdio.h>
+#include "sjf.h"
+
+#ifndef __WORKLOAD__
+#define __WORKLOAD__
+
+// Identifies a packed workload file
+#define WORKLOAD_MAGIC "WLOD"
+
+// Version of the packed workload file layout
+#define WORKLOAD_VERSION 1
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds a workload as one column per field, ready to be passed to init()
+//----------------------------------------------------------------------------------------------------------------------------------
+struct workload_t {
+    // Number of tasks
+    int size;
+
+    // Execution time, priority and arrival time of each task (missing CSV fields are 0)
+    int* execution;
+    int* priority;
+    int* arrival;
+};
+
+// Bytes a workload reader buffers; also the longest CSV line it accepts
+#define WORKLOAD_READ_BUFFER (64 * 1024)
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which reads CSV tasks from a file descriptor one at a time, so memory doesn't
+/// grow with the length of the input
+//----------------------------------------------------------------------------------------------------------------------------------
+struct workload_reader_t {
+    // File descriptor being read (not closed by the reader)
+    int fd;
+
+    // Buffered input: unparsed bytes are [start, end)
+    char* buffer;
+    size_t start;
+    size_t end;
+
+    // Lines consumed so far (for errors), and whether the input has ended
+    int line;
+    int eof;
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Header of a packed workload file. It is followed by the execution, priority and arrival
+/// columns, count ints each, so a load is three copies out of the mapping.
+//----------------------------------------------------------------------------------------------------------------------------------
+struct workload_header_t {
+    char magic[4];
+    int version;
+    int count;
+    int reserved;
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Creates a workload of zeroed tasks
+///
+/// @param[in] size The number of tasks
+///
+/// @return the workload, NULL on failure
+//----------------------------------------------------------------------------------------------------------------------------------
+struct workload_t* create_workload(int size);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Load a workload by mapping the file into memory. Packed files are recognised by their
+/// magic; anything else is parsed as CSV with one task per line, `execution[,priority[,arrival]]`,
+/// an optional header line and optional CRLF line endings.
+///
+/// @param[in] path Path of the file to load
+///
+/// @return the workload, NULL on failure
+//----------------------------------------------------------------------------------------------------------------------------------
+struct workload_t* workload_load(const char* path);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Write a workload as a packed file
+///
+/// @param[in] workload The workload
+/// @param[in] path Path of the file to write
+///
+/// @return 0 on success, -1 on failure
+//----------------------------------------------------------------------------------------------------------------------------------
+int workload_write(const struct workload_t* workload, const char* path);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Intialize a task array from a workload (the scheduler has no use for priorities or
+/// arrival times)
+///
+/// @param[in] workload The workload
+/// @param[in] task The buffer to fill, with room for workload->size tasks
+//----------------------------------------------------------------------------------------------------------------------------------
+void workload_init_tasks(const struct workload_t* workload, struct task_t* task);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Creates a reader for CSV tasks (same format as workload_load()) on a file descriptor such
+/// as a pipe or stdin
+///
+/// @param[in] fd File descriptor to read
+///
+/// @return the reader, NULL on failure
+//----------------------------------------------------------------------------------------------------------------------------------
+struct workload_reader_t* create_workload_reader(int fd);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Read the next task, blocking until a whole line is available
+///
+/// @param[in] reader The reader
+/// @param[out] value The execution time, priority and arrival time of the task
+///
+/// @return 1 if a task was read, 0 at the end of the input, -1 on failure
+//----------------------------------------------------------------------------------------------------------------------------------
+int workload_reader_next(struct workload_reader_t* reader, int* value);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Free a reader
+///
+/// @param[in] reader The reader
+//----------------------------------------------------------------------------------------------------------------------------------
+void destroy_workload_reader(struct workload_reader_t* reader);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Free a workload
+///
+/// @param[in] workload The workload
+//----------------------------------------------------------------------------------------------------------------------------------
+void destroy_workload(struct workload_t* workload);
+
+#endif // __WORKLOAD__
@@ -0,0 +1,436 @@
+#include <limits.h>
+#include "aging.h"
+
+
+static void setTrigger(struct aging_index_t* index, int id, int time);
+static void removeTrigger(struct aging_index_t* index, int id);
+static void discardPastTriggers(struct aging_index_t* index, int runTime);
+static void collectFired(struct aging_index_t* index, int slot, int runTime, int* count);
+static int earliestAfter(struct aging_index_t* index, int slot, int runTime);
+static void triggerSwap(struct aging_index_t* index, int slotA, int slotB);
+static void triggerSiftUp(struct aging_index_t* index, int slot);
+static void triggerSiftDown(struct aging_index_t* index, int slot);
+
+
+///-------------------------------------------------
+/// @brief  Given an array of tasks, construct an
+///         aging index with every trigger armed
+///
+/// @param[in] task Array of tasks to index
+/// @param[in] size The number of tasks to index
+///
+/// @return The aging index
+///-------------------------------------------------
+struct aging_index_t* create_aging_index(struct task_t* task, int size)
+{
+    // Validate parameters
+    if((task == NULL) || (size < 1))
+    {
+        return NULL;
+    }
+
+    struct aging_index_t* index = (struct aging_index_t*)malloc(sizeof(struct aging_index_t));
+
+    if(index == NULL)
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't create aging index!\n", __func__);
+        return NULL;
+    }
+
+    index->triggers = (struct aging_trigger_t*)malloc(2 * size * sizeof(struct aging_trigger_t));
+    index->position = (int*)malloc(2 * size * sizeof(int));
+    index->firedStamp = (int*)malloc(size * sizeof(int));
+    index->fired = (struct task_t**)malloc(size * sizeof(struct task_t*));
+
+    // Verify that malloc didn't fail
+    if((index->triggers == NULL) || (index->position == NULL) || (index->firedStamp == NULL) || (index->fired == NULL))
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't create aging index!\n", __func__);
+        destroy_aging_index(index);
+        return NULL;
+    }
+
+    index->base = task;
+    index->size = 0;
+    index->capacity = size;
+    index->generation = 0;
+
+    for(int i = 0; i < size; i++)
+    {
+        index->position[2 * i] = -1;
+        index->position[(2 * i) + 1] = -1;
+        index->firedStamp[i] = 0;
+
+        aging_index_arm(index, &(task[i]), 0);
+    }
+
+    return index;
+}
+
+
+///-------------------------------------------------
+/// @brief  Arm a task's triggers from its current
+///         execution time and time left
+///
+/// @param[in] index The aging index
+/// @param[in] task The task to arm
+/// @param[in] runTime The current runtime of
+///                    the system
+///-------------------------------------------------
+void aging_index_arm(struct aging_index_t* index, struct task_t* task, int runTime)
+{
+    // Validate parameters
+    if((index == NULL) || (task == NULL))
+    {
+        return;
+    }
+
+    int taskIndex = task - index->base;
+
+    if((taskIndex < 0) || (taskIndex >= index->capacity))
+    {
+        return;
+    }
+
+    // Execution time rule
+    if(task->execution_time >= runTime)
+    {
+        setTrigger(index, 2 * taskIndex, task->execution_time);
+    }
+    else
+    {
+        removeTrigger(index, 2 * taskIndex);
+    }
+
+    // Time left rule
+    if(task->left_to_execute >= runTime)
+    {
+        setTrigger(index, (2 * taskIndex) + 1, task->left_to_execute);
+    }
+    else
+    {
+        removeTrigger(index, (2 * taskIndex) + 1);
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Disarm both triggers of a task
+///
+/// @param[in] index The aging index
+/// @param[in] task The task to disarm
+///-------------------------------------------------
+void aging_index_disarm(struct aging_index_t* index, struct task_t* task)
+{
+    // Validate parameters
+    if((index == NULL) || (task == NULL))
+    {
+        return;
+    }
+
+    int taskIndex = task - index->base;
+
+    if((taskIndex < 0) || (taskIndex >= index->capacity))
+    {
+        return;
+    }
+
+    removeTrigger(index, 2 * taskIndex);
+    removeTrigger(index, (2 * taskIndex) + 1);
+}
+
+
+///-------------------------------------------------
+/// @brief  Collect the tasks whose aging rule
+///         fires at the given runtime
+///
+/// @param[in] index The aging index
+/// @param[in] runTime The current runtime of
+///                    the system
+///
+/// @return Number of tasks in index->fired
+///-------------------------------------------------
+int aging_index_fire(struct aging_index_t* index, int runTime)
+{
+    if(index == NULL)
+    {
+        return 0;
+    }
+
+    int count = 0;
+
+    discardPastTriggers(index, runTime);
+
+    index->generation++;
+    collectFired(index, 0, runTime, &count);
+
+    return count;
+}
+
+
+///-------------------------------------------------
+/// @brief  Find the earliest trigger after the
+///         given runtime
+///
+/// @param[in] index The aging index
+/// @param[in] runTime The current runtime of
+///                    the system
+///
+/// @return Runtime of the next trigger (INT_MAX
+///         if there is none)
+///-------------------------------------------------
+int aging_index_next(struct aging_index_t* index, int runTime)
+{
+    if(index == NULL)
+    {
+        return INT_MAX;
+    }
+
+    discardPastTriggers(index, runTime);
+
+    return earliestAfter(index, 0, runTime);
+}
+
+
+///-------------------------------------------------
+/// @brief  Free all memory owned by the aging
+///         index
+///
+/// @param[in] index The aging index to free
+///-------------------------------------------------
+void destroy_aging_index(struct aging_index_t* index)
+{
+    if(index == NULL)
+    {
+        return;
+    }
+
+    free(index->triggers);
+    free(index->position);
+    free(index->firedStamp);
+    free(index->fired);
+    free(index);
+}
+
+
+///-------------------------------------------------
+/// @brief  Arm a trigger, or move it if it is
+///         already armed
+///
+/// @param[in] index The aging index
+/// @param[in] id The trigger id
+/// @param[in] time Runtime the trigger fires at
+///-------------------------------------------------
+static void setTrigger(struct aging_index_t* index, int id, int time)
+{
+    int slot = index->position[id];
+
+    if(slot == -1)
+    {
+        slot = index->size++;
+        index->triggers[slot].id = id;
+        index->triggers[slot].time = time;
+        index->position[id] = slot;
+
+        triggerSiftUp(index, slot);
+    }
+    else if(time < index->triggers[slot].time)
+    {
+        index->triggers[slot].time = time;
+        triggerSiftUp(index, slot);
+    }
+    else if(time > index->triggers[slot].time)
+    {
+        index->triggers[slot].time = time;
+        triggerSiftDown(index, slot);
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Disarm a trigger if it is armed
+///
+/// @param[in] index The aging index
+/// @param[in] id The trigger id
+///-------------------------------------------------
+static void removeTrigger(struct aging_index_t* index, int id)
+{
+    int slot = index->position[id];
+
+    if(slot == -1)
+    {
+        return;
+    }
+
+    // Move the last trigger into the freed slot
+    index->size--;
+    triggerSwap(index, slot, index->size);
+    index->position[id] = -1;
+
+    if(slot < index->size)
+    {
+        triggerSiftUp(index, slot);
+        triggerSiftDown(index, slot);
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Disarm every trigger whose runtime has
+///         already passed
+///
+/// @param[in] index The aging index
+/// @param[in] runTime The current runtime of
+///                    the system
+///-------------------------------------------------
+static void discardPastTriggers(struct aging_index_t* index, int runTime)
+{
+    while((index->size > 0) && (index->triggers[0].time < runTime))
+    {
+        removeTrigger(index, index->triggers[0].id);
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Walk the part of the heap firing at the
+///         given runtime, reporting each task once
+///
+/// @param[in] index The aging index
+/// @param[in] slot Heap slot to start from
+/// @param[in] runTime The current runtime of
+///                    the system
+/// @param[in,out] count Number of tasks reported
+///-------------------------------------------------
+static void collectFired(struct aging_index_t* index, int slot, int runTime, int* count)
+{
+    // Children never fire earlier than their parent
+    if((slot >= index->size) || (index->triggers[slot].time != runTime))
+    {
+        return;
+    }
+
+    int taskIndex = index->triggers[slot].id / 2;
+
+    if(index->firedStamp[taskIndex] != index->generation)
+    {
+        index->firedStamp[taskIndex] = index->generation;
+        index->fired[(*count)++] = &(index->base[taskIndex]);
+    }
+
+    collectFired(index, (2 * slot) + 1, runTime, count);
+    collectFired(index, (2 * slot) + 2, runTime, count);
+}
+
+
+///-------------------------------------------------
+/// @brief  Find the earliest trigger after the
+///         given runtime below a heap slot
+///
+/// @param[in] index The aging index
+/// @param[in] slot Heap slot to start from
+/// @param[in] runTime The current runtime of
+///                    the system
+///
+/// @return Runtime of the next trigger (INT_MAX
+///         if there is none)
+///-------------------------------------------------
+static int earliestAfter(struct aging_index_t* index, int slot, int runTime)
+{
+    if(slot >= index->size)
+    {
+        return INT_MAX;
+    }
+
+    // The first trigger after runTime on this path
+    // is the earliest of its subtree
+    if(index->triggers[slot].time > runTime)
+    {
+        return index->triggers[slot].time;
+    }
+
+    int left = earliestAfter(index, (2 * slot) + 1, runTime);
+    int right = earliestAfter(index, (2 * slot) + 2, runTime);
+
+    return (left < right) ? left : right;
+}
+
+
+///-------------------------------------------------
+/// @brief  Swap two heap slots and keep the
+///         trigger position index up to date
+///
+/// @param[in] index The aging index
+/// @param[in] slotA First slot
+/// @param[in] slotB Second slot
+///-------------------------------------------------
+static void triggerSwap(struct aging_index_t* index, int slotA, int slotB)
+{
+    struct aging_trigger_t temp = index->triggers[slotA];
+    index->triggers[slotA] = index->triggers[slotB];
+    index->triggers[slotB] = temp;
+
+    index->position[index->triggers[slotA].id] = slotA;
+    index->position[index->triggers[slotB].id] = slotB;
+}
+
+
+///-------------------------------------------------
+/// @brief  Move a trigger towards the top of the
+///         heap until its parent fires no later
+///
+/// @param[in] index The aging index
+/// @param[in] slot The slot of the trigger to move
+///-------------------------------------------------
+static void triggerSiftUp(struct aging_index_t* index, int slot)
+{
+    while(slot > 0)
+    {
+        int parent = (slot - 1) / 2;
+
+        if(index->triggers[parent].time <= index->triggers[slot].time)
+        {
+            break;
+        }
+
+        triggerSwap(index, slot, parent);
+        slot = parent;
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Move a trigger towards the bottom of
+///         the heap until both children fire no
+///         earlier
+///
+/// @param[in] index The aging index
+/// @param[in] slot The slot of the trigger to move
+///-------------------------------------------------
+static void triggerSiftDown(struct aging_index_t* index, int slot)
+{
+    while(1)
+    {
+        int left = (2 * slot) + 1;
+        int right = left + 1;
+        int earliest = slot;
+
+        if((left < index->size) && (index->triggers[left].time < index->triggers[earliest].time))
+        {
+            earliest = left;
+        }
+
+        if((right < index->size) && (index->triggers[right].time < index->triggers[earliest].time))
+        {
+            earliest = right;
+        }
+
+        if(earliest == slot)
+        {
+            break;
+        }
+
+        triggerSwap(index, slot, earliest);
+        slot = earliest;
+    }
+}
@@ -0,0 +1,108 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "priority.h"
+
+#ifndef __AGING__
+#define __AGING__
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds a single aging trigger
+//----------------------------------------------------------------------------------------------------------------------------------
+struct aging_trigger_t {
+    // Runtime at which the trigger fires
+    int time;
+
+    // Trigger id: (2 * task index) for the execution time rule, (2 * task index + 1) for the
+    // time left rule
+    int id;
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds the Aging Index information. Every queued task has up to two
+/// triggers (execution_time == runTime and left_to_execute == runTime) kept in a min-heap on
+/// their firing time, so only the tasks whose rule applies are visited at each quantum.
+//----------------------------------------------------------------------------------------------------------------------------------
+struct aging_index_t {
+    // Min-heap of armed triggers
+    struct aging_trigger_t* triggers;
+
+    // Heap slot of each trigger id (-1 if the trigger is not armed)
+    int* position;
+
+    // Last call of aging_index_fire() that reported each task
+    int* firedStamp;
+
+    // Tasks reported by the last call of aging_index_fire()
+    struct task_t** fired;
+
+    // Task array the index was created from
+    struct task_t* base;
+
+    // Number of armed triggers
+    int size;
+
+    // Number of tasks in the task array
+    int capacity;
+
+    // Number of calls of aging_index_fire() so far
+    int generation;
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Creates an aging index with the triggers of every task in the array armed
+///
+/// @param[in] task The task information
+/// @param[in] size The size of the task array
+///
+/// @return the new aging index
+//----------------------------------------------------------------------------------------------------------------------------------
+struct aging_index_t* create_aging_index(struct task_t* task, int size);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief (Re)arm the triggers of a task from its current execution time and time left. Triggers
+/// that lie in the past are disarmed.
+///
+/// @param[in] index The aging index
+/// @param[in] task The task (must belong to the index's task array)
+/// @param[in] runTime The current runtime of the system
+//----------------------------------------------------------------------------------------------------------------------------------
+void aging_index_arm(struct aging_index_t* index, struct task_t* task, int runTime);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Disarm the triggers of a task which is no longer queued
+///
+/// @param[in] index The aging index
+/// @param[in] task The task (must belong to the index's task array)
+//----------------------------------------------------------------------------------------------------------------------------------
+void aging_index_disarm(struct aging_index_t* index, struct task_t* task);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Collects the tasks with a trigger firing at the given runtime into index->fired. Triggers
+/// stay armed until the runtime moves past them, so repeated calls at the same runtime report the
+/// same tasks (as the full queue traversal would).
+///
+/// @param[in] index The aging index
+/// @param[in] runTime The current runtime of the system
+///
+/// @return the number of tasks in index->fired
+//----------------------------------------------------------------------------------------------------------------------------------
+int aging_index_fire(struct aging_index_t* index, int runTime);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Returns the earliest trigger strictly after the given runtime
+///
+/// @param[in] index The aging index
+/// @param[in] runTime The current runtime of the system
+///
+/// @return the runtime of the next trigger, INT_MAX if there is none
+//----------------------------------------------------------------------------------------------------------------------------------
+int aging_index_next(struct aging_index_t* index, int runTime);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Free the aging index (the tasks themselves are not owned by the index)
+///
+/// @param[in] index The aging index
+//----------------------------------------------------------------------------------------------------------------------------------
+void destroy_aging_index(struct aging_index_t* index);
+
+#endif // __AGING__
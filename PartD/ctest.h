@@ -77,6 +77,7 @@ struct ctest {
 
 #define CTEST_IMPL_NAME(name) ctest_##name
 #define CTEST_IMPL_FNAME(sname, tname) CTEST_IMPL_NAME(sname##_##tname##_run)
+#define CTEST_IMPL_BENCH_FNAME(sname, tname) CTEST_IMPL_NAME(sname##_##tname##_bench)
 #define CTEST_IMPL_TNAME(sname, tname) CTEST_IMPL_NAME(sname##_##tname)
 #define CTEST_IMPL_DATA_SNAME(sname) CTEST_IMPL_NAME(sname##_data)
 #define CTEST_IMPL_DATA_TNAME(sname, tname) CTEST_IMPL_NAME(sname##_##tname##_data)
@@ -172,6 +173,26 @@ void CTEST_ERR(const char* fmt, ...) CTEST_IMPL_FORMAT_PRINTF(1, 2);  // doesn't
 #define CTEST2(sname, tname) CTEST_IMPL_CTEST2(sname, tname, 0)
 #define CTEST2_SKIP(sname, tname) CTEST_IMPL_CTEST2(sname, tname, 1)
 
+/* A benchmark test: the body runs once untimed to warm up, then once per iteration. Each iteration
+ * is timed (in CPU time) whole, or only its ASSERT_FASTER_THAN() region if it has one (so per-iteration setup
+ * stays out of the samples). The min/median/mean/max are reported with the result, and
+ * ASSERT_FASTER_THAN() limits apply to the median. */
+#define CTEST_BENCH_MAX_ITERATIONS 1000
+
+void ctest_bench_run(ctest_nullary_run_func run, int iterations);
+void ctest_bench_run2(ctest_unary_run_func run, void* data, int iterations);
+
+#define CTEST_BENCH(sname, tname, iterations) \
+    static void CTEST_IMPL_BENCH_FNAME(sname, tname)(void); \
+    CTEST_IMPL_CTEST(sname, tname, 0) { ctest_bench_run(CTEST_IMPL_BENCH_FNAME(sname, tname), iterations); } \
+    static void CTEST_IMPL_BENCH_FNAME(sname, tname)(void)
+
+/* A benchmark test on a fixture: setup and teardown run once around all of the iterations. */
+#define CTEST2_BENCH(sname, tname, iterations) \
+    static void CTEST_IMPL_BENCH_FNAME(sname, tname)(struct CTEST_IMPL_DATA_SNAME(sname)* data); \
+    CTEST_IMPL_CTEST2(sname, tname, 0) { ctest_bench_run2((ctest_unary_run_func)CTEST_IMPL_BENCH_FNAME(sname, tname), data, iterations); } \
+    static void CTEST_IMPL_BENCH_FNAME(sname, tname)(struct CTEST_IMPL_DATA_SNAME(sname)* data)
+
 
 void assert_str(const char* exp, const char* real, const char* caller, int line);
 #define ASSERT_STR(exp, real) assert_str(exp, real, __FILE__, __LINE__)
@@ -223,13 +244,50 @@ void assert_dbl_far(double exp, double real, double tol, const char* caller, int
 #define ASSERT_DBL_FAR(exp, real) assert_dbl_far(exp, real, 1e-4, __FILE__, __LINE__)
 #define ASSERT_DBL_FAR_TOL(exp, real, tol) assert_dbl_far(exp, real, tol, __FILE__, __LINE__)
 
+/* Time limits are in milliseconds of process CPU time (so tests sharing cores with other workers
+ * don't fail them), multiplied by the time scale: the CTEST_TIME_SCALE environment variable if
+ * set, else CTEST_VALGRIND_TIME_SCALE when running under valgrind, else 1 */
+#define CTEST_VALGRIND_TIME_SCALE 50
+
+uint64_t ctest_clock_ns(void);
+uint64_t ctest_cpu_clock_ns(void);
+void assert_faster_than(double limit_ms, uint64_t elapsed_ns, const char* caller, int line);
+#define ASSERT_FASTER_THAN(limit_ms, ...) do { \
+        uint64_t ctest_start_ns = ctest_cpu_clock_ns(); \
+        __VA_ARGS__; \
+        assert_faster_than(limit_ms, ctest_cpu_clock_ns() - ctest_start_ns, __FILE__, __LINE__); \
+    } while (0)
+
+/* Allocations are counted by wrapping the allocator at link time, so the test binary has to be
+ * linked with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc (define CTEST_NO_ALLOC_COUNT to
+ * leave the wrappers out) */
+uintmax_t ctest_alloc_count(void);
+void assert_allocs_at_most(uintmax_t limit, uintmax_t count, const char* caller, int line);
+#define ASSERT_ALLOCS_AT_MOST(limit, ...) do { \
+        uintmax_t ctest_allocs_before = ctest_alloc_count(); \
+        __VA_ARGS__; \
+        assert_allocs_at_most(limit, ctest_alloc_count() - ctest_allocs_before, __FILE__, __LINE__); \
+    } while (0)
+
+/* Leak checks: once registered, a live count (e.g. of allocated queue nodes) has to end every
+ * passing test where it started, or the test fails */
+#define CTEST_MAX_LEAK_TRACKERS 8
+
+void ctest_track_leaks(const char* name, intmax_t (*live)(void));
+
 #ifdef CTEST_MAIN
 
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <setjmp.h>
+#include <signal.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
 #include <sys/time.h>
+#include <sys/wait.h>
+#include <time.h>
 #include <unistd.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -242,6 +300,27 @@ static char ctest_errorbuffer[MSG_SIZE];
 static jmp_buf ctest_err;
 static int color_output = 1;
 static const char* suite_name;
+static double ctest_time_scale = 1.0;
+
+static struct {
+    int active;            // inside ctest_bench_run()
+    int timed;             // the iteration ran an ASSERT_FASTER_THAN() region
+    uint64_t timed_ns;     // ... which took this long
+    double limit_ms;       // tightest ASSERT_FASTER_THAN() limit (0 for none)
+    const char* caller;
+    int line;
+} ctest_bench;
+static uint64_t ctest_bench_samples[CTEST_BENCH_MAX_ITERATIONS];
+
+static uintmax_t ctest_allocs;
+static int ctest_allocs_counted;
+
+static struct {
+    const char* name;
+    intmax_t (*live)(void);
+    intmax_t before;
+} ctest_leak_trackers[CTEST_MAX_LEAK_TRACKERS];
+static int ctest_leak_tracker_count;
 
 typedef int (*ctest_filter_func)(struct ctest*);
 
@@ -445,6 +524,160 @@ void assert_fail(const char* caller, int line) {
     CTEST_ERR("%s:%d  shouldn't come here", caller, line);
 }
 
+uint64_t ctest_clock_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000 + (uint64_t) now.tv_nsec;
+}
+
+uint64_t ctest_cpu_clock_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    return (uint64_t) now.tv_sec * 1000000000 + (uint64_t) now.tv_nsec;
+}
+
+void assert_faster_than(double limit_ms, uint64_t elapsed_ns, const char* caller, int line) {
+    if (ctest_bench.active) {
+        // benchmarks check the median once every iteration ran
+        ctest_bench.timed = 1;
+        ctest_bench.timed_ns = elapsed_ns;
+        if (ctest_bench.limit_ms == 0 || limit_ms < ctest_bench.limit_ms) {
+            ctest_bench.limit_ms = limit_ms;
+            ctest_bench.caller = caller;
+            ctest_bench.line = line;
+        }
+        return;
+    }
+    if (elapsed_ns > limit_ms * ctest_time_scale * 1e6) {
+        CTEST_ERR("%s:%d  took %.3f ms of CPU time, limit %.3f ms", caller, line, elapsed_ns / 1e6, limit_ms * ctest_time_scale);
+    }
+}
+
+static void ctest_bench_call(union ctest_run_func_union run, void* data) {
+    if (data)
+        run.unary(data);
+    else
+        run.nullary();
+}
+
+static void ctest_bench_loop(union ctest_run_func_union run, void* data, int iterations) {
+    int i;
+    uint64_t total = 0;
+    if (iterations < 1) iterations = 1;
+    if (iterations > CTEST_BENCH_MAX_ITERATIONS) iterations = CTEST_BENCH_MAX_ITERATIONS;
+
+    ctest_bench.active = 1;
+    ctest_bench.limit_ms = 0;
+    ctest_bench_call(run, data);
+    for (i = 0; i < iterations; i++) {
+        ctest_bench.timed = 0;
+        uint64_t start = ctest_cpu_clock_ns();
+        ctest_bench_call(run, data);
+        uint64_t elapsed = ctest_cpu_clock_ns() - start;
+        ctest_bench_samples[i] = ctest_bench.timed ? ctest_bench.timed_ns : elapsed;
+    }
+    ctest_bench.active = 0;
+
+    // insertion sort, there are only a few samples
+    for (i = 1; i < iterations; i++) {
+        uint64_t sample = ctest_bench_samples[i];
+        int j = i;
+        for (; j > 0 && ctest_bench_samples[j-1] > sample; j--) {
+            ctest_bench_samples[j] = ctest_bench_samples[j-1];
+        }
+        ctest_bench_samples[j] = sample;
+    }
+    for (i = 0; i < iterations; i++) total += ctest_bench_samples[i];
+    double median = (ctest_bench_samples[(iterations-1)/2] + ctest_bench_samples[iterations/2]) / 2e6;
+
+    msg_start(ANSI_CYAN, "BENCH");
+    print_errormsg("%d iterations of CPU time, min %.3f ms, median %.3f ms, mean %.3f ms, max %.3f ms", iterations,
+                   ctest_bench_samples[0] / 1e6, median, total / (iterations * 1e6), ctest_bench_samples[iterations-1] / 1e6);
+    msg_end();
+
+    if (ctest_bench.limit_ms != 0 && median > ctest_bench.limit_ms * ctest_time_scale) {
+        CTEST_ERR("%s:%d  median %.3f ms, limit %.3f ms", ctest_bench.caller, ctest_bench.line, median, ctest_bench.limit_ms * ctest_time_scale);
+    }
+}
+
+void ctest_bench_run(ctest_nullary_run_func run, int iterations) {
+    union ctest_run_func_union func;
+    func.nullary = run;
+    ctest_bench_loop(func, NULL, iterations);
+}
+
+void ctest_bench_run2(ctest_unary_run_func run, void* data, int iterations) {
+    union ctest_run_func_union func;
+    func.unary = run;
+    ctest_bench_loop(func, data, iterations);
+}
+
+#ifndef CTEST_NO_ALLOC_COUNT
+// resolved to the real allocator by -Wl,--wrap (weak, so binaries linked without it still link)
+void* __real_malloc(size_t size) __attribute__((weak));
+void* __real_calloc(size_t count, size_t size) __attribute__((weak));
+void* __real_realloc(void* pointer, size_t size) __attribute__((weak));
+
+void* __wrap_malloc(size_t size);
+void* __wrap_calloc(size_t count, size_t size);
+void* __wrap_realloc(void* pointer, size_t size);
+
+void* __wrap_malloc(size_t size) {
+    __atomic_add_fetch(&ctest_allocs, 1, __ATOMIC_RELAXED);
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    __atomic_add_fetch(&ctest_allocs, 1, __ATOMIC_RELAXED);
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* pointer, size_t size) {
+    __atomic_add_fetch(&ctest_allocs, 1, __ATOMIC_RELAXED);
+    return __real_realloc(pointer, size);
+}
+#endif
+
+uintmax_t ctest_alloc_count(void) {
+    return __atomic_load_n(&ctest_allocs, __ATOMIC_RELAXED);
+}
+
+void ctest_track_leaks(const char* name, intmax_t (*live)(void)) {
+    if (ctest_leak_tracker_count < CTEST_MAX_LEAK_TRACKERS) {
+        ctest_leak_trackers[ctest_leak_tracker_count].name = name;
+        ctest_leak_trackers[ctest_leak_tracker_count].live = live;
+        ctest_leak_tracker_count++;
+    }
+}
+
+static void leaks_start(void) {
+    int i;
+    for (i = 0; i < ctest_leak_tracker_count; i++) {
+        ctest_leak_trackers[i].before = ctest_leak_trackers[i].live();
+    }
+}
+
+static void leaks_check(void) {
+    int i;
+    for (i = 0; i < ctest_leak_tracker_count; i++) {
+        intmax_t leaked = ctest_leak_trackers[i].live() - ctest_leak_trackers[i].before;
+        if (leaked > 0) {
+            CTEST_ERR("leaked %" PRIdMAX " %s", leaked, ctest_leak_trackers[i].name);
+        } else if (leaked < 0) {
+            CTEST_ERR("released %" PRIdMAX " %s allocated before the test", -leaked, ctest_leak_trackers[i].name);
+        }
+    }
+}
+
+void assert_allocs_at_most(uintmax_t limit, uintmax_t count, const char* caller, int line) {
+    if (!ctest_allocs_counted) {
+        CTEST_ERR("%s:%d  allocations aren't counted (link with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc)", caller, line);
+    }
+    if (count > limit) {
+        CTEST_ERR("%s:%d  expected at most %" PRIuMAX " allocations, got %" PRIuMAX, caller, line, limit, count);
+    }
+}
+
 
 static int suite_all(struct ctest* t) {
     (void) t; // fix unused parameter warning
@@ -471,8 +704,32 @@ static void color_print(const char* color, const char* text) {
         printf("%s\n", text);
 }
 
+static void result_print(const char* color, const char* text, uint64_t elapsed_ns) {
+    char result[64];
+    snprintf(result, sizeof(result), "%s (%.3f ms)", text, elapsed_ns / 1e6);
+    if (color) color_print(color, result);
+    else printf("%s\n", result);
+}
+
+static void time_scale_init(void) {
+    const char* scale = getenv("CTEST_TIME_SCALE");
+    const char* preload = getenv("LD_PRELOAD");
+    if (scale != NULL && atof(scale) > 0) {
+        ctest_time_scale = atof(scale);
+    } else if (preload != NULL && strstr(preload, "vgpreload") != NULL) {
+        ctest_time_scale = CTEST_VALGRIND_TIME_SCALE;
+    }
+}
+
+static void alloc_count_init(void) {
+    // the probe only moves the counter if the wrappers are linked in
+    uintmax_t before = ctest_alloc_count();
+    void* volatile probe = malloc(1);
+    free(probe);
+    ctest_allocs_counted = ctest_alloc_count() != before;
+}
+
 #ifdef CTEST_SEGFAULT
-#include <signal.h>
 static void sighandler(int signum)
 {
     const char msg_color[] = ANSI_BRED "[SIGSEGV: Segmentation fault]" ANSI_NORMAL "\n";
@@ -488,30 +745,281 @@ static void sighandler(int signum)
 }
 #endif
 
+enum { CTEST_RESULT_OK, CTEST_RESULT_FAIL, CTEST_RESULT_SKIP };
+
+static int run_test(struct ctest* test, int idx, int total) {
+    ctest_errorbuffer[0] = 0;
+    ctest_errorsize = MSG_SIZE-1;
+    ctest_errormsg = ctest_errorbuffer;
+    printf("TEST %d/%d %s:%s ", idx, total, test->ssname, test->ttname);
+    fflush(stdout);
+    if (test->skip) {
+        color_print(ANSI_BYELLOW, "[SKIPPED]");
+        return CTEST_RESULT_SKIP;
+    }
+    int status;
+    // volatile: read after a failed assertion longjmp()s back
+    volatile int torn_down = 0;
+    ctest_bench.active = 0;
+    uint64_t start = ctest_clock_ns();
+    int result = setjmp(ctest_err);
+    if (result == 0) {
+        leaks_start();
+        if (test->setup && *test->setup) (*test->setup)(test->data);
+        if (test->data)
+            test->run.unary(test->data);
+        else
+            test->run.nullary();
+        torn_down = 1;
+        if (test->teardown && *test->teardown) (*test->teardown)(test->data);
+        leaks_check();
+        // if we got here it's ok
+#ifdef CTEST_COLOR_OK
+        result_print(ANSI_BGREEN, "[OK]", ctest_clock_ns() - start);
+#else
+        result_print(NULL, "[OK]", ctest_clock_ns() - start);
+#endif
+        status = CTEST_RESULT_OK;
+    } else {
+        result_print(ANSI_BRED, "[FAIL]", ctest_clock_ns() - start);
+        status = CTEST_RESULT_FAIL;
+        // the teardown still restores whatever the setup changed (once: it may be what failed)
+        if (!torn_down && test->teardown && *test->teardown) {
+            torn_down = 1;
+            if (setjmp(ctest_err) == 0) (*test->teardown)(test->data);
+        }
+    }
+    if (ctest_errorsize != MSG_SIZE-1) printf("%s", ctest_errorbuffer);
+    return status;
+}
+
+/* A test running in a forked worker. Its stdout and stderr are collected from a pipe and printed
+ * whole, in test order, once it exits. */
+struct ctest_job {
+    struct ctest* test;
+    int idx;
+    pid_t pid;
+    int fd;             // read end of the output pipe (-1 when not running)
+    uint64_t start;
+    char* output;
+    size_t size;
+    size_t capacity;
+    int done;
+    int result;
+};
+
+static void job_append(struct ctest_job* job, const char* data, size_t size) {
+    if (job->size + size > job->capacity) {
+        size_t capacity = job->capacity ? job->capacity : 4096;
+        while (capacity < job->size + size) capacity *= 2;
+        char* output = (char*) realloc(job->output, capacity);
+        if (output == NULL) return;     // lose the output, not the result
+        job->output = output;
+        job->capacity = capacity;
+    }
+    memcpy(job->output + job->size, data, size);
+    job->size += size;
+}
+
+static void job_note(struct ctest_job* job, const char* color, const char* text) {
+    char note[128];
+    if (color_output)
+        snprintf(note, sizeof(note), "%s%s" ANSI_NORMAL "\n", color, text);
+    else
+        snprintf(note, sizeof(note), "%s\n", text);
+    job_append(job, note, strlen(note));
+}
+
+static void job_start(struct ctest_job* job, int total) {
+    int fds[2];
+    job->start = ctest_clock_ns();
+    fflush(stdout);
+    fflush(stderr);
+    if (pipe(fds) != 0) {
+        job->done = 1;
+        job->result = CTEST_RESULT_FAIL;
+        job_note(job, ANSI_BRED, "[FAIL] (no pipe for the worker)");
+        return;
+    }
+    job->pid = fork();
+    if (job->pid == 0) {
+        close(fds[0]);
+        dup2(fds[1], STDOUT_FILENO);
+        dup2(fds[1], STDERR_FILENO);
+        close(fds[1]);
+        exit(run_test(job->test, job->idx, total));
+    }
+    close(fds[1]);
+    if (job->pid < 0) {
+        close(fds[0]);
+        job->done = 1;
+        job->result = CTEST_RESULT_FAIL;
+        job_note(job, ANSI_BRED, "[FAIL] (couldn't fork a worker)");
+        return;
+    }
+    job->fd = fds[0];
+}
+
+static void job_settle(struct ctest_job* job, int status, int timed_out) {
+    char note[80];
+    close(job->fd);
+    job->fd = -1;
+    job->done = 1;
+    job->result = CTEST_RESULT_FAIL;
+    if (timed_out) {
+        snprintf(note, sizeof(note), "[TIMEOUT] (%.3f ms)", (ctest_clock_ns() - job->start) / 1e6);
+        job_note(job, ANSI_BRED, note);
+    } else if (WIFEXITED(status) && WEXITSTATUS(status) <= CTEST_RESULT_SKIP) {
+        job->result = WEXITSTATUS(status);
+    } else {
+        // the worker already printed what it got to
+        if (WIFSIGNALED(status))
+            snprintf(note, sizeof(note), "[FAIL] (worker killed by signal %d)", WTERMSIG(status));
+        else
+            snprintf(note, sizeof(note), "[FAIL] (worker exited with %d)", WEXITSTATUS(status));
+        job_note(job, ANSI_BRED, note);
+    }
+}
+
+static void job_finish(struct ctest_job* job, int timed_out) {
+    int status = 0;
+    if (timed_out) kill(job->pid, SIGKILL);
+    while (waitpid(job->pid, &status, 0) < 0 && errno == EINTR) { }
+    job_settle(job, status, timed_out);
+}
+
+/* finish a worker that already exited, keeping what's left in its pipe; 0 if it's still running */
+static int job_reap(struct ctest_job* job) {
+    char buffer[4096];
+    ssize_t size;
+    int status = 0;
+    if (waitpid(job->pid, &status, WNOHANG) != job->pid) return 0;
+    // don't block on a pipe something the worker forked still holds
+    fcntl(job->fd, F_SETFL, fcntl(job->fd, F_GETFL) | O_NONBLOCK);
+    while ((size = read(job->fd, buffer, sizeof(buffer))) > 0 || (size < 0 && errno == EINTR)) {
+        if (size > 0) job_append(job, buffer, (size_t) size);
+    }
+    job_settle(job, status, 0);
+    return 1;
+}
+
+static void run_parallel(struct ctest_job* jobs, int total, int workers, double timeout, int* num) {
+    struct pollfd* fds = (struct pollfd*) calloc(workers, sizeof(struct pollfd));
+    int* owner = (int*) calloc(workers, sizeof(int));
+    uint64_t limit = (uint64_t) (timeout * ctest_time_scale * 1e9);
+    int next = 0;
+    int printed = 0;
+    int running = 0;
+    int i;
+
+    if (fds == NULL || owner == NULL) workers = 0;
+    while (printed < total) {
+        while (running < workers && next < total) {
+            job_start(&jobs[next], total);
+            if (!jobs[next].done) running++;
+            next++;
+        }
+        if (workers == 0) {
+            // nothing to poll with, run what's left here
+            for (; next < total; next++) {
+                jobs[next].done = 1;
+                fflush(stdout);
+                jobs[next].result = run_test(jobs[next].test, jobs[next].idx, total);
+                num[jobs[next].result]++;
+            }
+            printed = total;
+            break;
+        }
+
+        // wait for output, an exit or the first deadline
+        int count = 0;
+        int wait_ms = 0;
+        uint64_t now = ctest_clock_ns();
+        for (i = 0; i < next; i++) {
+            if (jobs[i].fd < 0) continue;
+            uint64_t deadline = jobs[i].start + limit;
+            int left = deadline > now ? (int) ((deadline - now) / 1000000 + 1) : 0;
+            if (count == 0 || left < wait_ms) wait_ms = left;
+            fds[count].fd = jobs[i].fd;
+            fds[count].events = POLLIN;
+            fds[count].revents = 0;
+            owner[count++] = i;
+        }
+        if (count > 0 && poll(fds, count, wait_ms) < 0 && errno != EINTR) break;
+
+        now = ctest_clock_ns();
+        for (i = 0; i < count; i++) {
+            struct ctest_job* job = &jobs[owner[i]];
+            if (fds[i].revents) {
+                char buffer[4096];
+                ssize_t size = read(job->fd, buffer, sizeof(buffer));
+                if (size > 0) {
+                    job_append(job, buffer, (size_t) size);
+                } else if (size == 0 || errno != EINTR) {
+                    job_finish(job, 0);
+                    running--;
+                    continue;
+                }
+            }
+            if (now - job->start >= limit) {
+                // past the deadline it may only be exiting
+                if (!job_reap(job)) job_finish(job, 1);
+                running--;
+            }
+        }
+
+        // print finished tests in order
+        for (; printed < next && jobs[printed].done; printed++) {
+            fwrite(jobs[printed].output, 1, jobs[printed].size, stdout);
+            fflush(stdout);
+            num[jobs[printed].result]++;
+        }
+    }
+
+    free(fds);
+    free(owner);
+}
+
+/* ctest_main() takes [-j N] [-t SECONDS] [SUITE]. With -j the tests run in N forked workers (0 for
+ * one per online CPU), so a crash or hang only fails its own test; each test is killed after
+ * SECONDS (default CTEST_TIMEOUT) times the time scale. Without -j they run here, one by one, and
+ * -t has no effect. */
+#define CTEST_TIMEOUT 60
+
 int ctest_main(int argc, const char *argv[]);
 
 __attribute__((no_sanitize_address)) int ctest_main(int argc, const char *argv[])
 {
     static int total = 0;
-    static int num_ok = 0;
-    static int num_fail = 0;
-    static int num_skip = 0;
+    static int num[3];
     static int idx = 1;
+    static int workers = 1;
+    static double timeout = CTEST_TIMEOUT;
     static ctest_filter_func filter = suite_all;
+    int i;
 
 #ifdef CTEST_SEGFAULT
     signal(SIGSEGV, sighandler);
 #endif
 
-    if (argc == 2) {
-        suite_name = argv[1];
-        filter = suite_filter;
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            workers = atoi(argv[++i]);
+            if (workers <= 0) workers = (int) sysconf(_SC_NPROCESSORS_ONLN);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            timeout = atof(argv[++i]);
+        } else {
+            suite_name = argv[i];
+            filter = suite_filter;
+        }
     }
 #ifdef CTEST_NO_COLORS
     color_output = 0;
 #else
     color_output = isatty(1);
 #endif
+    time_scale_init();
+    alloc_count_init();
     uint64_t t1 = getCurrentTime();
 
     struct ctest* ctest_begin = &CTEST_IMPL_TNAME(suite, test);
@@ -535,49 +1043,37 @@ __attribute__((no_sanitize_address)) int ctest_main(int argc, const char *argv[]
         if (filter(test)) total++;
     }
 
+    struct ctest_job* jobs = NULL;
+    if (workers > 1 && total > 1) {
+        jobs = (struct ctest_job*) calloc(total, sizeof(struct ctest_job));
+    }
+
     for (test = ctest_begin; test != ctest_end; test++) {
         if (test == &CTEST_IMPL_TNAME(suite, test)) continue;
         if (filter(test)) {
-            ctest_errorbuffer[0] = 0;
-            ctest_errorsize = MSG_SIZE-1;
-            ctest_errormsg = ctest_errorbuffer;
-            printf("TEST %d/%d %s:%s ", idx, total, test->ssname, test->ttname);
-            fflush(stdout);
-            if (test->skip) {
-                color_print(ANSI_BYELLOW, "[SKIPPED]");
-                num_skip++;
+            if (jobs) {
+                jobs[idx-1].test = test;
+                jobs[idx-1].idx = idx;
+                jobs[idx-1].fd = -1;
             } else {
-                int result = setjmp(ctest_err);
-                if (result == 0) {
-                    if (test->setup && *test->setup) (*test->setup)(test->data);
-                    if (test->data)
-                        test->run.unary(test->data);
-                    else
-                        test->run.nullary();
-                    if (test->teardown && *test->teardown) (*test->teardown)(test->data);
-                    // if we got here it's ok
-#ifdef CTEST_COLOR_OK
-                    color_print(ANSI_BGREEN, "[OK]");
-#else
-                    printf("[OK]\n");
-#endif
-                    num_ok++;
-                } else {
-                    color_print(ANSI_BRED, "[FAIL]");
-                    num_fail++;
-                }
-                if (ctest_errorsize != MSG_SIZE-1) printf("%s", ctest_errorbuffer);
+                num[run_test(test, idx, total)]++;
             }
             idx++;
         }
     }
+
+    if (jobs) {
+        run_parallel(jobs, total, workers < total ? workers : total, timeout, num);
+        for (i = 0; i < total; i++) free(jobs[i].output);
+        free(jobs);
+    }
     uint64_t t2 = getCurrentTime();
 
-    const char* color = (num_fail) ? ANSI_BRED : ANSI_GREEN;
+    const char* color = (num[CTEST_RESULT_FAIL]) ? ANSI_BRED : ANSI_GREEN;
     char results[80];
-    snprintf(results, sizeof(results), "RESULTS: %d tests (%d ok, %d failed, %d skipped) ran in %" PRIu64 " ms", total, num_ok, num_fail, num_skip, (t2 - t1)/1000);
+    snprintf(results, sizeof(results), "RESULTS: %d tests (%d ok, %d failed, %d skipped) ran in %" PRIu64 " ms", total, num[CTEST_RESULT_OK], num[CTEST_RESULT_FAIL], num[CTEST_RESULT_SKIP], (t2 - t1)/1000);
     color_print(color, results);
-    return num_fail;
+    return num[CTEST_RESULT_FAIL];
 }
 
 #endif
@@ -0,0 +1,418 @@
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include "generator.h"
+
+
+static unsigned long long nextRandom(struct generator_t* generator);
+static double nextUniform(struct generator_t* generator);
+static double nextExponential(struct generator_t* generator, double mean);
+static int nextExecutionTime(struct generator_t* generator);
+static int nextPriority(struct generator_t* generator);
+static int nextArrival(struct generator_t* generator);
+static int clampTime(double time, int min, int max);
+
+
+///-------------------------------------------------
+/// @brief  Fills a configuration with the defaults
+///
+/// @param[in] config The configuration to fill
+/// @param[in] seed Random number generator seed
+///
+/// @return None
+///-------------------------------------------------
+void generator_default_config(struct generator_config_t* config, unsigned long long seed)
+{
+    config->seed = seed;
+    config->execution = GENERATOR_UNIFORM;
+    config->execution_min = 1;
+    config->execution_max = 100;
+    config->execution_mean = 10.0;
+    config->bimodal_long_mean = 100.0;
+    config->bimodal_long_fraction = 0.1;
+    config->pareto_alpha = 1.5;
+    config->priority_levels = 10;
+    config->zipf_exponent = 1.0;
+    config->arrival_rate = 0.0;
+}
+
+
+///-------------------------------------------------
+/// @brief  Creates a workload generator
+///
+/// @param[in] config The workload to generate
+///
+/// @return The generator, NULL on failure
+///-------------------------------------------------
+struct generator_t* create_generator(const struct generator_config_t* config)
+{
+    // Validate parameters
+    if((config == NULL) || (config->execution_min > config->execution_max))
+    {
+        return NULL;
+    }
+
+    struct generator_t* generator = (struct generator_t*)malloc(sizeof(struct generator_t));
+
+    if(generator == NULL)
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't create generator!\n", __func__);
+        return NULL;
+    }
+
+    generator->config = *config;
+    generator->clock = 0.0;
+
+    if(generator->config.priority_levels < 1)
+    {
+        generator->config.priority_levels = 1;
+    }
+
+    // Expand the seed into the xoshiro256** state with
+    // splitmix64 (never all zero)
+    unsigned long long seed = config->seed;
+
+    for(int i = 0; i < 4; i++)
+    {
+        seed += 0x9E3779B97F4A7C15ULL;
+
+        unsigned long long mixed = seed;
+        mixed = (mixed ^ (mixed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        mixed = (mixed ^ (mixed >> 27)) * 0x94D049BB133111EBULL;
+        generator->state[i] = mixed ^ (mixed >> 31);
+    }
+
+    // Tabulate the Zipf distribution once, so each
+    // priority is a binary search
+    int levels = generator->config.priority_levels;
+    generator->zipf = (double*)malloc(levels * sizeof(double));
+
+    if(generator->zipf == NULL)
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't create generator!\n", __func__);
+        free(generator);
+        return NULL;
+    }
+
+    double total = 0.0;
+
+    for(int k = 0; k < levels; k++)
+    {
+        total += pow(k + 1, -config->zipf_exponent);
+        generator->zipf[k] = total;
+    }
+
+    for(int k = 0; k < levels; k++)
+    {
+        generator->zipf[k] /= total;
+    }
+
+    return generator;
+}
+
+
+///-------------------------------------------------
+/// @brief  Generates the next task
+///
+/// @param[in] generator The generator
+/// @param[out] value Execution, priority, arrival
+///
+/// @return None
+///-------------------------------------------------
+void generator_next(struct generator_t* generator, int* value)
+{
+    // Always draw the fields in the same order, so a
+    // seed gives the same tasks through every output
+    value[0] = nextExecutionTime(generator);
+    value[1] = nextPriority(generator);
+    value[2] = nextArrival(generator);
+}
+
+
+///-------------------------------------------------
+/// @brief  Generates tasks into a task array
+///
+/// @param[in] generator The generator
+/// @param[in] task The task array to fill
+/// @param[in] size Number of tasks
+///
+/// @return None
+///-------------------------------------------------
+void generate_tasks(struct generator_t* generator, struct task_t* task, int size)
+{
+    int value[3];
+
+    for(int i = 0; i < size; i++)
+    {
+        generator_next(generator, value);
+
+        task[i].process_id = i;
+        task[i].execution_time = value[0];
+        task[i].waiting_time = 0;
+        task[i].turnaround_time = 0;
+        task[i].priority = value[1];
+        task[i].left_to_execute = value[0];
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Generates a workload
+///
+/// @param[in] generator The generator
+/// @param[in] size Number of tasks
+///
+/// @return The workload, NULL on failure
+///-------------------------------------------------
+struct workload_t* generate_workload(struct generator_t* generator, int size)
+{
+    struct workload_t* workload = create_workload(size);
+
+    if(workload == NULL)
+    {
+        return NULL;
+    }
+
+    int value[3];
+
+    for(int i = 0; i < size; i++)
+    {
+        generator_next(generator, value);
+
+        workload->execution[i] = value[0];
+        workload->priority[i] = value[1];
+        workload->arrival[i] = value[2];
+    }
+
+    return workload;
+}
+
+
+///-------------------------------------------------
+/// @brief  Generates tasks as CSV lines
+///
+/// @param[in] generator The generator
+/// @param[in] count Number of tasks
+/// @param[in] out Stream to write to
+///
+/// @return 0 on success, -1 on failure
+///-------------------------------------------------
+int generate_csv(struct generator_t* generator, long long count, FILE* out)
+{
+    int value[3];
+
+    fprintf(out, "execution,priority,arrival\n");
+
+    for(long long i = 0; i < count; i++)
+    {
+        generator_next(generator, value);
+
+        if(fprintf(out, "%d,%d,%d\n", value[0], value[1], value[2]) < 0)
+        {
+            return -1;
+        }
+    }
+
+    return ferror(out) ? -1 : 0;
+}
+
+
+///-------------------------------------------------
+/// @brief  Frees a workload generator
+///
+/// @param[in] generator The generator
+///
+/// @return None
+///-------------------------------------------------
+void destroy_generator(struct generator_t* generator)
+{
+    if(generator == NULL)
+    {
+        return;
+    }
+
+    free(generator->zipf);
+    free(generator);
+}
+
+
+///-------------------------------------------------
+/// @brief  Draws 64 random bits (xoshiro256**)
+///
+/// @param[in] generator The generator
+///
+/// @return The random bits
+///-------------------------------------------------
+static unsigned long long nextRandom(struct generator_t* generator)
+{
+    unsigned long long* state = generator->state;
+    unsigned long long scrambled = state[1] * 5;
+    unsigned long long result = ((scrambled << 7) | (scrambled >> 57)) * 9;
+    unsigned long long shifted = state[1] << 17;
+
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= shifted;
+    state[3] = (state[3] << 45) | (state[3] >> 19);
+
+    return result;
+}
+
+
+///-------------------------------------------------
+/// @brief  Draws a uniform double in [0, 1)
+///
+/// @param[in] generator The generator
+///
+/// @return The random number
+///-------------------------------------------------
+static double nextUniform(struct generator_t* generator)
+{
+    return (nextRandom(generator) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+
+///-------------------------------------------------
+/// @brief  Draws from an exponential distribution
+///
+/// @param[in] generator The generator
+/// @param[in] mean Mean of the distribution
+///
+/// @return The random number
+///-------------------------------------------------
+static double nextExponential(struct generator_t* generator, double mean)
+{
+    // 1 - u is in (0, 1], so the log is finite
+    return -mean * log(1.0 - nextUniform(generator));
+}
+
+
+///-------------------------------------------------
+/// @brief  Draws an execution time from the
+///         configured distribution
+///
+/// @param[in] generator The generator
+///
+/// @return The execution time
+///-------------------------------------------------
+static int nextExecutionTime(struct generator_t* generator)
+{
+    const struct generator_config_t* config = &(generator->config);
+    double time;
+
+    switch(config->execution)
+    {
+        case GENERATOR_EXPONENTIAL:
+            time = nextExponential(generator, config->execution_mean);
+            break;
+
+        case GENERATOR_BIMODAL:
+            time = (nextUniform(generator) < config->bimodal_long_fraction) ?
+                   nextExponential(generator, config->bimodal_long_mean) :
+                   nextExponential(generator, config->execution_mean);
+            break;
+
+        case GENERATOR_PARETO:
+        {
+            // Scale x_m = mean * (alpha - 1) / alpha gives
+            // the configured mean
+            double alpha = config->pareto_alpha;
+            double scale = (alpha > 1.0) ? (config->execution_mean * (alpha - 1.0) / alpha) : config->execution_min;
+
+            time = scale * pow(1.0 - nextUniform(generator), -1.0 / alpha);
+            break;
+        }
+
+        case GENERATOR_UNIFORM:
+        default:
+            time = config->execution_min + floor(nextUniform(generator) * ((double)config->execution_max - config->execution_min + 1.0));
+            break;
+    }
+
+    return clampTime(time, config->execution_min, config->execution_max);
+}
+
+
+///-------------------------------------------------
+/// @brief  Draws a Zipf distributed priority
+///
+/// @param[in] generator The generator
+///
+/// @return The priority, in [1, priority_levels]
+///-------------------------------------------------
+static int nextPriority(struct generator_t* generator)
+{
+    double draw = nextUniform(generator);
+    int low = 0;
+    int high = generator->config.priority_levels - 1;
+
+    // First level whose cumulative weight exceeds the
+    // draw
+    while(low < high)
+    {
+        int middle = low + (high - low) / 2;
+
+        if(generator->zipf[middle] > draw)
+        {
+            high = middle;
+        }
+        else
+        {
+            low = middle + 1;
+        }
+    }
+
+    return low + 1;
+}
+
+
+///-------------------------------------------------
+/// @brief  Advances the Poisson arrival process
+///
+/// @param[in] generator The generator
+///
+/// @return Arrival time of the next task
+///-------------------------------------------------
+static int nextArrival(struct generator_t* generator)
+{
+    double rate = generator->config.arrival_rate;
+
+    if(rate <= 0.0)
+    {
+        return 0;
+    }
+
+    // Exponential gaps between arrivals
+    generator->clock += nextExponential(generator, 1.0 / rate);
+
+    return clampTime(floor(generator->clock), 0, INT_MAX);
+}
+
+
+///-------------------------------------------------
+/// @brief  Rounds a time and clamps it to a range
+///
+/// @param[in] time The time
+/// @param[in] min Smallest allowed time
+/// @param[in] max Largest allowed time
+///
+/// @return The clamped time
+///-------------------------------------------------
+static int clampTime(double time, int min, int max)
+{
+    // Compare as doubles: the time may be far outside
+    // what an int holds
+    if(!(time >= min))
+    {
+        return min;
+    }
+
+    if(time >= max)
+    {
+        return max;
+    }
+
+    return (int)(time + 0.5);
+}
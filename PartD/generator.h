@@ -0,0 +1,137 @@
+#include <stdio.h>
+#include "priority.h"
+#include "workload.h"
+
+#ifndef __WORKLOAD_GENERATOR__
+#define __WORKLOAD_GENERATOR__
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Distributions the execution times can be drawn from
+//----------------------------------------------------------------------------------------------------------------------------------
+enum generator_distribution_t {
+
+    // Every time in [execution_min, execution_max] equally likely
+    GENERATOR_UNIFORM,
+
+    // Exponential with mean execution_mean
+    GENERATOR_EXPONENTIAL,
+
+    // Mostly short jobs (exponential, mean execution_mean) mixed with a bimodal_long_fraction of
+    // long ones (exponential, mean bimodal_long_mean)
+    GENERATOR_BIMODAL,
+
+    // Heavy tailed Pareto with shape pareto_alpha, scaled so the mean is execution_mean (for alpha > 1)
+    GENERATOR_PARETO
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which describes a synthetic workload. The same configuration always generates
+/// the same tasks.
+//----------------------------------------------------------------------------------------------------------------------------------
+struct generator_config_t {
+    // Seed of the random number generator
+    unsigned long long seed;
+
+    // Distribution of the execution times, and the range every time is clamped to
+    enum generator_distribution_t execution;
+    int execution_min;
+    int execution_max;
+
+    // Parameters of the execution time distributions
+    double execution_mean;
+    double bimodal_long_mean;
+    double bimodal_long_fraction;
+    double pareto_alpha;
+
+    // Priorities are Zipf distributed over [1, priority_levels]: priority k is drawn with weight
+    // 1 / k^zipf_exponent (0 makes every level equally likely)
+    int priority_levels;
+    double zipf_exponent;
+
+    // Arrivals are a Poisson process with this many tasks per time unit (0 for all at time 0)
+    double arrival_rate;
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds the state of a workload generator
+//----------------------------------------------------------------------------------------------------------------------------------
+struct generator_t {
+    // The configuration generated from
+    struct generator_config_t config;
+
+    // xoshiro256** state
+    unsigned long long state[4];
+
+    // Cumulative Zipf weights of the priority levels, normalized to end at 1
+    double* zipf;
+
+    // Arrival time of the last task (exact, before rounding down)
+    double clock;
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Fill a configuration with the defaults: uniform execution times in [1, 100], means of 10
+/// (short) and 100 (long, 10% of tasks), Pareto shape 1.5, Zipf priorities over 10 levels with
+/// exponent 1, and every task arriving at time 0
+///
+/// @param[in] config The configuration to fill
+/// @param[in] seed Seed of the random number generator
+//----------------------------------------------------------------------------------------------------------------------------------
+void generator_default_config(struct generator_config_t* config, unsigned long long seed);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Creates a workload generator
+///
+/// @param[in] config The workload to generate
+///
+/// @return the generator, NULL on failure
+//----------------------------------------------------------------------------------------------------------------------------------
+struct generator_t* create_generator(const struct generator_config_t* config);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Generate the next task
+///
+/// @param[in] generator The generator
+/// @param[out] value The execution time, priority and arrival time of the task
+//----------------------------------------------------------------------------------------------------------------------------------
+void generator_next(struct generator_t* generator, int* value);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Generate tasks straight into a task array (numbered from 0, arrival times are dropped)
+///
+/// @param[in] generator The generator
+/// @param[in] task The buffer to fill
+/// @param[in] size The number of tasks to generate
+//----------------------------------------------------------------------------------------------------------------------------------
+void generate_tasks(struct generator_t* generator, struct task_t* task, int size);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Generate a workload (for workload_write())
+///
+/// @param[in] generator The generator
+/// @param[in] size The number of tasks to generate
+///
+/// @return the workload, NULL on failure
+//----------------------------------------------------------------------------------------------------------------------------------
+struct workload_t* generate_workload(struct generator_t* generator, int size);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Generate tasks as CSV lines that workload_load() and the workload reader take, without
+/// holding them in memory
+///
+/// @param[in] generator The generator
+/// @param[in] count The number of tasks to generate
+/// @param[in] out Stream to write to
+///
+/// @return 0 on success, -1 on failure
+//----------------------------------------------------------------------------------------------------------------------------------
+int generate_csv(struct generator_t* generator, long long count, FILE* out);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Free a workload generator
+///
+/// @param[in] generator The generator
+//----------------------------------------------------------------------------------------------------------------------------------
+void destroy_generator(struct generator_t* generator);
+
+#endif // __WORKLOAD_GENERATOR__
@@ -1,18 +1,41 @@
 #include <limits.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "priority.h"
 #include "queue.h"
+#include "aging.h"
+#include "trace.h"
+#include "record.h"
+#include "stats.h"
+#include "context.h"
 
 
 #define STATIC_QUANTUM 1
 
 static inline int min(int x, int y){ return ((x < y) ? x : y); }
 
+static void defaultContext(struct priority_context_t* context, enum priority_engine_t engine);
+static void scheduleWithList(struct priority_context_t* context, struct task_t* task, int size, struct online_stats_t* online);
+static void scheduleWithHeap(struct priority_context_t* context, struct task_t* task, int size, struct online_stats_t* online);
+static void scheduleWithBuckets(struct priority_context_t* context, struct task_t* task, int size, struct online_stats_t* online);
+static void scheduleWithEvents(struct priority_context_t* context, struct task_t* task, int size, struct online_stats_t* online);
+static int nextEventSlice(struct priority_context_t* context, struct heap_queue_t* heap, struct aging_index_t* index, struct task_t* currentTask, int runTime);
+static int dispatchTask(struct priority_context_t* context, struct task_t* task, int slice, int* runTime, int* lastTaskRan, struct online_stats_t* online);
 static void swapNodes(struct node_t* nodeA, struct node_t* nodeB);
 static void swapTasks(struct task_t* taskA, struct task_t* taskB);
-static void updateTasksPriority(struct node_t** head, int runTime);
+static void ageTask(struct priority_context_t* context, struct task_t* task, int runTime);
+static int agedPriority(struct task_t* task, int runTime);
+static void updateTasksPriority(struct priority_context_t* context, struct node_t** head, int runTime);
+static void updateLinkedPriority(struct priority_context_t* context, struct task_list_t* list, int runTime);
+static int isLowerPriority(struct task_t* taskA, struct task_t* taskB);
+static void updateHeapPriority(struct priority_context_t* context, struct heap_queue_t* heap, struct aging_index_t* index, struct heap_entry_t* aged, struct task_t* currentTask, int runTime);
+static void updateBucketPriority(struct priority_context_t* context, struct bucket_queue_t* bucket, struct aging_index_t* index, struct heap_entry_t* aged, struct task_t* currentTask, int runTime);
+static int compareQueueOrder(const void* entryA, const void* entryB);
+static int compareLevelOrder(const void* entryA, const void* entryB);
 static void sortTasksByPriority(struct task_t* task, int size);
+static void mergeSortTasksByPriority(struct task_t* task, int size);
 static void sortQueueByPriority(struct node_t** head);
 
 
@@ -56,76 +79,748 @@ void init(struct task_t* task, int *execution, int* priority, int size)
 ///-------------------------------------------------
 void priority_schedule(struct task_t* task, int size)
 {
+    priority_schedule_engine(task, size, PRIORITY_ENGINE_LIST);
+}
+
+
+///-------------------------------------------------
+/// @brief  Priority scheduler algorithm running on
+///         a selectable ready queue engine
+///
+/// @param[in] task The task queue array
+/// @param[in] size Size of the task queue array
+/// @param[in] engine Ready queue implementation
+///
+/// @return None
+///-------------------------------------------------
+void priority_schedule_engine(struct task_t* task, int size, enum priority_engine_t engine)
+{
+    struct priority_context_t context;
+
+    defaultContext(&context, engine);
+    priority_context_run(&context, task, size);
+}
+
+
+///-------------------------------------------------
+/// @brief  Creates a scheduler context
+///
+/// @param[in] engine Ready queue implementation
+/// @param[in] quantum Length of a time slice
+/// @param[in] out Stream to trace to (NULL for
+///                no trace)
+///
+/// @return The context, NULL on failure
+///-------------------------------------------------
+struct priority_context_t* create_priority_context(enum priority_engine_t engine, int quantum, FILE* out)
+{
+    // Validate parameters
+    if(quantum < 1)
+    {
+        fprintf(stderr, "%s() ERROR: Quantum must be positive!\n", __func__);
+        return NULL;
+    }
+
+    struct priority_context_t* context = (struct priority_context_t*)malloc(sizeof(struct priority_context_t));
+    struct trace_buffer_t* trace = create_trace_buffer((out != NULL) ? TRACE_LEVEL_AGING : TRACE_LEVEL_OFF, out);
+
+    // Verify that malloc didn't fail
+    if((context == NULL) || (trace == NULL))
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't create scheduler context!\n", __func__);
+        destroy_trace_buffer(trace);
+        free(context);
+        return NULL;
+    }
+
+    context->engine = engine;
+    context->quantum = quantum;
+    context->trace = trace;
+    context->log = NULL;
+    context->owned_log = NULL;
+    context->run_time = 0;
+    memset(&(context->stats), 0, sizeof(context->stats));
+
+    return context;
+}
+
+
+///-------------------------------------------------
+/// @brief  Priority scheduler algorithm running
+///         with a scheduler context
+///
+/// @param[in] context The scheduler context
+/// @param[in] task The task queue array
+/// @param[in] size Size of the task queue array
+///
+/// @return None
+///-------------------------------------------------
+void priority_context_run(struct priority_context_t* context, struct task_t* task, int size)
+{
+    // Statistics collected as tasks complete
+    struct online_stats_t online;
+    online_stats_init(&online);
+
+    context->run_time = 0;
+
+    switch(context->engine)
+    {
+        case PRIORITY_ENGINE_HEAP:
+            scheduleWithHeap(context, task, size, &online);
+            break;
+
+        case PRIORITY_ENGINE_BITMAP:
+            scheduleWithBuckets(context, task, size, &online);
+            break;
+
+        case PRIORITY_ENGINE_EVENT:
+            scheduleWithEvents(context, task, size, &online);
+            break;
+
+        case PRIORITY_ENGINE_LIST:
+        default:
+            scheduleWithList(context, task, size, &online);
+            break;
+    }
+
+    // Calculate average times
+    online_stats_read(&online, &(context->stats));
+
+    // Print average times (there are none if no
+    // task ran)
+    if(context->stats.count > 0)
+    {
+        float avgWaitTime = (float)((double)context->stats.waitSum / size);
+        float avgTurnaroundTime = (float)((double)context->stats.turnaroundSum / size);
+
+        TRACE_TO(context->trace, TRACE_LEVEL_SUMMARY, "Average Wait Time: %f\n", avgWaitTime);
+        TRACE_TO(context->trace, TRACE_LEVEL_SUMMARY, "Average Turnaround Time: %f\n", avgTurnaroundTime);
+    }
+
+    // Write out the buffered trace
+    trace_buffer_flush(context->trace);
+}
+
+
+///-------------------------------------------------
+/// @brief  Creates a dispatch log owned by the
+///         context and records into it
+///
+/// @param[in] context The scheduler context
+/// @param[in] capacity Number of dispatches the
+///                     log holds
+///
+/// @return The log, NULL on failure
+///-------------------------------------------------
+struct dispatch_log_t* priority_context_record(struct priority_context_t* context, size_t capacity)
+{
+    struct dispatch_log_t* log = create_dispatch_log(capacity);
+
+    if(log == NULL)
+    {
+        return NULL;
+    }
+
+    destroy_dispatch_log(context->owned_log);
+
+    context->owned_log = log;
+    context->log = log;
+
+    return log;
+}
+
+
+///-------------------------------------------------
+/// @brief  Frees a scheduler context
+///
+/// @param[in] context The scheduler context
+///
+/// @return None
+///-------------------------------------------------
+void destroy_priority_context(struct priority_context_t* context)
+{
+    if(context == NULL)
+    {
+        return;
+    }
+
+    destroy_trace_buffer(context->trace);
+    destroy_dispatch_log(context->owned_log);
+    free(context);
+}
+
+
+///-------------------------------------------------
+/// @brief  Fills in a context that schedules like
+///         the context-free API: the process-wide
+///         trace and the active dispatch log
+///
+/// @param[out] context The context to fill in
+/// @param[in] engine Ready queue implementation
+///
+/// @return None
+///-------------------------------------------------
+static void defaultContext(struct priority_context_t* context, enum priority_engine_t engine)
+{
+    context->engine = engine;
+    context->quantum = STATIC_QUANTUM;
+    context->trace = &trace_default;
+    context->log = dispatch_log_active();
+    context->owned_log = NULL;
+    context->run_time = 0;
+}
+
+
+///-------------------------------------------------
+/// @brief  Round robin over a circular linked list
+///         which is re-sorted after every quantum
+///
+/// @param[in] context The scheduler context
+/// @param[in] task The task queue array
+/// @param[in] size Size of the task queue array
+/// @param[in] online Statistics updated as tasks
+///                   complete
+///
+/// @return None
+///-------------------------------------------------
+static void scheduleWithList(struct priority_context_t* context, struct task_t* task, int size, struct online_stats_t* online)
+{
+    int runTime = 0;
+    int taskRuntime = 0;
+    int lastTaskRan = INT_MAX;
+
+    // Nothing to schedule (an empty queue can't
+    // be created)
+    if(size < 1)
+    {
+        return;
+    }
+
+    // Sort task buffer prior to queue creation
+    sortTasksByPriority(task, size);
+
+    // Create queue based on the task array
+    // NOTE: Every task plus the re-pushed task fit
+    //       in a single slab
+    struct node_pool_t* pool = create_node_pool(size + 1);
+    struct node_t* queue = create_queue_from_pool(task, size, pool);
+
+    // Execute the round robin algorithm
+    while(!is_empty(&queue))
+    {
+        // "Execute" the first task
+        struct task_t* currentTask = peek(&queue);
+
+        taskRuntime = min(currentTask->left_to_execute, context->quantum);
+
+        // Run it for the slice; the priority at
+        // dispatch goes to the dispatch log
+        int priorityBefore = dispatchTask(context, currentTask, taskRuntime, &runTime, &lastTaskRan, online);
+
+        // If the current task needs to run more,
+        // push it back onto the queue and sort
+        // the queue
+        if(currentTask->left_to_execute != 0)
+        {
+            push_pooled(&queue, currentTask, pool);
+        }
+
+        pop_pooled(&queue, pool);
+
+        // Update task priorities and sort the queue
+        updateTasksPriority(context, &queue, runTime);
+
+        // Sort the queue by priority
+        sortQueueByPriority(&queue);
+
+        // Record the dispatch
+        dispatch_log_append(context->log, runTime - taskRuntime, currentTask->process_id, taskRuntime, priorityBefore, currentTask->priority);
+    }
+
+    context->run_time = runTime;
+
+    // Cleanup
+    empty_queue(&queue);
+    destroy_node_pool(pool);
+}
+
+
+///-------------------------------------------------
+/// @brief  Round robin over a binary heap. Only
+///         the tasks whose priority aged are
+///         re-keyed after each quantum.
+///
+/// @param[in] context The scheduler context
+/// @param[in] task The task queue array
+/// @param[in] size Size of the task queue array
+/// @param[in] online Statistics updated as tasks
+///                   complete
+///
+/// @return None
+///-------------------------------------------------
+static void scheduleWithHeap(struct priority_context_t* context, struct task_t* task, int size, struct online_stats_t* online)
+{
+    int runTime = 0;
+    int taskRuntime = 0;
+    int lastTaskRan = INT_MAX;
+
+    // Nothing to schedule (an empty queue can't
+    // be created)
+    if(size < 1)
+    {
+        return;
+    }
+
+    // Sort task buffer prior to heap creation
+    // NOTE: Must be stable so that equal priorities
+    //       run in the same order as the list engine
+    mergeSortTasksByPriority(task, size);
+
+    // Create heap based on the task array
+    struct heap_queue_t* heap = create_heap_queue(task, size);
+
+    // Scratch space for the tasks aged each quantum
+    struct heap_entry_t* aged = (struct heap_entry_t*)malloc(size * sizeof(struct heap_entry_t));
+
+    // Index the aging triggers of the queued tasks
+    struct aging_index_t* index = create_aging_index(task, size);
+
+    if((heap == NULL) || (aged == NULL) || (index == NULL))
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't create heap queue!\n", __func__);
+        destroy_heap_queue(heap);
+        destroy_aging_index(index);
+        free(aged);
+        return;
+    }
+
+    // Execute the round robin algorithm
+    while(!heap_is_empty(heap))
+    {
+        // "Execute" the highest priority task
+        struct task_t* currentTask = heap_peek(heap);
+
+        taskRuntime = min(currentTask->left_to_execute, context->quantum);
+
+        // Run it for the slice; the priority at
+        // dispatch goes to the dispatch log
+        int priorityBefore = dispatchTask(context, currentTask, taskRuntime, &runTime, &lastTaskRan, online);
+
+        heap_pop(heap);
+        aging_index_disarm(index, currentTask);
+
+        // Update task priorities and, if the current
+        // task needs to run more, re-queue it behind
+        // its peers
+        updateHeapPriority(context, heap, index, aged, (currentTask->left_to_execute != 0) ? currentTask : NULL, runTime);
+
+        // Record the dispatch
+        dispatch_log_append(context->log, runTime - taskRuntime, currentTask->process_id, taskRuntime, priorityBefore, currentTask->priority);
+    }
+
+    context->run_time = runTime;
+
+    // Cleanup
+    destroy_heap_queue(heap);
+    destroy_aging_index(index);
+    free(aged);
+}
+
+
+///-------------------------------------------------
+/// @brief  Round robin over per-level FIFOs. The
+///         next task is found through the ready
+///         bitmap in constant time.
+///
+/// @param[in] context The scheduler context
+/// @param[in] task The task queue array
+/// @param[in] size Size of the task queue array
+/// @param[in] online Statistics updated as tasks
+///                   complete
+///
+/// @return None
+///-------------------------------------------------
+static void scheduleWithBuckets(struct priority_context_t* context, struct task_t* task, int size, struct online_stats_t* online)
+{
+    int runTime = 0;
+    int taskRuntime = 0;
+    int lastTaskRan = INT_MAX;
+
+    // Nothing to schedule (an empty queue can't
+    // be created)
+    if(size < 1)
+    {
+        return;
+    }
+
+    // Sort task buffer prior to queue creation
+    mergeSortTasksByPriority(task, size);
+
+    // Create the bucket queue based on the task array
+    struct bucket_queue_t* bucket = create_bucket_queue(task, size);
+
+    // Scratch space for the tasks aged each quantum
+    struct heap_entry_t* aged = (struct heap_entry_t*)malloc(size * sizeof(struct heap_entry_t));
+
+    // Index the aging triggers of the queued tasks
+    struct aging_index_t* index = create_aging_index(task, size);
+
+    if((bucket == NULL) || (aged == NULL) || (index == NULL))
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't create bucket queue!\n", __func__);
+        destroy_bucket_queue(bucket);
+        destroy_aging_index(index);
+        free(aged);
+        return;
+    }
+
+    // Execute the round robin algorithm
+    while(!bucket_is_empty(bucket))
+    {
+        // "Execute" the first task of the highest level
+        struct task_t* currentTask = bucket_peek(bucket);
+
+        taskRuntime = min(currentTask->left_to_execute, context->quantum);
+
+        // Run it for the slice; the priority at
+        // dispatch goes to the dispatch log
+        int priorityBefore = dispatchTask(context, currentTask, taskRuntime, &runTime, &lastTaskRan, online);
+
+        bucket_pop(bucket);
+        aging_index_disarm(index, currentTask);
+
+        // Update task priorities and, if the current
+        // task needs to run more, re-queue it at the
+        // back of its level
+        updateBucketPriority(context, bucket, index, aged, (currentTask->left_to_execute != 0) ? currentTask : NULL, runTime);
+
+        // Record the dispatch
+        dispatch_log_append(context->log, runTime - taskRuntime, currentTask->process_id, taskRuntime, priorityBefore, currentTask->priority);
+    }
+
+    context->run_time = runTime;
+
+    // Cleanup
+    destroy_bucket_queue(bucket);
+    destroy_aging_index(index);
+    free(aged);
+}
+
+
+///-------------------------------------------------
+/// @brief  Round robin over a binary heap, jumping
+///         straight to the next time at which the
+///         schedule can change
+///
+/// @param[in] context The scheduler context
+/// @param[in] task The task queue array
+/// @param[in] size Size of the task queue array
+/// @param[in] online Statistics updated as tasks
+///                   complete
+///
+/// @return None
+///-------------------------------------------------
+static void scheduleWithEvents(struct priority_context_t* context, struct task_t* task, int size, struct online_stats_t* online)
+{
+    int runTime = 0;
+    int taskRuntime = 0;
+    int lastTaskRan = INT_MAX;
+
+    // Nothing to schedule (an empty queue can't
+    // be created)
+    if(size < 1)
+    {
+        return;
+    }
+
+    // Sort task buffer prior to heap creation
+    mergeSortTasksByPriority(task, size);
+
+    // Create heap based on the task array
+    struct heap_queue_t* heap = create_heap_queue(task, size);
+
+    // Scratch space for the tasks aged each event
+    struct heap_entry_t* aged = (struct heap_entry_t*)malloc(size * sizeof(struct heap_entry_t));
+
+    // Index the aging triggers of the queued tasks
+    struct aging_index_t* index = create_aging_index(task, size);
+
+    if((heap == NULL) || (aged == NULL) || (index == NULL))
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't create heap queue!\n", __func__);
+        destroy_heap_queue(heap);
+        destroy_aging_index(index);
+        free(aged);
+        return;
+    }
+
+    // Execute the round robin algorithm
+    while(!heap_is_empty(heap))
+    {
+        // "Execute" the highest priority task until
+        // the next event
+        struct task_t* currentTask = heap_peek(heap);
+
+        heap_pop(heap);
+        aging_index_disarm(index, currentTask);
+
+        taskRuntime = nextEventSlice(context, heap, index, currentTask, runTime);
+
+        // Run it for the slice; the priority at
+        // dispatch goes to the dispatch log
+        int priorityBefore = dispatchTask(context, currentTask, taskRuntime, &runTime, &lastTaskRan, online);
+
+        // Apply the aging rules that fire at the event
+        // and re-queue the current task if needed
+        updateHeapPriority(context, heap, index, aged, (currentTask->left_to_execute != 0) ? currentTask : NULL, runTime);
+
+        // Record the dispatch
+        dispatch_log_append(context->log, runTime - taskRuntime, currentTask->process_id, taskRuntime, priorityBefore, currentTask->priority);
+    }
+
+    context->run_time = runTime;
+
+    // Cleanup
+    destroy_heap_queue(heap);
+    destroy_aging_index(index);
+    free(aged);
+}
+
+
+///-------------------------------------------------
+/// @brief  Runs a task for one slice: advances the
+///         clock, updates the task's wait and
+///         turnaround times, traces them and adds
+///         completed tasks to the statistics. The
+///         caller ages the queue afterwards and then
+///         records the dispatch.
+///
+/// @param[in] context The scheduler context
+/// @param[in] task The task being dispatched
+/// @param[in] slice How long the task runs
+/// @param[in,out] runTime The current runtime of
+///                        the system
+/// @param[in,out] lastTaskRan Process ID of the
+///                            previously run task
+/// @param[in] online Statistics of the completed
+///                   tasks
+///
+/// @return The priority of the task at dispatch
+///-------------------------------------------------
+static int dispatchTask(struct priority_context_t* context, struct task_t* task, int slice, int* runTime, int* lastTaskRan, struct online_stats_t* online)
+{
+    task->left_to_execute -= slice;
+
+    // Update runtime
+    *runTime += slice;
+
+    // Calculate task wait time and turnaround time
+    // NOTE: If the same task runs twice in a row
+    //       don't update the wait-time
+    if(*lastTaskRan != task->process_id)
+    {
+        task->waiting_time = *runTime - (task->execution_time - task->left_to_execute);
+    }
+
+    task->turnaround_time = *runTime;
+
+    // Keep track of which task just ran
+    *lastTaskRan = task->process_id;
+
+    // Print times to console
+    TRACE_TO(context->trace, TRACE_LEVEL_TASK, "\nTask[%d] Priority: %d\n", task->process_id, task->priority);
+    TRACE_TO(context->trace, TRACE_LEVEL_TASK, "Task[%d] Time Left: %d\n", task->process_id, task->left_to_execute);
+    TRACE_TO(context->trace, TRACE_LEVEL_TASK, "Task[%d] Wait Time: %d\n", task->process_id, task->waiting_time);
+    TRACE_TO(context->trace, TRACE_LEVEL_TASK, "Task[%d] Turnaround Time: %d\n", task->process_id, task->turnaround_time);
+
+    // Completed tasks leave with their final times
+    if(task->left_to_execute == 0)
+    {
+        online_stats_add(online, task);
+    }
+
+    return task->priority;
+}
+
+
+///-------------------------------------------------
+/// @brief  Computes how long the current task can
+///         run before anything else can happen:
+///         it completes, an aging rule fires, or
+///         an equal priority peer is due its turn
+///
+/// @param[in] context The scheduler context
+/// @param[in] heap The heap queue (without the
+///                 current task)
+/// @param[in] index Aging triggers of the queued
+///                  tasks
+/// @param[in] currentTask The task about to run
+/// @param[in] runTime The current runtime of
+///                    the system
+///
+/// @return The length of the slice to run
+///-------------------------------------------------
+static int nextEventSlice(struct priority_context_t* context, struct heap_queue_t* heap, struct aging_index_t* index, struct task_t* currentTask, int runTime)
+{
+    int slice = min(currentTask->left_to_execute, context->quantum);
+    struct task_t* nextTask = heap_peek(heap);
+
+    // A peer of equal priority takes over after one
+    // quantum, so there is nothing to skip
+    if((slice == 0) || ((nextTask != NULL) && (nextTask->priority >= currentTask->priority)))
+    {
+        return slice;
+    }
+
+    // NOTE: Longer quanta only see the aging rules at
+    //       slice boundaries, so every slice is run
+    if(context->quantum != 1)
+    {
+        return slice;
+    }
+
+    // Run to completion unless an event comes first
+    slice = currentTask->left_to_execute;
+
+    // The current task's execution time is reached
+    if(currentTask->execution_time > runTime)
+    {
+        slice = min(slice, currentTask->execution_time - runTime);
+    }
+
+    // The current task's time left meets the runtime
+    // (time left falls by one as runtime rises by one)
+    int gap = currentTask->left_to_execute - runTime;
+
+    if((gap > 0) && ((gap % 2) == 0))
+    {
+        slice = min(slice, gap / 2);
+    }
+
+    // A queued task's execution time or time left is
+    // reached (both are fixed while it waits)
+    int nextTrigger = aging_index_next(index, runTime);
+
+    if(nextTrigger != INT_MAX)
+    {
+        slice = min(slice, nextTrigger - runTime);
+    }
+
+    return slice;
+}
+
+
+///-------------------------------------------------
+/// @brief  Initializes an array of linked tasks
+///
+/// @param[in] task The linked task array
+/// @param[in] execution Array containing the
+///                      execution times of each
+///                      task
+/// @param[in] priority Array containing the
+///                     priority level of each
+///                     task
+/// @param[in] size Size of the linked task array
+///
+/// @return None
+///-------------------------------------------------
+void init_linked(struct task_link_t* task, int *execution, int* priority, int size)
+{
+    for(int i = 0; i < size; i++)
+    {
+        task[i].task.process_id = i;
+        task[i].task.execution_time = execution[i];
+        task[i].task.waiting_time = 0;
+        task[i].task.turnaround_time = 0;
+        task[i].task.priority = priority[i];
+        task[i].task.left_to_execute = execution[i];
+        task[i].next = NULL;
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Priority scheduler algorithm over an
+///         intrusive task queue
+///
+/// @param[in] task The linked task array
+/// @param[in] size Size of the linked task array
+///
+/// @return None
+///-------------------------------------------------
+void priority_schedule_linked(struct task_link_t* task, int size)
+{
+    struct priority_context_t defaults;
+    struct priority_context_t* context = &defaults;
+
+    defaultContext(context, PRIORITY_ENGINE_LIST);
+
     int runTime = 0;
     int taskRuntime = 0;
     int lastTaskRan = INT_MAX;
 
-    // Sort task buffer prior to queue creation
-    sortTasksByPriority(task, size);
+    // Create queue based on the linked task array
+    struct task_list_t queue;
+    task_list_init(&queue);
 
-    // Create queue based on the task array
-    struct node_t* queue = create_queue(task, size);
+    // Statistics collected as tasks complete
+    struct online_stats_t online;
+    online_stats_init(&online);
+
+    for(int i = 0; i < size; i++)
+    {
+        task_list_push(&queue, &(task[i]));
+    }
+
+    // Sort the queue by priority
+    task_list_sort(&queue, isLowerPriority);
 
     // Execute the round robin algorithm
-    while(!is_empty(&queue))
+    while(!task_list_is_empty(&queue))
     {
         // "Execute" the first task
-        struct task_t* currentTask = peek(&queue);
-
-        taskRuntime = min(currentTask->left_to_execute, STATIC_QUANTUM);
-        currentTask->left_to_execute -= taskRuntime;
-        
-        // Update runtime
-        runTime += taskRuntime;
+        struct task_link_t* currentLink = task_list_peek(&queue);
+        struct task_t* currentTask = &(currentLink->task);
 
-        // Calculate task wait time and turnaround time
-        // NOTE: If the same task runs twice in a row
-        //       don't update the wait-time
-        if(lastTaskRan != currentTask->process_id)
-        {
-            currentTask->waiting_time = runTime - (currentTask->execution_time - currentTask->left_to_execute);
-        }
+        taskRuntime = min(currentTask->left_to_execute, context->quantum);
 
-        currentTask->turnaround_time = runTime;
+        // Run it for the slice; the priority at
+        // dispatch goes to the dispatch log
+        int priorityBefore = dispatchTask(context, currentTask, taskRuntime, &runTime, &lastTaskRan, &online);
 
-        // Keep track of which task just ran
-        lastTaskRan = currentTask->process_id;
+        task_list_pop(&queue);
 
         // If the current task needs to run more,
-        // push it back onto the queue and sort
-        // the queue
+        // push it back onto the queue
         if(currentTask->left_to_execute != 0)
         {
-            push(&queue, currentTask);
+            task_list_push(&queue, currentLink);
         }
 
-        pop(&queue);
-
-        // Print times to console
-        printf("\nTask[%d] Priority: %d\n", currentTask->process_id, currentTask->priority);
-        printf("Task[%d] Time Left: %d\n", currentTask->process_id, currentTask->left_to_execute);
-        printf("Task[%d] Wait Time: %d\n", currentTask->process_id, currentTask->waiting_time);
-        printf("Task[%d] Turnaround Time: %d\n", currentTask->process_id, currentTask->turnaround_time);
-
-        // Update task priorities and sort the queue
-        updateTasksPriority(&queue, runTime);
+        // Update task priorities
+        updateLinkedPriority(context, &queue, runTime);
 
         // Sort the queue by priority
-        sortQueueByPriority(&queue);
+        task_list_sort(&queue, isLowerPriority);
+
+        // Record the dispatch
+        dispatch_log_append(context->log, runTime - taskRuntime, currentTask->process_id, taskRuntime, priorityBefore, currentTask->priority);
     }
 
     // Calculate average times
-    float avgWaitTime = calculate_average_wait_time(task, size);
-    float avgTurnaroundTime = calculate_average_turn_around_time(task, size);
-
-    // Print average times
-    printf("Average Wait Time: %f\n", avgWaitTime);
-    printf("Average Turnaround Time: %f\n", avgTurnaroundTime);
+    struct time_stats_t stats;
+    online_stats_read(&online, &stats);
 
-    // Cleanup
-    free(queue->next);
-    free(queue);
+    // Print average times (there are none if no
+    // task ran)
+    if(stats.count > 0)
+    {
+        TRACE_TO(context->trace, TRACE_LEVEL_SUMMARY, "Average Wait Time: %f\n", (float)((double)stats.waitSum / size));
+        TRACE_TO(context->trace, TRACE_LEVEL_SUMMARY, "Average Turnaround Time: %f\n", (float)((double)stats.turnaroundSum / size));
+    }
 
+    // Write out the buffered trace
+    trace_buffer_flush(context->trace);
 }
 
 
@@ -141,14 +836,11 @@ void priority_schedule(struct task_t* task, int size)
 ///-------------------------------------------------
 float calculate_average_wait_time(struct task_t* task, int size)
 {
-    float totalTime = 0;
+    struct time_stats_t stats;
 
-    for(int i = 0; i < size; i++)
-    {
-        totalTime += task[i].waiting_time;
-    }
-    
-    return totalTime / size;
+    calculate_time_stats(task, size, &stats);
+
+    return (float)((double)stats.waitSum / size);
 }
 
 
@@ -160,14 +852,11 @@ float calculate_average_wait_time(struct task_t* task, int size)
 ///-------------------------------------------------
 float calculate_average_turn_around_time(struct task_t* task, int size)
 {
-    float totalTime = 0;
+    struct time_stats_t stats;
 
-    for(int i = 0; i < size; i++)
-    {
-        totalTime += task[i].turnaround_time;
-    }
-    
-    return totalTime / size;
+    calculate_time_stats(task, size, &stats);
+
+    return (float)((double)stats.turnaroundSum / size);
 }
 
 
@@ -175,13 +864,14 @@ float calculate_average_turn_around_time(struct task_t* task, int size)
 /// @brief  Updates the priority of each task
 ///         in the task queue
 ///
+/// @param[in] context The scheduler context
 /// @param[in] head The head of the task queue
 /// @param[in] runTime The current runtime of
 ///                    the system
 ///
 /// @return None
 ///-------------------------------------------------
-static void updateTasksPriority(struct node_t** head, int runTime)
+static void updateTasksPriority(struct priority_context_t* context, struct node_t** head, int runTime)
 {
     struct node_t* queue = (*head);
 
@@ -195,34 +885,320 @@ static void updateTasksPriority(struct node_t** head, int runTime)
     struct node_t* currentNode = sentinel->next;
     struct task_t* currentTask = currentNode->task;
 
-    printf("updateTaskPriority at runtime: %d\n", runTime);
+    TRACE_TO(context->trace, TRACE_LEVEL_AGING, "updateTaskPriority at runtime: %d\n", runTime);
     
     // Traverse the queue
     while(currentNode != sentinel)
     {
-        printf("Task[%d]\n", currentTask->process_id);
-
         // Update task priority
-        if(currentTask->execution_time == runTime)
+        ageTask(context, currentTask, runTime);
+
+        // Move on to next node/task
+        currentNode = currentNode->next;
+        currentTask = currentNode->task;
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Updates the priority of each task
+///         in the intrusive task queue
+///
+/// @param[in] context The scheduler context
+/// @param[in] list The intrusive task queue
+/// @param[in] runTime The current runtime of
+///                    the system
+///
+/// @return None
+///-------------------------------------------------
+static void updateLinkedPriority(struct priority_context_t* context, struct task_list_t* list, int runTime)
+{
+    // Verify that the queue isn't empty
+    if(task_list_is_empty(list))
+    {
+        return;
+    }
+
+    TRACE_TO(context->trace, TRACE_LEVEL_AGING, "updateTaskPriority at runtime: %d\n", runTime);
+
+    // Traverse the queue
+    for(struct task_link_t* link = list->head; link != NULL; link = link->next)
+    {
+        ageTask(context, &(link->task), runTime);
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Updates the priority of the tasks in
+///         the heap queue whose aging rule fires,
+///         then re-queues the current task
+///
+/// @param[in] context The scheduler context
+/// @param[in] heap The heap queue
+/// @param[in] index Aging triggers of the queued
+///                  tasks
+/// @param[in] aged Scratch buffer with room for
+///                 every task in the heap
+/// @param[in] currentTask The task that just ran
+///                        (NULL if it finished)
+/// @param[in] runTime The current runtime of
+///                    the system
+///
+/// @return None
+///-------------------------------------------------
+static void updateHeapPriority(struct priority_context_t* context, struct heap_queue_t* heap, struct aging_index_t* index, struct heap_entry_t* aged, struct task_t* currentTask, int runTime)
+{
+    // Verify that the queue isn't empty
+    if(heap_is_empty(heap) && (currentTask == NULL))
+    {
+        return;
+    }
+
+    TRACE_TO(context->trace, TRACE_LEVEL_AGING, "updateTaskPriority at runtime: %d\n", runTime);
+
+    // Snapshot the tasks whose priority is about to change
+    // (only those with a trigger firing now can change)
+    int agedCount = 0;
+    int firedCount = aging_index_fire(index, runTime);
+
+    for(int i = 0; i < firedCount; i++)
+    {
+        struct heap_entry_t* entry = &(heap->entries[heap->position[index->fired[i] - heap->base]]);
+
+        if(agedPriority(entry->task, runTime) != entry->priority)
         {
-            currentTask->priority = currentTask->priority * 4;
-            printf("New Priority (*4): %d\n", currentTask->priority);
-            
+            aged[agedCount++] = *entry;
         }
+    }
+
+    // Age them in queue order, as the list traversal would
+    qsort(aged, agedCount, sizeof(struct heap_entry_t), compareQueueOrder);
+
+    for(int i = 0; i < agedCount; i++)
+    {
+        ageTask(context, aged[i].task, runTime);
+    }
 
-        if(currentTask->left_to_execute == runTime)
+    // A stable sort keeps risen tasks behind, and fallen tasks
+    // ahead of, their new peers in their original relative order
+    for(int i = 0; i < agedCount; i++)
+    {
+        if(aged[i].task->priority > aged[i].priority)
         {
-            currentTask->priority = currentTask->priority * 2;
-            printf("New Priority (*2): %d\n", currentTask->priority);
+            heap_reprioritize(heap, aged[i].task);
         }
+    }
 
-        // Move on to next node/task
-        currentNode = currentNode->next;
-        currentTask = currentNode->task;
+    for(int i = agedCount - 1; i >= 0; i--)
+    {
+        if(aged[i].task->priority < aged[i].priority)
+        {
+            heap_reprioritize(heap, aged[i].task);
+        }
+    }
+
+    // The current task sits at the back of the queue
+    if(currentTask != NULL)
+    {
+        ageTask(context, currentTask, runTime);
+        heap_push(heap, currentTask);
+        aging_index_arm(index, currentTask, runTime);
     }
 }
 
 
+///-------------------------------------------------
+/// @brief  Updates the priority of the tasks in
+///         the bucket queue whose aging rule
+///         fires, then re-queues the current task
+///
+/// @param[in] context The scheduler context
+/// @param[in] bucket The bucket queue
+/// @param[in] index Aging triggers of the queued
+///                  tasks
+/// @param[in] aged Scratch buffer with room for
+///                 every task in the queue
+/// @param[in] currentTask The task that just ran
+///                        (NULL if it finished)
+/// @param[in] runTime The current runtime of
+///                    the system
+///
+/// @return None
+///-------------------------------------------------
+static void updateBucketPriority(struct priority_context_t* context, struct bucket_queue_t* bucket, struct aging_index_t* index, struct heap_entry_t* aged, struct task_t* currentTask, int runTime)
+{
+    // Verify that the queue isn't empty
+    if(bucket_is_empty(bucket) && (currentTask == NULL))
+    {
+        return;
+    }
+
+    TRACE_TO(context->trace, TRACE_LEVEL_AGING, "updateTaskPriority at runtime: %d\n", runTime);
+
+    // Snapshot the tasks whose priority is about to change
+    // (only those with a trigger firing now can change)
+    int agedCount = 0;
+    int firedCount = aging_index_fire(index, runTime);
+
+    for(int i = 0; i < firedCount; i++)
+    {
+        struct task_t* queuedTask = index->fired[i];
+
+        if(agedPriority(queuedTask, runTime) != queuedTask->priority)
+        {
+            aged[agedCount].task = queuedTask;
+            aged[agedCount].priority = queuedTask->priority;
+            aged[agedCount].order = bucket->order[queuedTask - bucket->base];
+            agedCount++;
+        }
+    }
+
+    // Age them in queue order, as the list traversal would
+    qsort(aged, agedCount, sizeof(struct heap_entry_t), compareLevelOrder);
+
+    for(int i = 0; i < agedCount; i++)
+    {
+        ageTask(context, aged[i].task, runTime);
+    }
+
+    // Risen tasks join the back of their new level in
+    // queue order, fallen tasks join the front in
+    // reverse queue order
+    for(int i = 0; i < agedCount; i++)
+    {
+        if(aged[i].task->priority > aged[i].priority)
+        {
+            bucket_reprioritize(bucket, aged[i].task);
+        }
+    }
+
+    for(int i = agedCount - 1; i >= 0; i--)
+    {
+        if(aged[i].task->priority < aged[i].priority)
+        {
+            bucket_reprioritize(bucket, aged[i].task);
+        }
+    }
+
+    // The current task sits at the back of the queue
+    if(currentTask != NULL)
+    {
+        ageTask(context, currentTask, runTime);
+        bucket_push(bucket, currentTask);
+        aging_index_arm(index, currentTask, runTime);
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Applies the aging rules to a task
+///
+/// @param[in] context The scheduler context
+/// @param[in] task The task to age
+/// @param[in] runTime The current runtime of
+///                    the system
+///
+/// @return None
+///-------------------------------------------------
+static void ageTask(struct priority_context_t* context, struct task_t* task, int runTime)
+{
+    int factor = aging_factor(task, runTime);
+
+    TRACE_TO(context->trace, TRACE_LEVEL_AGING, "Task[%d]\n", task->process_id);
+
+    // Update task priority
+    if(factor != 1)
+    {
+        task->priority = task->priority * factor;
+        TRACE_TO(context->trace, TRACE_LEVEL_AGING, "New Priority (*%d): %d\n", factor, task->priority);
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Computes the priority a task would have
+///         after the aging rules are applied
+///
+/// @param[in] task The task to check
+/// @param[in] runTime The current runtime of
+///                    the system
+///
+/// @return The aged priority
+///-------------------------------------------------
+static int agedPriority(struct task_t* task, int runTime)
+{
+    return task->priority * aging_factor(task, runTime);
+}
+
+
+///-------------------------------------------------
+/// @brief  qsort() comparator ordering heap
+///         entries the way the sorted list holds
+///         them
+///
+/// @param[in] entryA First heap entry
+/// @param[in] entryB Second heap entry
+///
+/// @return <0 if entryA is ahead of entryB,
+///         >0 otherwise
+///-------------------------------------------------
+static int compareQueueOrder(const void* entryA, const void* entryB)
+{
+    const struct heap_entry_t* a = (const struct heap_entry_t*)entryA;
+    const struct heap_entry_t* b = (const struct heap_entry_t*)entryB;
+
+    if(a->priority != b->priority)
+    {
+        return (a->priority > b->priority) ? -1 : 1;
+    }
+
+    return (a->order < b->order) ? -1 : 1;
+}
+
+
+///-------------------------------------------------
+/// @brief  qsort() comparator ordering snapshots of
+///         bucket queue entries the way the bucket
+///         queue holds them
+///
+/// @param[in] entryA First snapshot
+/// @param[in] entryB Second snapshot
+///
+/// @return <0 if entryA is ahead of entryB,
+///         >0 otherwise
+///-------------------------------------------------
+static int compareLevelOrder(const void* entryA, const void* entryB)
+{
+    const struct heap_entry_t* a = (const struct heap_entry_t*)entryA;
+    const struct heap_entry_t* b = (const struct heap_entry_t*)entryB;
+    int levelA = priority_level(a->priority);
+    int levelB = priority_level(b->priority);
+
+    if(levelA != levelB)
+    {
+        return (levelA > levelB) ? -1 : 1;
+    }
+
+    return (a->order < b->order) ? -1 : 1;
+}
+
+
+///-------------------------------------------------
+/// @brief  Orders tasks by priority (descending)
+///         for task_list_sort()
+///
+/// @param[in] taskA First task
+/// @param[in] taskB Second task
+///
+/// @return True if taskA must run after taskB
+///-------------------------------------------------
+static int isLowerPriority(struct task_t* taskA, struct task_t* taskB)
+{
+    return (taskA->priority < taskB->priority);
+}
+
+
 ///-------------------------------------------------
 /// @brief  Sorts the task array by priority
 ///         (descending). Leverages bubble sort.
@@ -250,6 +1226,70 @@ static void sortTasksByPriority(struct task_t* task, int size)
 }
 
 
+///-------------------------------------------------
+/// @brief  Sorts the task array by priority
+///         (descending). Leverages a stable
+///         bottom-up merge sort, so ties keep the
+///         same order sortTasksByPriority() gives.
+///
+/// @param[in] task The task array to sort
+/// @param[in] size The number of elements in the
+///                 task array
+///
+/// @return None
+///-------------------------------------------------
+static void mergeSortTasksByPriority(struct task_t* task, int size)
+{
+    struct task_t* scratch = (struct task_t*)malloc(size * sizeof(struct task_t));
+
+    // Fall back to the in-place sort if malloc fails
+    if(scratch == NULL)
+    {
+        sortTasksByPriority(task, size);
+        return;
+    }
+
+    struct task_t* src = task;
+    struct task_t* dst = scratch;
+
+    for(int width = 1; width < size; width *= 2)
+    {
+        for(int lo = 0; lo < size; lo += 2 * width)
+        {
+            int mid = min(lo + width, size);
+            int hi = min(lo + (2 * width), size);
+            int left = lo;
+            int right = mid;
+
+            // Take from the left run on ties to stay stable
+            for(int out = lo; out < hi; out++)
+            {
+                if((left < mid) && ((right >= hi) || (src[left].priority >= src[right].priority)))
+                {
+                    dst[out] = src[left++];
+                }
+                else
+                {
+                    dst[out] = src[right++];
+                }
+            }
+        }
+
+        struct task_t* temp = src;
+        src = dst;
+        dst = temp;
+    }
+
+    // Copy back if the last pass ended in the scratch buffer
+    if(src != task)
+    {
+        memcpy(task, src, size * sizeof(struct task_t));
+    }
+
+    free(scratch);
+}
+
+
 ///-------------------------------------------------
 /// @brief  Sorts the queue by priority (descending).
 ///         Should be used after a push operation.
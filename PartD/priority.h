@@ -26,6 +26,26 @@ struct task_t {
     int left_to_execute;
 };
 
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Ready queue implementations the priority scheduler can run on
+//----------------------------------------------------------------------------------------------------------------------------------
+enum priority_engine_t {
+
+    // Circular linked list, bubble sorted after every quantum
+    PRIORITY_ENGINE_LIST,
+
+    // Binary max-heap, re-keyed only for tasks whose priority changed
+    PRIORITY_ENGINE_HEAP,
+
+    // One FIFO per priority level plus a ready bitmap (constant time dispatch). Matches the other
+    // engines while priorities stay within [0, PRIORITY_LEVELS); priorities outside are clamped.
+    PRIORITY_ENGINE_BITMAP,
+
+    // Binary max-heap with event-driven time advance: a task that outranks every other ready task
+    // runs straight to the next completion or aging trigger instead of one quantum at a time
+    PRIORITY_ENGINE_EVENT
+};
+
 //----------------------------------------------------------------------------------------------------------------------------------
 /// @brief Intialize the task array
 ///
@@ -45,6 +65,42 @@ void init(struct task_t *task, int *execution, int * priority, int size);
 //----------------------------------------------------------------------------------------------------------------------------------
 void priority_schedule(struct task_t *task, int size);
 
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Run the priority scheduling algorithm on the given ready queue engine. The list, heap and
+/// event engines produce the same wait time, turn around time and final priority for each task; the
+/// bitmap engine agrees with them only while priorities stay within [0, PRIORITY_LEVELS).
+///
+/// @param[in] task The buffer containing task data
+/// @param[in] size The size of the buffer
+/// @param[in] engine The ready queue implementation to schedule with
+//----------------------------------------------------------------------------------------------------------------------------------
+void priority_schedule_engine(struct task_t *task, int size, enum priority_engine_t engine);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Task with an intrusive queue link (defined in queue.h)
+//----------------------------------------------------------------------------------------------------------------------------------
+struct task_link_t;
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Intialize an array of linked tasks
+///
+/// @param[in] task The buffer containing linked task data
+/// @param[in] execution The execution time for each task
+/// @param[in] priority The priority for each task
+/// @param[in] size The size of the buffer
+//----------------------------------------------------------------------------------------------------------------------------------
+void init_linked(struct task_link_t *task, int *execution, int * priority, int size);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Run the priority scheduling algorithm on linked tasks without allocating any queue nodes.
+/// The buffer keeps its order; each task gets the same wait time, turn around time and final
+/// priority as with priority_schedule().
+///
+/// @param[in] task The buffer containing linked task data
+/// @param[in] size The size of the buffer
+//----------------------------------------------------------------------------------------------------------------------------------
+void priority_schedule_linked(struct task_link_t *task, int size);
+
 //----------------------------------------------------------------------------------------------------------------------------------
 /// @brief Calculates the average wait time.
 ///
@@ -1,6 +1,18 @@
 #include <stdlib.h>
+#include <string.h>
+#include <limits.h>
 #include "ctest.h"
+#include "trace.h"
+#include "record.h"
+#include "stats.h"
+#include "workload.h"
+#include "generator.h"
 #include "priority.h"
+#include "queue.h"
+#include "aging.h"
+#include "context.h"
+#include <pthread.h>
+#include <unistd.h>
 
 
 ///-------------------------------------------------
@@ -152,4 +164,1328 @@ CTEST2(priority, leftToExecute_process)
     {
         ASSERT_EQUAL(leftToExecute[i], data->task[i].left_to_execute);
     }
-}
\ No newline at end of file
+}
+
+/******************************
+ *   ENGINE EQUIVALENCE TEST  *
+ ******************************/
+
+
+///-------------------------------------------------
+/// @brief  Live queue nodes, for the leak check
+///
+/// @return The number of live nodes
+///-------------------------------------------------
+static intmax_t liveQueueNodes(void)
+{
+    struct queue_alloc_stats_t stats;
+
+    queue_alloc_stats(&stats);
+
+    return stats.live_nodes;
+}
+
+
+///-------------------------------------------------
+/// @brief  Live queue bytes, for the leak check
+///
+/// @return The number of live bytes
+///-------------------------------------------------
+static intmax_t liveQueueBytes(void)
+{
+    struct queue_alloc_stats_t stats;
+
+    queue_alloc_stats(&stats);
+
+    return stats.live_bytes;
+}
+
+
+///-------------------------------------------------
+/// @brief  Track the queue allocations from the
+///         start, so every test fails if it leaks
+///         queue memory
+///
+/// @return None
+///-------------------------------------------------
+__attribute__((constructor)) static void trackQueueAllocations(void)
+{
+    queue_alloc_enable_tracking();
+    ctest_track_leaks("queue nodes", liveQueueNodes);
+    ctest_track_leaks("queue bytes", liveQueueBytes);
+}
+
+
+///-------------------------------------------------
+/// @brief  Validate that the heap and event
+///         engines produce the same schedule as
+///         the list engine, and the bitmap engine
+///         does while priorities stay within its
+///         levels
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(priorityEngines, matchList_process)
+{
+    struct engine_dataset_t {
+        int size;
+        int execution[8];
+        int priority[8];
+
+        // Priorities stay within the bitmap levels (the
+        // bitmap engine clamps the others, so its order
+        // differs from the list engine)
+        int inLevels;
+    };
+
+    struct engine_dataset_t dataset[] = {
+        // Mixed, with a zero length task and a negative priority
+        {8, {4, 1, 3, 0, 5, 2, 3, 6}, {2, 5, 2, 3, -1, 0, 5, 2}, 0},
+        // Short tasks
+        {6, {3, 1, 2, 2, 4, 1}, {1, 3, 1, 2, 0, 3}, 1},
+        // Equal priorities
+        {6, {5, 3, 4, 1, 2, 6}, {2, 2, 2, 2, 2, 2}, 1},
+        // Long tasks, which the event engine skips ahead on
+        {8, {40, 3, 25, 0, 12, 7, 30, 18}, {2, 5, 9, 3, -1, 0, 5, 2}, 0},
+        // Long tasks with equal priorities
+        {5, {30, 12, 25, 8, 17}, {1, 1, 1, 1, 1}, 1},
+    };
+
+    enum priority_engine_t engine[] = {PRIORITY_ENGINE_HEAP, PRIORITY_ENGINE_BITMAP, PRIORITY_ENGINE_EVENT};
+
+    for(size_t d = 0; d < sizeof(dataset) / sizeof(dataset[0]); d++)
+    {
+        struct engine_dataset_t* current = &(dataset[d]);
+        struct task_t listTask[8];
+
+        init(listTask, current->execution, current->priority, current->size);
+        priority_schedule_engine(listTask, current->size, PRIORITY_ENGINE_LIST);
+
+        for(size_t e = 0; e < sizeof(engine) / sizeof(engine[0]); e++)
+        {
+            if((engine[e] == PRIORITY_ENGINE_BITMAP) && !current->inLevels)
+            {
+                continue;
+            }
+
+            struct task_t engineTask[8];
+
+            init(engineTask, current->execution, current->priority, current->size);
+            priority_schedule_engine(engineTask, current->size, engine[e]);
+
+            for(int i = 0; i < current->size; i++)
+            {
+                if(engine[e] == PRIORITY_ENGINE_BITMAP)
+                {
+                    ASSERT_INTERVAL(0, PRIORITY_LEVELS - 1, listTask[i].priority);
+                }
+
+                ASSERT_EQUAL(listTask[i].process_id, engineTask[i].process_id);
+                ASSERT_EQUAL(listTask[i].priority, engineTask[i].priority);
+                ASSERT_EQUAL(listTask[i].waiting_time, engineTask[i].waiting_time);
+                ASSERT_EQUAL(listTask[i].turnaround_time, engineTask[i].turnaround_time);
+                ASSERT_EQUAL(0, engineTask[i].left_to_execute);
+            }
+        }
+    }
+}
+
+
+/******************************
+ *    NODE POOL UNIT TEST     *
+ ******************************/
+
+
+///-------------------------------------------------
+/// @brief  Validate that push/pop cycles on a
+///         pooled queue recycle nodes instead of
+///         allocating new slabs
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(nodePool, recycle_process)
+{
+    struct task_t task[3];
+    struct node_pool_t* pool = create_node_pool(5);
+    struct node_t* queue = create_queue_from_pool(task, 3, pool);
+
+    for(int i = 0; i < 1000; i++)
+    {
+        struct task_t* topTask = peek(&queue);
+
+        push_pooled(&queue, topTask, pool);
+        pop_pooled(&queue, pool);
+    }
+
+    ASSERT_EQUAL(1, pool->slabCount);
+    ASSERT_TRUE(peek(&queue) == &(task[1]));
+
+    empty_queue(&queue);
+    destroy_node_pool(pool);
+}
+
+
+/******************************
+ * QUEUE DESCRIPTOR UNIT TEST *
+ ******************************/
+
+
+///-------------------------------------------------
+/// @brief  Validate that the queue descriptor
+///         tracks its size and tail while tasks
+///         are pushed and popped
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(queueDescriptor, sizeAndTail_process)
+{
+    struct task_t task[4];
+    struct queue_t* queue = create_task_queue(task, 3, NULL);
+
+    ASSERT_EQUAL(3, queue_size(queue));
+    ASSERT_TRUE(queue->tail->task == &(task[2]));
+
+    queue_push(queue, &(task[3]));
+    ASSERT_EQUAL(4, queue_size(queue));
+    ASSERT_TRUE(queue->tail->task == &(task[3]));
+
+    for(int i = 0; i < 4; i++)
+    {
+        ASSERT_TRUE(queue_peek(queue) == &(task[i]));
+        queue_pop(queue);
+    }
+
+    ASSERT_TRUE(queue_is_empty(queue));
+    ASSERT_EQUAL(0, queue_size(queue));
+    ASSERT_TRUE(queue->tail == &(queue->sentinel));
+
+    destroy_task_queue(queue);
+}
+
+
+///-------------------------------------------------
+/// @brief  Validate that the head made by
+///         create_new_node(NULL) works with the
+///         node_t** API and that a task node is
+///         rejected as a head
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(queueDescriptor, nodeHead_process)
+{
+    struct task_t task[3];
+    struct node_t* head = create_new_node(NULL);
+
+    ASSERT_NOT_NULL(head);
+    ASSERT_TRUE(is_empty(&head));
+
+    push(&head, &(task[0]));
+    push(&head, &(task[1]));
+    ASSERT_TRUE(peek(&head) == &(task[0]));
+    pop(&head);
+    ASSERT_TRUE(peek(&head) == &(task[1]));
+
+    // A task node isn't the head of a queue
+    struct node_t* node = head->next;
+    struct node_t* next = node->next;
+
+    push(&node, &(task[2]));
+    ASSERT_TRUE(node->next == next);
+    ASSERT_NULL(peek(&node));
+
+    empty_queue(&head);
+    ASSERT_NULL(head);
+}
+
+
+/******************************
+ *  INTRUSIVE QUEUE UNIT TEST *
+ ******************************/
+
+
+///-------------------------------------------------
+/// @brief  Dataset for the linked priority
+///         unit-test
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST_DATA(priorityLinked)
+{
+    struct task_t task[8];
+    struct task_link_t linkedTask[8];
+    int size;
+};
+
+
+///-------------------------------------------------
+/// @brief  Setup the linked priority unit-test by
+///         running the same dataset through the
+///         array and intrusive schedulers
+//
+/// @retval  None
+///-------------------------------------------------
+CTEST_SETUP(priorityLinked)
+{
+    int execution[] = {4, 1, 3, 0, 5, 2, 3, 6};
+    int priority[] = {2, 5, 2, 3, -1, 0, 5, 2};
+    data->size = sizeof(execution) / sizeof(execution[0]);
+
+    init(data->task, execution, priority, data->size);
+    init_linked(data->linkedTask, execution, priority, data->size);
+
+    priority_schedule(data->task, data->size);
+    priority_schedule_linked(data->linkedTask, data->size);
+}
+
+
+///-------------------------------------------------
+/// @brief  Validate that every linked task ends up
+///         with the same times and priority as in
+///         the array scheduler
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST2(priorityLinked, matchesArray_process)
+{
+    for(int i = 0; i < data->size; i++)
+    {
+        struct task_t* linked = &(data->linkedTask[data->task[i].process_id].task);
+
+        ASSERT_EQUAL(data->task[i].priority, linked->priority);
+        ASSERT_EQUAL(data->task[i].waiting_time, linked->waiting_time);
+        ASSERT_EQUAL(data->task[i].turnaround_time, linked->turnaround_time);
+        ASSERT_EQUAL(0, linked->left_to_execute);
+    }
+}
+
+
+/******************************
+ *   BITMAP ENGINE UNIT TEST  *
+ ******************************/
+
+
+///-------------------------------------------------
+/// @brief  Validate the schedule once priorities
+///         age past the highest level: tasks
+///         clamped to it run in arrival order, not
+///         by priority as in the list engine
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(priorityBitmap, clampedOrder_process)
+{
+    struct task_t task[3];
+    int execution[] = {3, 1, 2};
+    int priority[] = {26, 1, 21};
+
+    init(task, execution, priority, 3);
+    priority_schedule_engine(task, 3, PRIORITY_ENGINE_BITMAP);
+
+    // Task[2] ages to 168 at runtime 2 and runs first,
+    // Task[0] ages to 104 at runtime 3 and joins the
+    // top level ahead of Task[2] (the list engine
+    // would run Task[2] again)
+    int sortedPID[] = {0, 2, 1};
+    int agedPriority[] = {104, 168, 8};
+    int waitTime[] = {1, 3, 5};
+    int turnaroundTime[] = {4, 5, 6};
+
+    for(int i = 0; i < 3; i++)
+    {
+        ASSERT_EQUAL(sortedPID[i], task[i].process_id);
+        ASSERT_EQUAL(agedPriority[i], task[i].priority);
+        ASSERT_EQUAL(waitTime[i], task[i].waiting_time);
+        ASSERT_EQUAL(turnaroundTime[i], task[i].turnaround_time);
+        ASSERT_EQUAL(task[i].turnaround_time - task[i].execution_time, task[i].waiting_time);
+        ASSERT_EQUAL(0, task[i].left_to_execute);
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Validate that priorities outside the
+///         level range are clamped
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(priorityBitmap, clampLevels_process)
+{
+    ASSERT_EQUAL(0, priority_level(-5));
+    ASSERT_EQUAL(7, priority_level(7));
+    ASSERT_EQUAL(PRIORITY_LEVELS - 1, priority_level(1000));
+}
+
+
+/******************************
+ *   AGING INDEX UNIT TEST    *
+ ******************************/
+
+
+///-------------------------------------------------
+/// @brief  Validate that only the tasks whose
+///         trigger fires are reported, and that
+///         they keep firing until time moves on
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(agingIndex, fire_process)
+{
+    struct task_t task[4];
+    int execution[] = {3, 5, 3, 8};
+    int priority[] = {1, 1, 1, 1};
+
+    init(task, execution, priority, 4);
+
+    struct aging_index_t* index = create_aging_index(task, 4);
+
+    ASSERT_NOT_NULL(index);
+    ASSERT_EQUAL(0, aging_index_fire(index, 1));
+    ASSERT_EQUAL(3, aging_index_next(index, 1));
+
+    // Both tasks firing at 3 are reported once each
+    ASSERT_EQUAL(2, aging_index_fire(index, 3));
+    ASSERT_EQUAL(2, aging_index_fire(index, 3));
+    ASSERT_EQUAL(5, aging_index_next(index, 3));
+
+    // A task that ran is re-armed on its time left
+    task[3].left_to_execute = 6;
+    aging_index_arm(index, &(task[3]), 4);
+    aging_index_disarm(index, &(task[1]));
+
+    ASSERT_EQUAL(6, aging_index_next(index, 4));
+    ASSERT_EQUAL(0, aging_index_fire(index, 5));
+    ASSERT_EQUAL(1, aging_index_fire(index, 6));
+    ASSERT_TRUE(index->fired[0] == &(task[3]));
+    ASSERT_EQUAL(8, aging_index_next(index, 6));
+
+    destroy_aging_index(index);
+}
+
+
+/******************************
+ *      TRACE UNIT TEST       *
+ ******************************/
+
+
+///-------------------------------------------------
+/// @brief  Validate that the runtime level filters
+///         trace output and that the ring sink
+///         keeps it in memory
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(trace, ringLevel_process)
+{
+    struct task_t task[3];
+    char output[TRACE_BUFFER_SIZE];
+    int execution[] = {3, 1, 2};
+    int priority[] = {1, 4, 2};
+
+    trace_set_sink(TRACE_SINK_RING);
+    trace_set_level(TRACE_LEVEL_SUMMARY);
+
+    init(task, execution, priority, 3);
+    priority_schedule(task, 3);
+
+    trace_snapshot(output, sizeof(output));
+
+    // Restore the defaults (writes out the retained lines)
+    trace_set_level(TRACE_LEVEL_AGING);
+    trace_set_sink(TRACE_SINK_STDOUT);
+
+    // Release builds compile every trace out
+#if TRACE_COMPILE_LEVEL >= TRACE_LEVEL_SUMMARY
+    ASSERT_NOT_NULL(strstr(output, "Average Wait Time"));
+#endif
+    ASSERT_NULL(strstr(output, "Task["));
+}
+
+
+/******************************
+ *   DISPATCH LOG UNIT TEST   *
+ ******************************/
+
+
+///-------------------------------------------------
+/// @brief  Validate that every dispatch is recorded
+///         and survives a round trip through the
+///         binary file and the JSON exporter
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(dispatchLog, roundTrip_process)
+{
+    struct task_t task[3];
+    int execution[] = {3, 1, 2};
+    int priority[] = {1, 4, 2};
+    const char* path = "dispatch_test.log";
+    struct dispatch_log_t* log = create_dispatch_log(1);
+
+    ASSERT_NOT_NULL(log);
+
+    dispatch_log_start(log);
+    init(task, execution, priority, 3);
+    priority_schedule(task, 3);
+    dispatch_log_stop();
+
+    ASSERT_EQUAL(0, dispatch_log_write(log, path));
+
+    struct dispatch_log_t* copy = dispatch_log_read(path);
+    remove(path);
+
+    ASSERT_NOT_NULL(copy);
+    ASSERT_EQUAL(log->size, copy->size);
+    ASSERT_EQUAL(0, log->dropped);
+
+    // One quantum per dispatch, back to back
+    int order[] = {1, 2, 2, 0, 0, 0};
+
+    ASSERT_EQUAL(6, copy->size);
+
+    for(int i = 0; i < 6; i++)
+    {
+        ASSERT_EQUAL(order[i], copy->records[i].process_id);
+        ASSERT_EQUAL(i, copy->records[i].time);
+        ASSERT_EQUAL(1, copy->records[i].slice);
+    }
+
+    // Task[2] ages (*4) when runtime reaches its
+    // execution time
+    ASSERT_EQUAL(2, copy->records[1].priority_before);
+    ASSERT_EQUAL(8, copy->records[1].priority_after);
+
+    FILE* json = tmpfile();
+
+    ASSERT_NOT_NULL(json);
+    ASSERT_EQUAL(0, dispatch_log_export_json(copy, json));
+    fclose(json);
+
+    // A log too long for the header's count is refused
+    // before anything is written
+    struct dispatch_log_t oversized = *copy;
+    oversized.size = (size_t)INT_MAX + 1;
+
+    ASSERT_EQUAL(-1, dispatch_log_write(&oversized, path));
+    ASSERT_NULL(fopen(path, "rb"));
+
+    destroy_dispatch_log(log);
+    destroy_dispatch_log(copy);
+}
+
+
+/******************************
+ *   LATENCY HISTOGRAM TEST   *
+ ******************************/
+
+
+///-------------------------------------------------
+/// @brief  Validate the histograms built from the
+///         wait and turnaround times of a schedule
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(latencyHistogram, scheduleTimes_process)
+{
+    struct task_t task[5];
+    int execution[] = {4, 2, 6, 1, 3};
+    int priority[] = {2, 7, 1, 3, 5};
+    static struct histogram_t wait;
+    static struct histogram_t turnaround;
+
+    init(task, execution, priority, 5);
+    priority_schedule(task, 5);
+
+    histogram_init(&wait);
+    histogram_init(&turnaround);
+    histogram_record_wait_times(&wait, task, 5);
+    histogram_record_turnaround_times(&turnaround, task, 5);
+
+    int maxWait = 0;
+    int maxTurnaround = 0;
+
+    for(int i = 0; i < 5; i++)
+    {
+        maxWait = (task[i].waiting_time > maxWait) ? task[i].waiting_time : maxWait;
+        maxTurnaround = (task[i].turnaround_time > maxTurnaround) ? task[i].turnaround_time : maxTurnaround;
+    }
+
+    // Small values are counted exactly
+    ASSERT_EQUAL(5, wait.total);
+    ASSERT_EQUAL(maxWait, histogram_percentile(&wait, 100.0));
+    ASSERT_EQUAL(maxTurnaround, histogram_percentile(&turnaround, 99.9));
+    ASSERT_DBL_NEAR_TOL(calculate_average_wait_time(task, 5), (float)((double)wait.sum / wait.total), 1e-4);
+}
+
+
+/******************************
+ *   FUSED STATS UNIT TEST    *
+ ******************************/
+
+
+///-------------------------------------------------
+/// @brief  Validate that the fused statistics stay
+///         exact past float precision (2^24)
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(timeStats, exactSums_process)
+{
+    struct task_t task[7];
+    struct time_stats_t stats;
+
+    for(int i = 0; i < 7; i++)
+    {
+        task[i].process_id = i;
+        task[i].waiting_time = (1 << 24) + 1;
+        task[i].turnaround_time = (1 << 30) + i;
+    }
+
+    calculate_time_stats(task, 7, &stats);
+
+    ASSERT_EQUAL(7LL * ((1 << 24) + 1), stats.waitSum);
+    ASSERT_DBL_NEAR_TOL(0.0, stats.waitVariance, 1e-9);
+    ASSERT_EQUAL((7LL << 30) + 21, stats.turnaroundSum);
+    ASSERT_EQUAL(1 << 30, stats.turnaroundMin);
+    ASSERT_EQUAL((1 << 30) + 6, stats.turnaroundMax);
+    ASSERT_DBL_NEAR_TOL(4.0, stats.turnaroundVariance, 1e-9);
+}
+
+
+/******************************
+ *  ONLINE STATS UNIT TEST    *
+ ******************************/
+
+
+///-------------------------------------------------
+/// @brief  Validate that statistics collected in
+///         completion order match the post pass
+///         over the task array
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(onlineStats, completionOrder_process)
+{
+    struct task_t task[4];
+    int waitTime[] = {9, 0, 4, 2};
+    int turnaroundTime[] = {12, 5, 11, 6};
+    int completed[] = {1, 3, 2, 0};
+    struct online_stats_t online;
+    struct time_stats_t running;
+    struct time_stats_t stats;
+
+    for(int i = 0; i < 4; i++)
+    {
+        task[i].process_id = i;
+        task[i].waiting_time = waitTime[i];
+        task[i].turnaround_time = turnaroundTime[i];
+    }
+
+    online_stats_init(&online);
+
+    for(int i = 0; i < 4; i++)
+    {
+        online_stats_add(&online, &(task[completed[i]]));
+    }
+
+    online_stats_read(&online, &running);
+    calculate_time_stats(task, 4, &stats);
+
+    ASSERT_EQUAL(4, running.count);
+    ASSERT_EQUAL(stats.waitSum, running.waitSum);
+    ASSERT_EQUAL(0, running.waitMin);
+    ASSERT_EQUAL(9, running.waitMax);
+    ASSERT_DBL_NEAR_TOL(stats.waitVariance, running.waitVariance, 1e-9);
+    ASSERT_EQUAL(stats.turnaroundSum, running.turnaroundSum);
+    ASSERT_EQUAL(5, running.turnaroundMin);
+    ASSERT_EQUAL(12, running.turnaroundMax);
+    ASSERT_DBL_NEAR_TOL(stats.turnaroundVariance, running.turnaroundVariance, 1e-9);
+}
+
+
+/******************************
+ *   WORKLOAD LOADER TEST     *
+ ******************************/
+
+
+///-------------------------------------------------
+/// @brief  Validate that tasks loaded from a CSV
+///         workload schedule the same as tasks
+///         built from the same arrays
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(workload, csvSchedule_process)
+{
+    const char* path = "workload_test.csv";
+    int execution[] = {10, 5, 8, 1};
+    int priority[] = {3, 1, 3, 2};
+    struct task_t expected[4];
+    struct task_t loaded[4];
+    FILE* file = fopen(path, "w");
+
+    ASSERT_NOT_NULL(file);
+    fputs("10,3\n5,1,4\n8,3\n1,2\n", file);
+    fclose(file);
+
+    struct workload_t* workload = workload_load(path);
+    remove(path);
+
+    ASSERT_NOT_NULL(workload);
+    ASSERT_EQUAL(4, workload->size);
+    ASSERT_EQUAL(4, workload->arrival[1]);
+
+    // Schedule quietly
+    trace_set_level(TRACE_LEVEL_OFF);
+
+    init(expected, execution, priority, 4);
+    priority_schedule(expected, 4);
+
+    workload_init_tasks(workload, loaded);
+    priority_schedule(loaded, 4);
+
+    trace_set_level(TRACE_LEVEL_AGING);
+
+    for(int i = 0; i < 4; i++)
+    {
+        ASSERT_EQUAL(expected[i].waiting_time, loaded[i].waiting_time);
+        ASSERT_EQUAL(expected[i].turnaround_time, loaded[i].turnaround_time);
+        ASSERT_EQUAL(expected[i].priority, loaded[i].priority);
+    }
+
+    destroy_workload(workload);
+}
+
+
+/******************************
+ *   WORKLOAD READER TEST     *
+ ******************************/
+
+
+///-------------------------------------------------
+/// @brief  Validate reading CSV tasks one at a time
+///         from a pipe, including a header, blank
+///         lines and an unterminated last line
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(workloadReader, pipe_process)
+{
+    const char* input = "execution,priority\n7,2\n\n3\r\n5,1,9";
+    int pipeFd[2];
+
+    ASSERT_EQUAL(0, pipe(pipeFd));
+    ASSERT_EQUAL(strlen(input), write(pipeFd[1], input, strlen(input)));
+    close(pipeFd[1]);
+
+    struct workload_reader_t* reader = create_workload_reader(pipeFd[0]);
+
+    ASSERT_NOT_NULL(reader);
+
+    int expected[3][3] = {{7, 2, 0}, {3, 0, 0}, {5, 1, 9}};
+    int value[3];
+
+    for(int i = 0; i < 3; i++)
+    {
+        ASSERT_EQUAL(1, workload_reader_next(reader, value));
+        ASSERT_EQUAL(expected[i][0], value[0]);
+        ASSERT_EQUAL(expected[i][1], value[1]);
+        ASSERT_EQUAL(expected[i][2], value[2]);
+    }
+
+    ASSERT_EQUAL(0, workload_reader_next(reader, value));
+
+    destroy_workload_reader(reader);
+    close(pipeFd[0]);
+}
+
+
+/******************************
+ *  WORKLOAD GENERATOR TEST   *
+ ******************************/
+
+
+///-------------------------------------------------
+/// @brief  Validate the engines against each other
+///         on a generated heavy tailed workload
+///         with Zipf priorities
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(generator, engines_process)
+{
+    struct generator_config_t config;
+    static struct task_t listTask[300];
+    static struct task_t eventTask[300];
+
+    generator_default_config(&config, 7);
+    config.execution = GENERATOR_PARETO;
+    config.priority_levels = 20;
+
+    struct generator_t* generator = create_generator(&config);
+
+    ASSERT_NOT_NULL(generator);
+
+    generate_tasks(generator, listTask, 300);
+    memcpy(eventTask, listTask, sizeof(listTask));
+
+    // Schedule quietly
+    trace_set_level(TRACE_LEVEL_OFF);
+
+    priority_schedule_engine(listTask, 300, PRIORITY_ENGINE_LIST);
+    priority_schedule_engine(eventTask, 300, PRIORITY_ENGINE_EVENT);
+
+    trace_set_level(TRACE_LEVEL_AGING);
+
+    for(int i = 0; i < 300; i++)
+    {
+        ASSERT_EQUAL(listTask[i].waiting_time, eventTask[i].waiting_time);
+        ASSERT_EQUAL(listTask[i].turnaround_time, eventTask[i].turnaround_time);
+        ASSERT_EQUAL(listTask[i].priority, eventTask[i].priority);
+    }
+
+    destroy_generator(generator);
+}
+
+
+/******************************
+ *  UPDATE PRIORITY UNIT TEST *
+ ******************************/
+
+
+///-------------------------------------------------
+/// @brief  Validate that update_priority() applies
+///         both aging rules to the queued tasks
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(queue, updatePriority_process)
+{
+    struct task_t task[3];
+    int execution[] = {4, 2, 6};
+    int priority[] = {1, 3, 5};
+
+    init(task, execution, priority, 3);
+
+    // Task[2] has 4 time units left
+    task[2].left_to_execute = 4;
+
+    struct node_t* head = create_queue(task, 3);
+
+    ASSERT_NOT_NULL(head);
+
+    update_priority(&head, 4);
+
+    // Executes in 4 (*4) and has 4 left (*2)
+    ASSERT_EQUAL(8, task[0].priority);
+    ASSERT_EQUAL(3, task[1].priority);
+    ASSERT_EQUAL(10, task[2].priority);
+
+    empty_queue(&head);
+    update_priority(&head, 4);
+}
+
+
+/******************************
+ * PRIORITY PERFORMANCE BUDGET*
+ ******************************/
+
+// Size of the generated workload the budget holds for (the list engine sorts every quantum, so
+// its time grows with the cube of the task count)
+#define PRIORITY_BUDGET_TASKS 64
+
+// Size of the generated workload the event engine budget holds for (its heap keeps every dispatch
+// at O(log n))
+#define PRIORITY_EVENT_BUDGET_TASKS (1 << 12)
+
+
+///-------------------------------------------------
+/// @brief  Dataset for the priority budget test
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST_DATA(priorityBudget)
+{
+    struct task_t generated[PRIORITY_BUDGET_TASKS];
+    struct task_t task[PRIORITY_BUDGET_TASKS];
+    struct task_t* eventGenerated;
+    struct task_t* eventTask;
+    int traceLevel;
+};
+
+
+///-------------------------------------------------
+/// @brief  Setup the priority budget tests: the
+///         workloads are generated once and the
+///         trace turned off
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST_SETUP(priorityBudget)
+{
+    struct generator_config_t config;
+
+    generator_default_config(&config, 7);
+
+    data->traceLevel = trace_default.level;
+    data->eventGenerated = (struct task_t*)malloc(PRIORITY_EVENT_BUDGET_TASKS * sizeof(struct task_t));
+    data->eventTask = (struct task_t*)malloc(PRIORITY_EVENT_BUDGET_TASKS * sizeof(struct task_t));
+
+    struct generator_t* generator = create_generator(&config);
+
+    ASSERT_NOT_NULL(generator);
+    ASSERT_NOT_NULL(data->eventGenerated);
+    ASSERT_NOT_NULL(data->eventTask);
+
+    generate_tasks(generator, data->generated, PRIORITY_BUDGET_TASKS);
+    generate_tasks(generator, data->eventGenerated, PRIORITY_EVENT_BUDGET_TASKS);
+    destroy_generator(generator);
+
+    trace_set_level(TRACE_LEVEL_OFF);
+}
+
+
+///-------------------------------------------------
+/// @brief  Restore the trace level and free the
+///         workload, whether or not the test passed
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST_TEARDOWN(priorityBudget)
+{
+    trace_set_level(data->traceLevel);
+    free(data->eventGenerated);
+    free(data->eventTask);
+}
+
+
+///-------------------------------------------------
+/// @brief  Validate that priority_schedule stays
+///         within its time and allocation budget
+///         on a generated workload
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST2_BENCH(priorityBudget, largeWorkload_process, 5)
+{
+    // Every iteration schedules the same workload
+    memcpy(data->task, data->generated, sizeof(data->generated));
+
+    // Requeued tasks reuse pooled nodes, so nothing
+    // is allocated per quantum
+    ASSERT_ALLOCS_AT_MOST(4, ASSERT_FASTER_THAN(40, priority_schedule(data->task, PRIORITY_BUDGET_TASKS)));
+}
+
+
+///-------------------------------------------------
+/// @brief  Validate that the event engine stays
+///         within its time and allocation budget
+///         on a large generated workload
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST2_BENCH(priorityBudget, eventEngine_process, 5)
+{
+    // Every iteration schedules the same workload
+    memcpy(data->eventTask, data->eventGenerated, PRIORITY_EVENT_BUDGET_TASKS * sizeof(struct task_t));
+
+    // The heap and the aging index are allocated
+    // once, whatever the number of tasks
+    ASSERT_ALLOCS_AT_MOST(10, ASSERT_FASTER_THAN(150, priority_schedule_engine(data->eventTask, PRIORITY_EVENT_BUDGET_TASKS, PRIORITY_ENGINE_EVENT)));
+}
+
+
+/******************************
+ *  QUEUE ALLOCATION TRACKER  *
+ ******************************/
+
+
+///-------------------------------------------------
+/// @brief  Validate that the allocation tracker
+///         accounts for pooled nodes, heap queues
+///         and bucket queues
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(queueAlloc, pooledAndEngines_process)
+{
+    struct task_t task[64];
+    int execution[64];
+    int priority[64];
+    struct queue_alloc_stats_t before;
+    struct queue_alloc_stats_t stats;
+
+    for(int i = 0; i < 64; i++)
+    {
+        execution[i] = 1 + (i % 7);
+        priority[i] = 1 + (i % 5);
+    }
+
+    init(task, execution, priority, 64);
+
+    queue_alloc_stats(&before);
+    queue_alloc_reset_peak();
+
+    struct node_pool_t* pool = create_node_pool(16);
+    struct node_t* head = create_queue_from_pool(task, 64, pool);
+    struct heap_queue_t* heap = create_heap_queue(task, 64);
+    struct bucket_queue_t* bucket = create_bucket_queue(task, 64);
+
+    ASSERT_NOT_NULL(head);
+    ASSERT_NOT_NULL(heap);
+    ASSERT_NOT_NULL(bucket);
+
+    // Pooled nodes come out of four slabs, not malloc
+    queue_alloc_stats(&stats);
+    ASSERT_EQUAL(before.live_nodes, stats.live_nodes);
+    ASSERT_EQUAL(4, pool->slabCount);
+    ASSERT_EQUAL(before.live_bytes
+                 + sizeof(struct node_pool_t) + 4 * (sizeof(struct node_slab_t) + 16 * sizeof(struct node_t)) + sizeof(struct queue_t)
+                 + sizeof(struct heap_queue_t) + 64 * (sizeof(struct heap_entry_t) + sizeof(int))
+                 + sizeof(struct bucket_queue_t) + 64 * (3 * sizeof(int) + sizeof(long long)), stats.live_bytes);
+    ASSERT_EQUAL(stats.live_bytes, stats.peak_bytes);
+
+    empty_queue(&head);
+    destroy_node_pool(pool);
+    destroy_heap_queue(heap);
+    destroy_bucket_queue(bucket);
+
+    queue_alloc_stats(&stats);
+    ASSERT_EQUAL(before.live_bytes, stats.live_bytes);
+    ASSERT_EQUAL(stats.mallocs - before.mallocs, stats.frees - before.frees);
+}
+
+
+/******************************
+ *  SCHEDULER CONTEXT TEST    *
+ ******************************/
+
+// Threads, and simulations per thread, in the scheduler context test
+#define CONTEXT_THREADS 4
+#define CONTEXT_RUNS 3
+
+// Size of each simulated task set
+#define CONTEXT_TASKS 100
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds the simulations run by one thread of the scheduler context test
+//----------------------------------------------------------------------------------------------------------------------------------
+struct context_worker_t {
+    enum priority_engine_t engine;
+    int seed;
+
+    // Task sets as generated, and as scheduled by the thread
+    struct task_t generated[CONTEXT_RUNS][CONTEXT_TASKS];
+    struct task_t scheduled[CONTEXT_RUNS][CONTEXT_TASKS];
+
+    // Clock and completed tasks of each simulation
+    int runTime[CONTEXT_RUNS];
+    long long completed[CONTEXT_RUNS];
+
+    // Summaries written to the thread's trace stream
+    int traced;
+};
+
+
+///-------------------------------------------------
+/// @brief  Runs the simulations of one thread on
+///         its own scheduler context
+///
+/// @param[in] arg The context_worker_t to run
+///
+/// @return NULL
+///-------------------------------------------------
+static void* runContextWorker(void* arg)
+{
+    struct context_worker_t* worker = (struct context_worker_t*)arg;
+    struct generator_config_t config;
+    char line[TRACE_LINE_SIZE];
+
+    generator_default_config(&config, worker->seed);
+    config.priority_levels = 16;
+
+    // Each context traces the summaries into its
+    // own stream
+    FILE* out = tmpfile();
+    struct generator_t* generator = create_generator(&config);
+    struct priority_context_t* context = create_priority_context(worker->engine, 1, out);
+
+    if((out == NULL) || (generator == NULL) || (context == NULL))
+    {
+        destroy_priority_context(context);
+        destroy_generator(generator);
+
+        if(out != NULL)
+        {
+            fclose(out);
+        }
+
+        return NULL;
+    }
+
+    context->trace->level = TRACE_LEVEL_SUMMARY;
+
+    for(int run = 0; run < CONTEXT_RUNS; run++)
+    {
+        generate_tasks(generator, worker->generated[run], CONTEXT_TASKS);
+        memcpy(worker->scheduled[run], worker->generated[run], sizeof(worker->generated[run]));
+
+        priority_context_run(context, worker->scheduled[run], CONTEXT_TASKS);
+
+        worker->runTime[run] = context->run_time;
+        worker->completed[run] = context->stats.count;
+    }
+
+    destroy_priority_context(context);
+    destroy_generator(generator);
+
+    rewind(out);
+
+    while(fgets(line, sizeof(line), out) != NULL)
+    {
+        worker->traced += (strncmp(line, "Average Wait Time", 17) == 0);
+    }
+
+    fclose(out);
+
+    return NULL;
+}
+
+
+///-------------------------------------------------
+/// @brief  Process-wide trace settings the
+///         scheduler context test changes
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST_DATA(schedulerContext)
+{
+    int traceLevel;
+    enum trace_sink_t traceSink;
+};
+
+
+///-------------------------------------------------
+/// @brief  Setup the scheduler context test by
+///         saving the trace settings
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST_SETUP(schedulerContext)
+{
+    data->traceLevel = trace_default.level;
+    data->traceSink = trace_default.sink;
+}
+
+
+///-------------------------------------------------
+/// @brief  Restore the trace settings, whether or
+///         not the test passed
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST_TEARDOWN(schedulerContext)
+{
+    trace_set_sink(data->traceSink);
+    trace_set_level(data->traceLevel);
+}
+
+
+///-------------------------------------------------
+/// @brief  Validate that simulations on separate
+///         contexts run concurrently, match the
+///         context-free scheduler and keep their
+///         output out of the process-wide trace
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST2(schedulerContext, threads_process)
+{
+    static struct context_worker_t worker[CONTEXT_THREADS];
+    pthread_t thread[CONTEXT_THREADS];
+    char output[TRACE_BUFFER_SIZE];
+    enum priority_engine_t engine[] = {PRIORITY_ENGINE_LIST, PRIORITY_ENGINE_HEAP, PRIORITY_ENGINE_BITMAP, PRIORITY_ENGINE_EVENT};
+
+    memset(worker, 0, sizeof(worker));
+
+    // Anything written to the process-wide trace
+    // stays in the ring
+    trace_set_sink(TRACE_SINK_RING);
+
+    for(int i = 0; i < CONTEXT_THREADS; i++)
+    {
+        worker[i].engine = engine[i % 4];
+        worker[i].seed = 11 + i;
+        ASSERT_EQUAL(0, pthread_create(&thread[i], NULL, runContextWorker, &worker[i]));
+    }
+
+    for(int i = 0; i < CONTEXT_THREADS; i++)
+    {
+        pthread_join(thread[i], NULL);
+    }
+
+    ASSERT_EQUAL(0, trace_snapshot(output, sizeof(output)));
+
+    // Replay every task set on the context-free
+    // scheduler
+    trace_set_level(TRACE_LEVEL_OFF);
+
+    for(int i = 0; i < CONTEXT_THREADS; i++)
+    {
+        for(int run = 0; run < CONTEXT_RUNS; run++)
+        {
+            struct task_t* expected = worker[i].generated[run];
+            struct task_t* actual = worker[i].scheduled[run];
+            int work = 0;
+
+            priority_schedule_engine(expected, CONTEXT_TASKS, worker[i].engine);
+
+            for(int j = 0; j < CONTEXT_TASKS; j++)
+            {
+                ASSERT_EQUAL(expected[j].process_id, actual[j].process_id);
+                ASSERT_EQUAL(expected[j].waiting_time, actual[j].waiting_time);
+                ASSERT_EQUAL(expected[j].turnaround_time, actual[j].turnaround_time);
+                ASSERT_EQUAL(expected[j].priority, actual[j].priority);
+                work += expected[j].execution_time;
+            }
+
+            ASSERT_EQUAL(work, worker[i].runTime[run]);
+            ASSERT_EQUAL(CONTEXT_TASKS, worker[i].completed[run]);
+        }
+
+        // Release builds compile every trace out
+#if TRACE_COMPILE_LEVEL >= TRACE_LEVEL_SUMMARY
+        ASSERT_EQUAL(CONTEXT_RUNS, worker[i].traced);
+#endif
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Validate that a longer quantum gives
+///         the same schedule on the list, heap and
+///         event engines (aged priorities leave the
+///         bitmap engine's levels)
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(schedulerContext, quantum_process)
+{
+    struct generator_config_t config;
+    struct task_t generated[CONTEXT_TASKS];
+    struct task_t expected[CONTEXT_TASKS];
+    struct task_t actual[CONTEXT_TASKS];
+    enum priority_engine_t engine[] = {PRIORITY_ENGINE_HEAP, PRIORITY_ENGINE_EVENT};
+
+    generator_default_config(&config, 5);
+    config.priority_levels = 16;
+
+    struct generator_t* generator = create_generator(&config);
+    struct priority_context_t* list = create_priority_context(PRIORITY_ENGINE_LIST, 3, NULL);
+
+    ASSERT_NOT_NULL(generator);
+    ASSERT_NOT_NULL(list);
+    ASSERT_NULL(create_priority_context(PRIORITY_ENGINE_LIST, 0, NULL));
+
+    generate_tasks(generator, generated, CONTEXT_TASKS);
+    memcpy(expected, generated, sizeof(generated));
+    priority_context_run(list, expected, CONTEXT_TASKS);
+
+    for(int i = 0; i < 2; i++)
+    {
+        struct priority_context_t* context = create_priority_context(engine[i], 3, NULL);
+
+        ASSERT_NOT_NULL(context);
+
+        memcpy(actual, generated, sizeof(generated));
+        priority_context_run(context, actual, CONTEXT_TASKS);
+
+        for(int j = 0; j < CONTEXT_TASKS; j++)
+        {
+            ASSERT_EQUAL(expected[j].waiting_time, actual[j].waiting_time);
+            ASSERT_EQUAL(expected[j].turnaround_time, actual[j].turnaround_time);
+            ASSERT_EQUAL(expected[j].priority, actual[j].priority);
+        }
+
+        ASSERT_EQUAL(list->run_time, context->run_time);
+        destroy_priority_context(context);
+    }
+
+    destroy_priority_context(list);
+    destroy_generator(generator);
+}
+
+
+///-------------------------------------------------
+/// @brief  Validate that a context records its
+///         dispatches into a log it owns, and only
+///         its own
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(schedulerContext, record_process)
+{
+    struct task_t task[3];
+    int execution[] = {3, 1, 2};
+    int priority[] = {1, 3, 2};
+    struct priority_context_t* context = create_priority_context(PRIORITY_ENGINE_HEAP, 1, NULL);
+
+    ASSERT_NOT_NULL(context);
+
+    struct dispatch_log_t* log = priority_context_record(context, 16);
+
+    ASSERT_NOT_NULL(log);
+    ASSERT_TRUE(context->log == log);
+    ASSERT_NULL(dispatch_log_active());
+
+    init(task, execution, priority, 3);
+    priority_context_run(context, task, 3);
+
+    // One quantum per dispatch, back to back
+    ASSERT_EQUAL(6, log->size);
+    ASSERT_EQUAL(0, log->dropped);
+
+    for(int i = 0; i < 6; i++)
+    {
+        ASSERT_EQUAL(i, log->records[i].time);
+        ASSERT_EQUAL(1, log->records[i].slice);
+    }
+
+    // The log goes with the context
+    destroy_priority_context(context);
+}
+
+
+///-------------------------------------------------
+/// @brief  Validate that every engine runs an
+///         empty workload without a trace or a
+///         dispatch
+///
+/// @retval  None
+///-------------------------------------------------
+CTEST(schedulerContext, emptyWorkload_process)
+{
+    struct task_t task[1];
+    enum priority_engine_t engine[] = {PRIORITY_ENGINE_LIST, PRIORITY_ENGINE_HEAP, PRIORITY_ENGINE_BITMAP, PRIORITY_ENGINE_EVENT};
+    FILE* out = tmpfile();
+
+    ASSERT_NOT_NULL(out);
+
+    for(int i = 0; i < 4; i++)
+    {
+        struct priority_context_t* context = create_priority_context(engine[i], 1, out);
+
+        ASSERT_NOT_NULL(context);
+        ASSERT_NOT_NULL(priority_context_record(context, 4));
+
+        priority_context_run(context, task, 0);
+
+        ASSERT_EQUAL(0, context->run_time);
+        ASSERT_EQUAL(0, context->stats.count);
+        ASSERT_EQUAL(0, context->log->size);
+        destroy_priority_context(context);
+    }
+
+    // No averages are traced when no task ran
+    ASSERT_EQUAL(0, ftell(out));
+    fclose(out);
+}
@@ -1,8 +1,30 @@
 #include "queue.h"
+#include <stddef.h>
 
 
-static int isSentinel(struct node_t* head);
+static struct queue_t* queueFromHead(struct node_t* head);
+static struct node_t* allocNode(struct node_pool_t* pool, struct task_t* task);
+static void releaseNode(struct node_pool_t* pool, struct node_t* node);
+static struct task_link_t* splitRun(struct task_link_t* run, int length);
+static void mergeRuns(struct task_link_t* left, struct task_link_t* right, int (*compare)(struct task_t* taskA, struct task_t* taskB),
+                      struct task_link_t** head, struct task_link_t** tail);
 static int isInvalidNode(struct node_t* node, const char* caller);
+static int isInvalidHead(struct node_t* head, const char* caller);
+static int isHigherPriority(struct heap_entry_t* entryA, struct heap_entry_t* entryB);
+static void heapSwap(struct heap_queue_t* heap, int slotA, int slotB);
+static void heapSiftUp(struct heap_queue_t* heap, int slot);
+static void heapSiftDown(struct heap_queue_t* heap, int slot);
+static void bucketLinkBack(struct bucket_queue_t* bucket, int index, int level);
+static void bucketLinkFront(struct bucket_queue_t* bucket, int index, int level);
+static void bucketUnlink(struct bucket_queue_t* bucket, int index);
+static void* trackedMalloc(size_t size, int nodes);
+static void trackedFree(void* pointer, size_t size, int nodes);
+static void raisePeak(long long* peak, long long live);
+
+// Allocation counters (see queue_alloc_enable_tracking()), updated atomically so queues can live on
+// several threads
+static int allocTracking = 0;
+static struct queue_alloc_stats_t allocStats;
 
 
 ///-------------------------------------------------
@@ -24,57 +46,62 @@ struct node_t* create_queue(struct task_t* task, int size)
         return NULL;
     }
 
-    // Create the sentinel node at the base of the queue
-    struct node_t* sentinel = create_new_node(NULL);
+    struct queue_t* queue = create_task_queue(task, size, NULL);
 
-    // Verify that malloc didn't fail
-    if(isInvalidNode(sentinel, __func__))
-    {
-        return NULL;
-    }
+    return (queue != NULL) ? &(queue->sentinel) : NULL;
+}
 
-    struct node_t* currentNode = sentinel;
 
-    // Create and link nodes together to form the queue
-    // NOTE: The first "true" node in the queue is linked to the sentinel
-    for(int i = 0; i < size; i++)
+///-------------------------------------------------
+/// @brief  Given an array of tasks, construct a
+///         singly-linked circular task queue whose
+///         nodes come from a node pool
+///
+/// @param[in] task Array of tasks to create task
+///                 nodes from
+/// @param[in] size The number of tasks nodes to
+///                 create
+/// @param[in] pool The pool to take nodes from
+///
+/// @return The sentinel node of the queue
+///-------------------------------------------------
+struct node_t* create_queue_from_pool(struct task_t* task, int size, struct node_pool_t* pool)
+{
+    // Validate parameters
+    if((task == NULL) || (size < 1) || (pool == NULL))
     {
-        // Create a new node
-        currentNode->next = create_new_node(&(task[i]));
-
-        // Verify that malloc didn't fail
-        if(isInvalidNode(currentNode->next, __func__))
-        {
-            return NULL;
-        }
-
-        // Traverse to next node
-        currentNode = currentNode->next;
-
-        // Check if this is the last node
-        if(i == (size - 1))
-        {
-            // Complete circular queue by linking
-            // last node to the sentinel
-            currentNode->next = sentinel;
-        }
+        return NULL;
     }
 
-    return sentinel;
+    struct queue_t* queue = create_task_queue(task, size, pool);
+
+    return (queue != NULL) ? &(queue->sentinel) : NULL;
 }
 
 
 ///-------------------------------------------------
-/// @brief  Construct a new task node
+/// @brief  Construct a new task node, or the
+///         sentinel of an empty queue if there
+///         is no task
 ///
 /// @param[in] task Task to attach to a node
+///                 (NULL: sentinel)
 ///
 /// @return The newly created task node
 ///-------------------------------------------------
 struct node_t* create_new_node(struct task_t* task)
 {
+    // NOTE: A head node must be embedded in a
+    //       queue descriptor for push()/pop()
+    if(task == NULL)
+    {
+        struct queue_t* queue = create_task_queue(NULL, 0, NULL);
+
+        return (queue != NULL) ? &(queue->sentinel) : NULL;
+    }
+
     // Dynamically allocate memory for the new node
-    struct node_t* newNode = (struct node_t*)malloc(sizeof(struct node_t));
+    struct node_t* newNode = (struct node_t*)trackedMalloc(sizeof(struct node_t), 1);
     
     // Verify that malloc didn't fail
     if(isInvalidNode(newNode, __func__))
@@ -99,18 +126,13 @@ struct node_t* create_new_node(struct task_t* task)
 ///-------------------------------------------------
 struct task_t* peek(struct node_t** head)
 {
-    if(is_empty(head))
+    // Check if the queue is invalid
+    if(isInvalidHead(*head, __func__))
     {
         return NULL;
     }
 
-    // NOTE: The base of the queue is a sentinel
-    //       therefore the first task node is
-    //       linked to it
-    struct node_t* topNode = (*head)->next;
-
-    // Return the top-most task
-    return topNode->task;
+    return queue_peek(queueFromHead(*head));
 }
 
 
@@ -121,28 +143,34 @@ struct task_t* peek(struct node_t** head)
 ///-------------------------------------------------
 void pop(struct node_t** head)
 {
-    // Check if the queue is invalid or empty
-    if(isInvalidNode(*head, __func__) || is_empty(head))
+    // Check if the queue is invalid
+    if(isInvalidHead(*head, __func__))
     {
         return;
     }
 
-    struct node_t* sentinel = (*head);
-    struct node_t* nodeToPop = sentinel->next;
-    struct node_t* newTopNode = nodeToPop->next;
+    queue_pop(queueFromHead(*head));
+}
 
-    // Pop the top-most task node from the queue
-    sentinel->next = newTopNode;
-    free(nodeToPop);
 
-    // Check if the sentinel is pointing to itself
-    // NOTE: This would occur if only one task node is
-    //       in the queue when pop() is called
-    if(sentinel->next == sentinel)
+///-------------------------------------------------
+/// @brief  Pop the top-most task off a queue and
+///         return its node to the pool
+///
+/// @param[in] head The head of the queue
+/// @param[in] pool The pool the queue's nodes
+///                 came from
+///-------------------------------------------------
+void pop_pooled(struct node_t** head, struct node_pool_t* pool)
+{
+    // Check if the queue is invalid or wasn't
+    // created from this pool
+    if(isInvalidHead(*head, __func__) || (queueFromHead(*head)->pool != pool))
     {
-        // Update the sentinel to signify an empty queue
-        sentinel->next = NULL;
+        return;
     }
+
+    queue_pop(queueFromHead(*head));
 }
 
 
@@ -155,115 +183,1502 @@ void pop(struct node_t** head)
 void push(struct node_t** head, struct task_t* task)
 {
     // Validate parameters
-    if(isInvalidNode(*head, __func__) || (task == NULL))
+    if(isInvalidHead(*head, __func__) || (task == NULL))
+    {
+        return;
+    }
+
+    queue_push(queueFromHead(*head), task);
+}
+
+
+///-------------------------------------------------
+/// @brief  Push a new task onto a queue using a
+///         node from the pool
+///
+/// @param[in] head The head of the task queue
+/// @param[in] task The task to push onto the queue
+/// @param[in] pool The pool to take the node from
+///-------------------------------------------------
+void push_pooled(struct node_t** head, struct task_t* task, struct node_pool_t* pool)
+{
+    // Validate parameters
+    if(isInvalidHead(*head, __func__) || (task == NULL) || (queueFromHead(*head)->pool != pool))
+    {
+        return;
+    }
+
+    queue_push(queueFromHead(*head), task);
+}
+
+
+///-------------------------------------------------
+/// @brief  Check if the queue is empty
+///
+/// @param[in] head The head of the task queue
+///
+/// @return True/False
+///-------------------------------------------------
+int is_empty(struct node_t** head)
+{
+    return ((*head)->next == NULL);
+}
+
+
+///-------------------------------------------------
+/// @brief  Free every node in the queue along with
+///         the sentinel
+///
+/// @param[in] head The head of the queue to empty
+///-------------------------------------------------
+void empty_queue(struct node_t** head)
+{
+    // Check if queue is uninitialized or isn't
+    // the head of a queue
+    if((*head == NULL) || isInvalidHead(*head, __func__))
+    {
+        return;
+    }
+
+    destroy_task_queue(queueFromHead(*head));
+
+    *head = NULL;
+}
+
+
+///-------------------------------------------------
+/// @brief  Computes the factor the aging rules
+///         multiply a task's priority by
+///
+/// @param[in] task The task to age
+/// @param[in] time The current runtime of the
+///                 system
+///
+/// @return 1, 2, 4 or 8
+///-------------------------------------------------
+int aging_factor(const struct task_t* task, int time)
+{
+    int factor = 1;
+
+    if(task->execution_time == time)
+    {
+        factor = factor * 4;
+    }
+
+    if(task->left_to_execute == time)
+    {
+        factor = factor * 2;
+    }
+
+    return factor;
+}
+
+
+///-------------------------------------------------
+/// @brief  Apply the aging rules to every task in
+///         the queue
+///
+/// @param[in] head The head of the queue
+/// @param[in] time The current runtime of the
+///                 system
+///-------------------------------------------------
+void update_priority(struct node_t** head, int time)
+{
+    // Check if the queue is invalid or empty
+    if((head == NULL) || (*head == NULL) || is_empty(head))
     {
         return;
     }
 
     struct node_t* sentinel = *head;
 
-    // Check if the queue is empty
-    if(is_empty(&sentinel))
+    for(struct node_t* currentNode = sentinel->next; currentNode != sentinel; currentNode = currentNode->next)
     {
-        // Push the node onto the end of the queue
-        struct node_t* newNode = sentinel->next;
-        newNode = create_new_node(task);
+        struct task_t* currentTask = currentNode->task;
 
-        // Complete circular linkage
-        newNode->next = sentinel;
+        currentTask->priority = currentTask->priority * aging_factor(currentTask, time);
     }
-    else
+}
+
+
+///-------------------------------------------------
+/// @brief  Construct a queue descriptor holding
+///         the given tasks
+///
+/// @param[in] task Array of tasks to queue
+/// @param[in] size The number of tasks to queue
+/// @param[in] pool The pool to take nodes from
+///                 (NULL: malloc)
+///
+/// @return The queue descriptor
+///-------------------------------------------------
+struct queue_t* create_task_queue(struct task_t* task, int size, struct node_pool_t* pool)
+{
+    // Validate parameters
+    if(((task == NULL) && (size > 0)) || (size < 0))
+    {
+        return NULL;
+    }
+
+    struct queue_t* queue = (struct queue_t*)trackedMalloc(sizeof(struct queue_t), 0);
+
+    if(queue == NULL)
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't create queue!\n", __func__);
+        return NULL;
+    }
+
+    // The sentinel sits at the base of the queue
+    queue->sentinel.task = NULL;
+    queue->sentinel.next = NULL;
+    queue->tail = &(queue->sentinel);
+    queue->size = 0;
+    queue->pool = pool;
+
+    // Create and link nodes together to form the queue
+    // NOTE: The first "true" node in the queue is linked to the sentinel
+    for(int i = 0; i < size; i++)
     {
-        struct node_t* nextNode = sentinel->next;
-        struct node_t* currentNode;
+        queue_push(queue, &(task[i]));
 
-        // Traverse queue until you find the sentinel
-        while(!isSentinel(nextNode))
+        // Verify that the allocation didn't fail
+        if(queue->size != (i + 1))
         {
-            currentNode = nextNode;
-            nextNode = nextNode->next;
+            destroy_task_queue(queue);
+            return NULL;
         }
+    }
+
+    return queue;
+}
+
+
+///-------------------------------------------------
+/// @brief Returns the top-most task for the queue
+///
+/// @param[in] queue The queue
+/// 
+/// @return The top-most task
+///-------------------------------------------------
+struct task_t* queue_peek(struct queue_t* queue)
+{
+    if(queue_is_empty(queue))
+    {
+        return NULL;
+    }
+
+    // NOTE: The base of the queue is a sentinel
+    //       therefore the first task node is
+    //       linked to it
+    return queue->sentinel.next->task;
+}
+
+
+///-------------------------------------------------
+/// @brief  Pop the top-most task off the queue
+///
+/// @param[in] queue The queue
+///-------------------------------------------------
+void queue_pop(struct queue_t* queue)
+{
+    // Check if the queue is invalid or empty
+    if(queue_is_empty(queue))
+    {
+        return;
+    }
+
+    struct node_t* nodeToPop = queue->sentinel.next;
+
+    // Pop the top-most task node from the queue
+    queue->sentinel.next = nodeToPop->next;
+
+    // Check if the sentinel is pointing to itself
+    // NOTE: This would occur if only one task node is
+    //       in the queue when pop() is called
+    if(queue->sentinel.next == &(queue->sentinel))
+    {
+        // Update the sentinel to signify an empty queue
+        queue->sentinel.next = NULL;
+        queue->tail = &(queue->sentinel);
+    }
+
+    queue->size--;
+    releaseNode(queue->pool, nodeToPop);
+}
+
+
+///-------------------------------------------------
+/// @brief  Push a new task onto the end of the
+///         queue using the tail pointer
+///
+/// @param[in] queue The queue
+/// @param[in] task The task to push onto the queue
+///-------------------------------------------------
+void queue_push(struct queue_t* queue, struct task_t* task)
+{
+    // Validate parameters
+    if((queue == NULL) || (task == NULL))
+    {
+        return;
+    }
 
-        // Insert new node at the end of the task queue
-        struct node_t* newNode = create_new_node(task);
-        currentNode->next = newNode;
+    struct node_t* newNode = allocNode(queue->pool, task);
 
-        // Update the end of the queue to point back to
-        // the sentinel (completing circular linkage)
-        newNode->next = sentinel;
+    // Verify that the allocation didn't fail
+    if(isInvalidNode(newNode, __func__))
+    {
+        return;
     }
+
+    // Insert new node at the end of the task queue
+    // NOTE: The tail is the sentinel if the queue
+    //       is empty
+    queue->tail->next = newNode;
+    newNode->next = &(queue->sentinel);
+    queue->tail = newNode;
+    queue->size++;
+}
+
+
+///-------------------------------------------------
+/// @brief  Number of tasks in the queue
+///
+/// @param[in] queue The queue
+///
+/// @return The number of queued tasks
+///-------------------------------------------------
+int queue_size(struct queue_t* queue)
+{
+    return (queue != NULL) ? queue->size : 0;
 }
 
+
 ///-------------------------------------------------
 /// @brief  Check if the queue is empty
 ///
-/// @param[in] head The head of the task queue
+/// @param[in] queue The queue
 ///
 /// @return True/False
 ///-------------------------------------------------
-int is_empty(struct node_t** head)
+int queue_is_empty(struct queue_t* queue)
 {
-    return ((*head)->next == NULL);
+    return ((queue == NULL) || (queue->sentinel.next == NULL));
 }
 
 
 ///-------------------------------------------------
-/// @brief  Traverse the queue and free all memory
-///         aside from the sentinel
+/// @brief  Free every node in the queue and the
+///         queue descriptor itself
 ///
-/// @param[in] head The head of the queue to empty
+/// @param[in] queue The queue to free
 ///-------------------------------------------------
-void empty_queue(struct node_t** head)
+void destroy_task_queue(struct queue_t* queue)
 {
-    // Check if queue is empty or uninitialized
-    if(is_empty(head))
+    if(queue == NULL)
     {
         return;
     }
 
-    struct node_t* currentNode = *head;
-    struct node_t* nextNode;
-
-    // Traverse the queue and free each node
-    while(currentNode != NULL)
+    while(!queue_is_empty(queue))
     {
-        nextNode = currentNode->next;
-        free(currentNode);
-        currentNode = nextNode;
+        queue_pop(queue);
     }
 
-    *head = NULL;
+    trackedFree(queue, sizeof(struct queue_t), 0);
 }
 
 
 ///-------------------------------------------------
-/// @brief  Check if a node is the sentinel node
+/// @brief  Initialize an empty intrusive queue
 ///
-/// @param[in] node The node to check
+/// @param[in] list The intrusive queue
+///-------------------------------------------------
+void task_list_init(struct task_list_t* list)
+{
+    list->head = NULL;
+    list->tail = NULL;
+    list->size = 0;
+}
+
+
+///-------------------------------------------------
+/// @brief Returns the top-most task for the
+///        intrusive queue
 ///
-/// @return True/False
+/// @param[in] list The intrusive queue
+/// 
+/// @return The top-most task link
 ///-------------------------------------------------
-static int isSentinel(struct node_t* node)
+struct task_link_t* task_list_peek(struct task_list_t* list)
 {
-    return (node->task == NULL);
+    return list->head;
 }
 
 
 ///-------------------------------------------------
-/// @brief  Validates that a node was constructed
+/// @brief  Pop the top-most task off the intrusive
+///         queue
 ///
-/// @param[in] node The node to validate
-/// @param[in] caller Should always pass in __func__
+/// @param[in] list The intrusive queue
+///-------------------------------------------------
+void task_list_pop(struct task_list_t* list)
+{
+    if(task_list_is_empty(list))
+    {
+        return;
+    }
+
+    struct task_link_t* linkToPop = list->head;
+
+    list->head = linkToPop->next;
+    linkToPop->next = NULL;
+    list->size--;
+
+    if(list->head == NULL)
+    {
+        list->tail = NULL;
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Push a task onto the end of the
+///         intrusive queue
 ///
-/// @return 1: Invalid node; 0: Valid node
+/// @param[in] list The intrusive queue
+/// @param[in] link The task to push onto the queue
 ///-------------------------------------------------
-static int isInvalidNode(struct node_t* node, const char* caller)
+void task_list_push(struct task_list_t* list, struct task_link_t* link)
 {
-    if(node == NULL)
+    if(link == NULL)
     {
-        fprintf(stderr, "%s() ERROR: Couldn't create node!\n", caller);
-        return 1;
+        return;
     }
 
-    return 0;
+    link->next = NULL;
+
+    if(task_list_is_empty(list))
+    {
+        list->head = link;
+    }
+    else
+    {
+        list->tail->next = link;
+    }
+
+    list->tail = link;
+    list->size++;
+}
+
+
+///-------------------------------------------------
+/// @brief  Check if the intrusive queue is empty
+///
+/// @param[in] list The intrusive queue
+///
+/// @return True/False
+///-------------------------------------------------
+int task_list_is_empty(struct task_list_t* list)
+{
+    return (list->head == NULL);
+}
+
+
+///-------------------------------------------------
+/// @brief  Sort the intrusive queue with a stable
+///         bottom-up merge sort. Runs are relinked
+///         in place, so no memory is allocated.
+///
+/// @param[in] list The intrusive queue
+/// @param[in] compare Returns non-zero if taskA
+///                    must be queued after taskB
+///-------------------------------------------------
+void task_list_sort(struct task_list_t* list, int (*compare)(struct task_t* taskA, struct task_t* taskB))
+{
+    for(int width = 1; width < list->size; width *= 2)
+    {
+        struct task_link_t* remaining = list->head;
+        struct task_link_t* mergedHead = NULL;
+        struct task_link_t* mergedTail = NULL;
+
+        // Merge neighbouring runs of the current width
+        while(remaining != NULL)
+        {
+            struct task_link_t* left = remaining;
+            struct task_link_t* right = splitRun(left, width);
+            remaining = splitRun(right, width);
+
+            mergeRuns(left, right, compare, &mergedHead, &mergedTail);
+        }
+
+        list->head = mergedHead;
+        list->tail = mergedTail;
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Construct an empty node pool
+///
+/// @param[in] slabSize Number of nodes to allocate
+///                     each time the pool runs dry
+///
+/// @return The node pool
+///-------------------------------------------------
+struct node_pool_t* create_node_pool(int slabSize)
+{
+    // Validate parameters
+    if(slabSize < 1)
+    {
+        return NULL;
+    }
+
+    struct node_pool_t* pool = (struct node_pool_t*)trackedMalloc(sizeof(struct node_pool_t), 0);
+
+    if(pool == NULL)
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't create node pool!\n", __func__);
+        return NULL;
+    }
+
+    pool->slabs = NULL;
+    pool->freeList = NULL;
+    pool->slabSize = slabSize;
+    pool->slabUsed = 0;
+    pool->slabCount = 0;
+
+    return pool;
+}
+
+
+///-------------------------------------------------
+/// @brief  Take a node from the pool, recycling
+///         freed nodes before carving new ones
+///
+/// @param[in] pool The node pool
+/// @param[in] task Task to attach to the node
+///
+/// @return The node
+///-------------------------------------------------
+struct node_t* pool_alloc_node(struct node_pool_t* pool, struct task_t* task)
+{
+    if(pool == NULL)
+    {
+        return NULL;
+    }
+
+    struct node_t* newNode;
+
+    if(pool->freeList != NULL)
+    {
+        // Reuse the most recently freed node
+        newNode = pool->freeList;
+        pool->freeList = newNode->next;
+    }
+    else
+    {
+        // Allocate a new slab once the current one is used up
+        if((pool->slabs == NULL) || (pool->slabUsed == pool->slabSize))
+        {
+            struct node_slab_t* slab = (struct node_slab_t*)trackedMalloc(sizeof(struct node_slab_t) + (pool->slabSize * sizeof(struct node_t)), 0);
+
+            if(slab == NULL)
+            {
+                fprintf(stderr, "%s() ERROR: Couldn't create node slab!\n", __func__);
+                return NULL;
+            }
+
+            slab->next = pool->slabs;
+            pool->slabs = slab;
+            pool->slabUsed = 0;
+            pool->slabCount++;
+        }
+
+        newNode = &(pool->slabs->nodes[pool->slabUsed++]);
+    }
+
+    // Initialize node data members
+    newNode->task = task;
+    newNode->next = NULL;
+
+    return newNode;
+}
+
+
+///-------------------------------------------------
+/// @brief  Return a node to the pool
+///
+/// @param[in] pool The node pool
+/// @param[in] node The node to recycle
+///-------------------------------------------------
+void pool_free_node(struct node_pool_t* pool, struct node_t* node)
+{
+    if((pool == NULL) || (node == NULL))
+    {
+        return;
+    }
+
+    node->task = NULL;
+    node->next = pool->freeList;
+    pool->freeList = node;
+}
+
+
+///-------------------------------------------------
+/// @brief  Free every slab owned by the pool, then
+///         the pool itself
+///
+/// @param[in] pool The node pool to free
+///-------------------------------------------------
+void destroy_node_pool(struct node_pool_t* pool)
+{
+    if(pool == NULL)
+    {
+        return;
+    }
+
+    struct node_slab_t* slab = pool->slabs;
+
+    while(slab != NULL)
+    {
+        struct node_slab_t* nextSlab = slab->next;
+        trackedFree(slab, sizeof(struct node_slab_t) + (pool->slabSize * sizeof(struct node_t)), 0);
+        slab = nextSlab;
+    }
+
+    trackedFree(pool, sizeof(struct node_pool_t), 0);
+}
+
+
+///-------------------------------------------------
+/// @brief  Turn allocation tracking on for good
+///
+/// @return None
+///-------------------------------------------------
+void queue_alloc_enable_tracking(void)
+{
+    __atomic_store_n(&allocTracking, 1, __ATOMIC_RELAXED);
+}
+
+
+///-------------------------------------------------
+/// @brief  Read the allocation counters
+///
+/// @param[out] stats The counters
+///
+/// @return None
+///-------------------------------------------------
+void queue_alloc_stats(struct queue_alloc_stats_t* stats)
+{
+    stats->live_nodes = __atomic_load_n(&allocStats.live_nodes, __ATOMIC_RELAXED);
+    stats->peak_nodes = __atomic_load_n(&allocStats.peak_nodes, __ATOMIC_RELAXED);
+    stats->live_bytes = __atomic_load_n(&allocStats.live_bytes, __ATOMIC_RELAXED);
+    stats->peak_bytes = __atomic_load_n(&allocStats.peak_bytes, __ATOMIC_RELAXED);
+    stats->mallocs = __atomic_load_n(&allocStats.mallocs, __ATOMIC_RELAXED);
+    stats->frees = __atomic_load_n(&allocStats.frees, __ATOMIC_RELAXED);
+}
+
+
+///-------------------------------------------------
+/// @brief  Restart the peaks from the live counts
+///
+/// @return None
+///-------------------------------------------------
+void queue_alloc_reset_peak(void)
+{
+    __atomic_store_n(&allocStats.peak_nodes, __atomic_load_n(&allocStats.live_nodes, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+    __atomic_store_n(&allocStats.peak_bytes, __atomic_load_n(&allocStats.live_bytes, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+}
+
+
+///-------------------------------------------------
+/// @brief  Given an array of tasks, construct a
+///         binary max-heap task queue
+///
+/// @param[in] task Array of tasks to queue
+/// @param[in] size The number of tasks to queue
+///
+/// @return The heap queue
+///-------------------------------------------------
+struct heap_queue_t* create_heap_queue(struct task_t* task, int size)
+{
+    // Validate parameters
+    if((task == NULL) || (size < 1))
+    {
+        return NULL;
+    }
+
+    struct heap_queue_t* heap = (struct heap_queue_t*)trackedMalloc(sizeof(struct heap_queue_t), 0);
+
+    if(heap == NULL)
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't create heap!\n", __func__);
+        return NULL;
+    }
+
+    // Set before anything can fail, destroy_heap_queue()
+    // frees by it
+    heap->capacity = size;
+    heap->entries = (struct heap_entry_t*)trackedMalloc(size * sizeof(struct heap_entry_t), 0);
+    heap->position = (int*)trackedMalloc(size * sizeof(int), 0);
+
+    // Verify that malloc didn't fail
+    if((heap->entries == NULL) || (heap->position == NULL))
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't create heap!\n", __func__);
+        destroy_heap_queue(heap);
+        return NULL;
+    }
+
+    heap->base = task;
+    heap->size = size;
+    heap->backOrder = size;
+    heap->frontOrder = 0;
+
+    // Queue every task, breaking ties by array index
+    for(int i = 0; i < size; i++)
+    {
+        heap->entries[i].task = &(task[i]);
+        heap->entries[i].priority = task[i].priority;
+        heap->entries[i].order = i;
+        heap->position[i] = i;
+    }
+
+    // Heapify bottom-up
+    for(int slot = (size / 2) - 1; slot >= 0; slot--)
+    {
+        heapSiftDown(heap, slot);
+    }
+
+    return heap;
+}
+
+
+///-------------------------------------------------
+/// @brief Returns the highest priority task in
+///        the heap queue
+///
+/// @param[in] heap The heap queue
+/// 
+/// @return The highest priority task
+///-------------------------------------------------
+struct task_t* heap_peek(struct heap_queue_t* heap)
+{
+    if(heap_is_empty(heap))
+    {
+        return NULL;
+    }
+
+    return heap->entries[0].task;
+}
+
+
+///-------------------------------------------------
+/// @brief  Pop the highest priority task off the
+///         heap queue
+///
+/// @param[in] heap The heap queue
+///-------------------------------------------------
+void heap_pop(struct heap_queue_t* heap)
+{
+    if(heap_is_empty(heap))
+    {
+        return;
+    }
+
+    struct task_t* poppedTask = heap->entries[0].task;
+
+    // Move the last entry to the top and restore
+    // the heap order
+    heap->size--;
+    heapSwap(heap, 0, heap->size);
+    heap->position[poppedTask - heap->base] = -1;
+
+    if(!heap_is_empty(heap))
+    {
+        heapSiftDown(heap, 0);
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Push a task onto the heap queue
+///
+/// @param[in] heap The heap queue
+/// @param[in] task The task to push onto the heap
+///-------------------------------------------------
+void heap_push(struct heap_queue_t* heap, struct task_t* task)
+{
+    // Validate parameters
+    if((heap == NULL) || (task == NULL) || (heap->size >= heap->capacity))
+    {
+        return;
+    }
+
+    int index = task - heap->base;
+
+    // Only tasks from the heap's task array which
+    // aren't already queued can be pushed
+    if((index < 0) || (index >= heap->capacity) || (heap->position[index] != -1))
+    {
+        fprintf(stderr, "%s() ERROR: Task[%d] can't be queued!\n", __func__, task->process_id);
+        return;
+    }
+
+    // Queue the task behind its equal priority peers
+    int slot = heap->size++;
+    heap->entries[slot].task = task;
+    heap->entries[slot].priority = task->priority;
+    heap->entries[slot].order = heap->backOrder++;
+    heap->position[index] = slot;
+
+    heapSiftUp(heap, slot);
+}
+
+
+///-------------------------------------------------
+/// @brief  Restore the heap order after a queued
+///         task's priority changed
+///
+/// @param[in] heap The heap queue
+/// @param[in] task The task whose priority changed
+///-------------------------------------------------
+void heap_reprioritize(struct heap_queue_t* heap, struct task_t* task)
+{
+    // Validate parameters
+    if((heap == NULL) || (task == NULL))
+    {
+        return;
+    }
+
+    int index = task - heap->base;
+
+    if((index < 0) || (index >= heap->capacity) || (heap->position[index] == -1))
+    {
+        return;
+    }
+
+    int slot = heap->position[index];
+    struct heap_entry_t* entry = &(heap->entries[slot]);
+
+    if(task->priority > entry->priority)
+    {
+        // Priority rose: queue behind peers at the new priority
+        entry->priority = task->priority;
+        entry->order = heap->backOrder++;
+        heapSiftUp(heap, slot);
+    }
+    else if(task->priority < entry->priority)
+    {
+        // Priority fell: queue ahead of peers at the new priority
+        entry->priority = task->priority;
+        entry->order = --heap->frontOrder;
+        heapSiftDown(heap, slot);
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Check if the heap queue is empty
+///
+/// @param[in] heap The heap queue
+///
+/// @return True/False
+///-------------------------------------------------
+int heap_is_empty(struct heap_queue_t* heap)
+{
+    return ((heap == NULL) || (heap->size == 0));
+}
+
+
+///-------------------------------------------------
+/// @brief  Free all memory owned by the heap queue
+///
+/// @param[in] heap The heap queue to free
+///-------------------------------------------------
+void destroy_heap_queue(struct heap_queue_t* heap)
+{
+    if(heap == NULL)
+    {
+        return;
+    }
+
+    trackedFree(heap->entries, heap->capacity * sizeof(struct heap_entry_t), 0);
+    trackedFree(heap->position, heap->capacity * sizeof(int), 0);
+    trackedFree(heap, sizeof(struct heap_queue_t), 0);
+}
+
+
+///-------------------------------------------------
+/// @brief  Map a priority onto a bucket level
+///
+/// @param[in] priority The task priority
+///
+/// @return The clamped bucket level
+///-------------------------------------------------
+int priority_level(int priority)
+{
+    if(priority < 0)
+    {
+        return 0;
+    }
+
+    if(priority >= PRIORITY_LEVELS)
+    {
+        return PRIORITY_LEVELS - 1;
+    }
+
+    return priority;
+}
+
+
+///-------------------------------------------------
+/// @brief  Given an array of tasks, construct a
+///         bucket queue with one FIFO per level
+///
+/// @param[in] task Array of tasks to queue
+/// @param[in] size The number of tasks to queue
+///
+/// @return The bucket queue
+///-------------------------------------------------
+struct bucket_queue_t* create_bucket_queue(struct task_t* task, int size)
+{
+    // Validate parameters
+    if((task == NULL) || (size < 1))
+    {
+        return NULL;
+    }
+
+    struct bucket_queue_t* bucket = (struct bucket_queue_t*)trackedMalloc(sizeof(struct bucket_queue_t), 0);
+
+    if(bucket == NULL)
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't create bucket queue!\n", __func__);
+        return NULL;
+    }
+
+    // Set before anything can fail, destroy_bucket_queue()
+    // frees by it
+    bucket->capacity = size;
+    bucket->next = (int*)trackedMalloc(size * sizeof(int), 0);
+    bucket->prev = (int*)trackedMalloc(size * sizeof(int), 0);
+    bucket->level = (int*)trackedMalloc(size * sizeof(int), 0);
+    bucket->order = (long long*)trackedMalloc(size * sizeof(long long), 0);
+
+    // Verify that malloc didn't fail
+    if((bucket->next == NULL) || (bucket->prev == NULL) || (bucket->level == NULL) || (bucket->order == NULL))
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't create bucket queue!\n", __func__);
+        destroy_bucket_queue(bucket);
+        return NULL;
+    }
+
+    bucket->readyMask = 0;
+    bucket->base = task;
+    bucket->size = 0;
+    bucket->frontOrder = -1;
+    bucket->backOrder = 0;
+
+    for(int level = 0; level < PRIORITY_LEVELS; level++)
+    {
+        bucket->head[level] = -1;
+        bucket->tail[level] = -1;
+    }
+
+    for(int i = 0; i < size; i++)
+    {
+        bucket->level[i] = -1;
+        bucket_push(bucket, &(task[i]));
+    }
+
+    return bucket;
+}
+
+
+///-------------------------------------------------
+/// @brief Returns the first task of the highest
+///        ready level
+///
+/// @param[in] bucket The bucket queue
+/// 
+/// @return The highest priority task
+///-------------------------------------------------
+struct task_t* bucket_peek(struct bucket_queue_t* bucket)
+{
+    if(bucket_is_empty(bucket))
+    {
+        return NULL;
+    }
+
+    // The highest set bit is the highest ready level
+    int level = 63 - __builtin_clzll(bucket->readyMask);
+
+    return &(bucket->base[bucket->head[level]]);
+}
+
+
+///-------------------------------------------------
+/// @brief  Pop the first task of the highest ready
+///         level
+///
+/// @param[in] bucket The bucket queue
+///-------------------------------------------------
+void bucket_pop(struct bucket_queue_t* bucket)
+{
+    if(bucket_is_empty(bucket))
+    {
+        return;
+    }
+
+    int level = 63 - __builtin_clzll(bucket->readyMask);
+
+    bucketUnlink(bucket, bucket->head[level]);
+}
+
+
+///-------------------------------------------------
+/// @brief  Push a task onto the back of its level
+///
+/// @param[in] bucket The bucket queue
+/// @param[in] task The task to push onto the queue
+///-------------------------------------------------
+void bucket_push(struct bucket_queue_t* bucket, struct task_t* task)
+{
+    // Validate parameters
+    if((bucket == NULL) || (task == NULL))
+    {
+        return;
+    }
+
+    int index = task - bucket->base;
+
+    // Only tasks from the bucket's task array which
+    // aren't already queued can be pushed
+    if((index < 0) || (index >= bucket->capacity) || (bucket->level[index] != -1))
+    {
+        fprintf(stderr, "%s() ERROR: Task[%d] can't be queued!\n", __func__, task->process_id);
+        return;
+    }
+
+    bucketLinkBack(bucket, index, priority_level(task->priority));
+}
+
+
+///-------------------------------------------------
+/// @brief  Move a queued task to the level of its
+///         new priority
+///
+/// @param[in] bucket The bucket queue
+/// @param[in] task The task whose priority changed
+///-------------------------------------------------
+void bucket_reprioritize(struct bucket_queue_t* bucket, struct task_t* task)
+{
+    // Validate parameters
+    if((bucket == NULL) || (task == NULL))
+    {
+        return;
+    }
+
+    int index = task - bucket->base;
+
+    if((index < 0) || (index >= bucket->capacity) || (bucket->level[index] == -1))
+    {
+        return;
+    }
+
+    int oldLevel = bucket->level[index];
+    int newLevel = priority_level(task->priority);
+
+    if(newLevel > oldLevel)
+    {
+        // Moved up: queue behind peers at the new level
+        bucketUnlink(bucket, index);
+        bucketLinkBack(bucket, index, newLevel);
+    }
+    else if(newLevel < oldLevel)
+    {
+        // Moved down: queue ahead of peers at the new level
+        bucketUnlink(bucket, index);
+        bucketLinkFront(bucket, index, newLevel);
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Check if the bucket queue is empty
+///
+/// @param[in] bucket The bucket queue
+///
+/// @return True/False
+///-------------------------------------------------
+int bucket_is_empty(struct bucket_queue_t* bucket)
+{
+    return ((bucket == NULL) || (bucket->readyMask == 0));
+}
+
+
+///-------------------------------------------------
+/// @brief  Free all memory owned by the bucket
+///         queue
+///
+/// @param[in] bucket The bucket queue to free
+///-------------------------------------------------
+void destroy_bucket_queue(struct bucket_queue_t* bucket)
+{
+    if(bucket == NULL)
+    {
+        return;
+    }
+
+    trackedFree(bucket->next, bucket->capacity * sizeof(int), 0);
+    trackedFree(bucket->prev, bucket->capacity * sizeof(int), 0);
+    trackedFree(bucket->level, bucket->capacity * sizeof(int), 0);
+    trackedFree(bucket->order, bucket->capacity * sizeof(long long), 0);
+    trackedFree(bucket, sizeof(struct bucket_queue_t), 0);
+}
+
+
+///-------------------------------------------------
+/// @brief  Map the head of a queue back to its
+///         descriptor
+///
+/// @param[in] head The sentinel of the queue
+///
+/// @return The queue descriptor
+///-------------------------------------------------
+static struct queue_t* queueFromHead(struct node_t* head)
+{
+    // NOTE: The sentinel is embedded in the
+    //       descriptor
+    return (struct queue_t*)((char*)head - offsetof(struct queue_t, sentinel));
+}
+
+
+///-------------------------------------------------
+/// @brief  Construct a node from the pool, or with
+///         malloc if there is no pool
+///
+/// @param[in] pool The node pool (may be NULL)
+/// @param[in] task Task to attach to the node
+///
+/// @return The newly created task node
+///-------------------------------------------------
+static struct node_t* allocNode(struct node_pool_t* pool, struct task_t* task)
+{
+    return (pool != NULL) ? pool_alloc_node(pool, task) : create_new_node(task);
+}
+
+
+///-------------------------------------------------
+/// @brief  Return a node to the pool, or free it
+///         if there is no pool
+///
+/// @param[in] pool The node pool (may be NULL)
+/// @param[in] node The node to release
+///-------------------------------------------------
+static void releaseNode(struct node_pool_t* pool, struct node_t* node)
+{
+    if(pool != NULL)
+    {
+        pool_free_node(pool, node);
+    }
+    else
+    {
+        trackedFree(node, sizeof(struct node_t), 1);
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Cut a run of tasks off the front of a
+///         chain of links
+///
+/// @param[in] run First link of the run
+/// @param[in] length Number of links in the run
+///
+/// @return The first link after the run
+///-------------------------------------------------
+static struct task_link_t* splitRun(struct task_link_t* run, int length)
+{
+    for(int i = 1; (run != NULL) && (i < length); i++)
+    {
+        run = run->next;
+    }
+
+    if(run == NULL)
+    {
+        return NULL;
+    }
+
+    struct task_link_t* rest = run->next;
+    run->next = NULL;
+
+    return rest;
+}
+
+
+///-------------------------------------------------
+/// @brief  Merge two sorted runs onto the end of
+///         an output chain
+///
+/// @param[in] left First run (wins ties)
+/// @param[in] right Second run
+/// @param[in] compare Returns non-zero if taskA
+///                    must be queued after taskB
+/// @param[in,out] head First link of the output
+/// @param[in,out] tail Last link of the output
+///-------------------------------------------------
+static void mergeRuns(struct task_link_t* left, struct task_link_t* right, int (*compare)(struct task_t* taskA, struct task_t* taskB),
+                      struct task_link_t** head, struct task_link_t** tail)
+{
+    while((left != NULL) || (right != NULL))
+    {
+        struct task_link_t* nextLink;
+
+        // Take from the left run on ties to stay stable
+        if((right == NULL) || ((left != NULL) && !compare(&(left->task), &(right->task))))
+        {
+            nextLink = left;
+            left = left->next;
+        }
+        else
+        {
+            nextLink = right;
+            right = right->next;
+        }
+
+        if(*head == NULL)
+        {
+            *head = nextLink;
+        }
+        else
+        {
+            (*tail)->next = nextLink;
+        }
+
+        *tail = nextLink;
+    }
+
+    if(*tail != NULL)
+    {
+        (*tail)->next = NULL;
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Validates that a node was constructed
+///
+/// @param[in] node The node to validate
+/// @param[in] caller Should always pass in __func__
+///
+/// @return 1: Invalid node; 0: Valid node
+///-------------------------------------------------
+static int isInvalidNode(struct node_t* node, const char* caller)
+{
+    if(node == NULL)
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't create node!\n", caller);
+        return 1;
+    }
+
+    return 0;
+}
+
+
+///-------------------------------------------------
+/// @brief  Validates that a node is the sentinel
+///         of a queue
+///
+/// @param[in] head The node to validate
+/// @param[in] caller Should always pass in __func__
+///
+/// @return 1: Invalid head; 0: Valid head
+///-------------------------------------------------
+static int isInvalidHead(struct node_t* head, const char* caller)
+{
+    if(head == NULL)
+    {
+        fprintf(stderr, "%s() ERROR: Queue is uninitialized!\n", caller);
+        return 1;
+    }
+
+    // NOTE: Only sentinels carry no task, and
+    //       every sentinel is embedded in a queue
+    //       descriptor
+    if(head->task != NULL)
+    {
+        fprintf(stderr, "%s() ERROR: Not the head of a queue!\n", caller);
+        return 1;
+    }
+
+    return 0;
+}
+
+
+///-------------------------------------------------
+/// @brief  Compare two heap entries
+///
+/// @param[in] entryA First entry
+/// @param[in] entryB Second entry
+///
+/// @return 1: entryA is dispatched before entryB;
+///         0: otherwise
+///-------------------------------------------------
+static int isHigherPriority(struct heap_entry_t* entryA, struct heap_entry_t* entryB)
+{
+    if(entryA->priority != entryB->priority)
+    {
+        return (entryA->priority > entryB->priority);
+    }
+
+    return (entryA->order < entryB->order);
+}
+
+
+///-------------------------------------------------
+/// @brief  Swap two heap slots and keep the task
+///         position index up to date
+///
+/// @param[in] heap The heap queue
+/// @param[in] slotA First slot
+/// @param[in] slotB Second slot
+///-------------------------------------------------
+static void heapSwap(struct heap_queue_t* heap, int slotA, int slotB)
+{
+    struct heap_entry_t temp = heap->entries[slotA];
+    heap->entries[slotA] = heap->entries[slotB];
+    heap->entries[slotB] = temp;
+
+    heap->position[heap->entries[slotA].task - heap->base] = slotA;
+    heap->position[heap->entries[slotB].task - heap->base] = slotB;
+}
+
+
+///-------------------------------------------------
+/// @brief  Move an entry towards the top of the
+///         heap until its parent outranks it
+///
+/// @param[in] heap The heap queue
+/// @param[in] slot The slot of the entry to move
+///-------------------------------------------------
+static void heapSiftUp(struct heap_queue_t* heap, int slot)
+{
+    while(slot > 0)
+    {
+        int parent = (slot - 1) / 2;
+
+        if(!isHigherPriority(&(heap->entries[slot]), &(heap->entries[parent])))
+        {
+            break;
+        }
+
+        heapSwap(heap, slot, parent);
+        slot = parent;
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Move an entry towards the bottom of the
+///         heap until it outranks both children
+///
+/// @param[in] heap The heap queue
+/// @param[in] slot The slot of the entry to move
+///-------------------------------------------------
+static void heapSiftDown(struct heap_queue_t* heap, int slot)
+{
+    while(1)
+    {
+        int left = (2 * slot) + 1;
+        int right = left + 1;
+        int highest = slot;
+
+        if((left < heap->size) && isHigherPriority(&(heap->entries[left]), &(heap->entries[highest])))
+        {
+            highest = left;
+        }
+
+        if((right < heap->size) && isHigherPriority(&(heap->entries[right]), &(heap->entries[highest])))
+        {
+            highest = right;
+        }
+
+        if(highest == slot)
+        {
+            break;
+        }
+
+        heapSwap(heap, slot, highest);
+        slot = highest;
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Link a task onto the back of a level
+///
+/// @param[in] bucket The bucket queue
+/// @param[in] index Index of the task
+/// @param[in] level Level to queue the task at
+///-------------------------------------------------
+static void bucketLinkBack(struct bucket_queue_t* bucket, int index, int level)
+{
+    bucket->next[index] = -1;
+    bucket->prev[index] = bucket->tail[level];
+
+    if(bucket->tail[level] == -1)
+    {
+        bucket->head[level] = index;
+    }
+    else
+    {
+        bucket->next[bucket->tail[level]] = index;
+    }
+
+    bucket->tail[level] = index;
+    bucket->level[index] = level;
+    bucket->order[index] = bucket->backOrder++;
+    bucket->readyMask |= (1ULL << level);
+    bucket->size++;
+}
+
+
+///-------------------------------------------------
+/// @brief  Link a task onto the front of a level
+///
+/// @param[in] bucket The bucket queue
+/// @param[in] index Index of the task
+/// @param[in] level Level to queue the task at
+///-------------------------------------------------
+static void bucketLinkFront(struct bucket_queue_t* bucket, int index, int level)
+{
+    bucket->prev[index] = -1;
+    bucket->next[index] = bucket->head[level];
+
+    if(bucket->head[level] == -1)
+    {
+        bucket->tail[level] = index;
+    }
+    else
+    {
+        bucket->prev[bucket->head[level]] = index;
+    }
+
+    bucket->head[level] = index;
+    bucket->level[index] = level;
+    bucket->order[index] = bucket->frontOrder--;
+    bucket->readyMask |= (1ULL << level);
+    bucket->size++;
+}
+
+
+///-------------------------------------------------
+/// @brief  Unlink a queued task from its level,
+///         clearing the level's ready bit if it
+///         becomes empty
+///
+/// @param[in] bucket The bucket queue
+/// @param[in] index Index of the task
+///-------------------------------------------------
+static void bucketUnlink(struct bucket_queue_t* bucket, int index)
+{
+    int level = bucket->level[index];
+    int prevIndex = bucket->prev[index];
+    int nextIndex = bucket->next[index];
+
+    if(prevIndex == -1)
+    {
+        bucket->head[level] = nextIndex;
+    }
+    else
+    {
+        bucket->next[prevIndex] = nextIndex;
+    }
+
+    if(nextIndex == -1)
+    {
+        bucket->tail[level] = prevIndex;
+    }
+    else
+    {
+        bucket->prev[nextIndex] = prevIndex;
+    }
+
+    if(bucket->head[level] == -1)
+    {
+        bucket->readyMask &= ~(1ULL << level);
+    }
+
+    bucket->level[index] = -1;
+    bucket->size--;
+}
+
+///-------------------------------------------------
+/// @brief  malloc that feeds the allocation
+///         counters while tracking is on
+///
+/// @param[in] size Bytes to allocate
+/// @param[in] nodes Nodes the bytes hold (0 or 1)
+///
+/// @return The memory, NULL on failure
+///-------------------------------------------------
+static void* trackedMalloc(size_t size, int nodes)
+{
+    void* pointer = malloc(size);
+
+    if((pointer != NULL) && __atomic_load_n(&allocTracking, __ATOMIC_RELAXED))
+    {
+        __atomic_add_fetch(&allocStats.mallocs, 1, __ATOMIC_RELAXED);
+        raisePeak(&allocStats.peak_bytes, __atomic_add_fetch(&allocStats.live_bytes, (long long)size, __ATOMIC_RELAXED));
+
+        if(nodes)
+        {
+            raisePeak(&allocStats.peak_nodes, __atomic_add_fetch(&allocStats.live_nodes, nodes, __ATOMIC_RELAXED));
+        }
+    }
+
+    return pointer;
+}
+
+
+///-------------------------------------------------
+/// @brief  free that feeds the allocation counters
+///         while tracking is on
+///
+/// @param[in] pointer Memory from trackedMalloc()
+/// @param[in] size Bytes it was allocated with
+/// @param[in] nodes Nodes the bytes hold (0 or 1)
+///
+/// @return None
+///-------------------------------------------------
+static void trackedFree(void* pointer, size_t size, int nodes)
+{
+    if((pointer != NULL) && __atomic_load_n(&allocTracking, __ATOMIC_RELAXED))
+    {
+        __atomic_add_fetch(&allocStats.frees, 1, __ATOMIC_RELAXED);
+        __atomic_sub_fetch(&allocStats.live_bytes, (long long)size, __ATOMIC_RELAXED);
+        __atomic_sub_fetch(&allocStats.live_nodes, nodes, __ATOMIC_RELAXED);
+    }
+
+    free(pointer);
+}
+
+
+///-------------------------------------------------
+/// @brief  Raise a peak counter to a live count
+///
+/// @param[in] peak The peak counter
+/// @param[in] live The live count
+///
+/// @return None
+///-------------------------------------------------
+static void raisePeak(long long* peak, long long live)
+{
+    long long seen = __atomic_load_n(peak, __ATOMIC_RELAXED);
+
+    // Retry until the peak is at least the live count
+    while((live > seen) && !__atomic_compare_exchange_n(peak, &seen, live, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
 }
\ No newline at end of file
@@ -16,6 +16,82 @@ struct node_t {
     struct node_t* next;
 };
 
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds a contiguous block of nodes owned by a Node Pool
+//----------------------------------------------------------------------------------------------------------------------------------
+struct node_slab_t {
+    // Previously allocated slab
+    struct node_slab_t* next;
+
+    // Nodes handed out by this slab
+    struct node_t nodes[];
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds the Node Pool information. Nodes are carved out of slabs in order
+/// and recycled through a free list, so steady-state push/pop never reaches malloc/free.
+//----------------------------------------------------------------------------------------------------------------------------------
+struct node_pool_t {
+    // Most recently allocated slab
+    struct node_slab_t* slabs;
+
+    // Nodes returned to the pool, linked through their next pointer
+    struct node_t* freeList;
+
+    // Number of nodes in each slab
+    int slabSize;
+
+    // Number of nodes handed out of the most recent slab
+    int slabUsed;
+
+    // Number of slabs allocated so far
+    int slabCount;
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds the Queue descriptor. The head returned by create_queue() is the
+/// address of the embedded sentinel, so the node_t** API can reach the descriptor in O(1).
+//----------------------------------------------------------------------------------------------------------------------------------
+struct queue_t {
+    // Sentinel node at the base of the queue (must stay the first member)
+    struct node_t sentinel;
+
+    // Last node in the queue (the sentinel when the queue is empty)
+    struct node_t* tail;
+
+    // Number of tasks in the queue
+    int size;
+
+    // Pool nodes are taken from (NULL: malloc/free)
+    struct node_pool_t* pool;
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds a Task together with its intrusive queue link. Queuing a task_link_t
+/// needs no node allocation.
+//----------------------------------------------------------------------------------------------------------------------------------
+struct task_link_t {
+    // Task information
+    struct task_t task;
+
+    // Pointer to the next task in the queue
+    struct task_link_t* next;
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds the Intrusive Queue information
+//----------------------------------------------------------------------------------------------------------------------------------
+struct task_list_t {
+    // First task in the queue
+    struct task_link_t* head;
+
+    // Last task in the queue
+    struct task_link_t* tail;
+
+    // Number of tasks in the queue
+    int size;
+};
+
 //----------------------------------------------------------------------------------------------------------------------------------
 /// @brief Creates a queue.
 ///
@@ -27,9 +103,10 @@ struct node_t {
 struct node_t* create_queue(struct task_t* task, int size);
 
 //----------------------------------------------------------------------------------------------------------------------------------
-/// @brief Create a new node for the queue
+/// @brief Create a new node for the queue. Without a task the node is the head of a new, empty queue
+/// (the sentinel of a queue descriptor) that push() and pop() accept.
 ///
-/// @param task The task information
+/// @param task The task information (NULL: head of an empty queue)
 ///
 /// @return a newly allocated task
 //----------------------------------------------------------------------------------------------------------------------------------
@@ -38,7 +115,8 @@ struct node_t* create_new_node(struct task_t* task);
 //----------------------------------------------------------------------------------------------------------------------------------
 /// @brief Returns the top node in the queue
 ///
-/// @param head The head of the queue
+/// @param head The head of the queue. Heads come from create_queue(), create_queue_from_pool(),
+/// create_new_node(NULL) or the sentinel of create_task_queue(); any other node is rejected
 ///
 /// @return the task at the top of the queue
 //----------------------------------------------------------------------------------------------------------------------------------
@@ -47,14 +125,14 @@ struct task_t* peek(struct node_t** head);
 //----------------------------------------------------------------------------------------------------------------------------------
 /// @brief Removes the element at the top of the queue.
 ///
-/// @param head The head of the queue.
+/// @param head The head of the queue (see peek() for where heads come from).
 //----------------------------------------------------------------------------------------------------------------------------------
 void pop(struct node_t** head);
 
 //----------------------------------------------------------------------------------------------------------------------------------
 /// @brief Push a new task into the queue
 ///
-/// @param head The head of the queue
+/// @param head The head of the queue (see peek() for where heads come from)
 /// @param task The task to be put into the queue
 //----------------------------------------------------------------------------------------------------------------------------------
 void push(struct node_t** head, struct task_t* task);
@@ -69,20 +147,456 @@ void push(struct node_t** head, struct task_t* task);
 int is_empty(struct node_t** head);
 
 //----------------------------------------------------------------------------------------------------------------------------------
-/// @brief Remove all items from the queue
+/// @brief Remove all items from the queue, along with the queue itself
 ///
-/// @param head The head of the queue
+/// @param head The head of the queue (see peek() for where heads come from)
 //----------------------------------------------------------------------------------------------------------------------------------
 void empty_queue(struct node_t** head);
 
 //----------------------------------------------------------------------------------------------------------------------------------
-/// @brief Update priorities for all nodes in the queue.
-/// multiplying the priority of a node by 4 if the current execution time is equal to time
-/// multiplying the priority of a node by 2 if the left to execute time is equal to time
+/// @brief The aging rules: the factor a task's priority is multiplied by at a point in time.
+/// 4 if the execution time of the task is equal to time, times 2 if its left to execute time is
+/// equal to time
+///
+/// @param[in] task The task to age
+/// @param[in] time The current time stamp in the system
+///
+/// @return 1, 2, 4 or 8
+//----------------------------------------------------------------------------------------------------------------------------------
+int aging_factor(const struct task_t* task, int time);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Update priorities for all nodes in the queue by applying the aging rules (see
+/// aging_factor())
 ///
 /// @param[in] head The head of the queue
 /// @param[in] time The current time stamp in the system
 //----------------------------------------------------------------------------------------------------------------------------------
 void update_priority(struct node_t** head, int time);
 
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Creates a node pool
+///
+/// @param[in] slabSize The number of nodes allocated at once when the pool runs dry
+///
+/// @return the new node pool
+//----------------------------------------------------------------------------------------------------------------------------------
+struct node_pool_t* create_node_pool(int slabSize);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Take a node from the pool
+///
+/// @param pool The node pool
+/// @param task The task information
+///
+/// @return a node from the pool
+//----------------------------------------------------------------------------------------------------------------------------------
+struct node_t* pool_alloc_node(struct node_pool_t* pool, struct task_t* task);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Return a node to the pool
+///
+/// @param pool The node pool
+/// @param node The node to recycle
+//----------------------------------------------------------------------------------------------------------------------------------
+void pool_free_node(struct node_pool_t* pool, struct node_t* node);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Free the pool and every node it handed out
+///
+/// @param pool The node pool
+//----------------------------------------------------------------------------------------------------------------------------------
+void destroy_node_pool(struct node_pool_t* pool);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Creates a queue whose nodes come from a node pool.
+///
+/// @param[in] task The task information
+/// @param[in] size The size of the task array
+/// @param[in] pool The node pool
+///
+/// @return the head of the new queue
+//----------------------------------------------------------------------------------------------------------------------------------
+struct node_t* create_queue_from_pool(struct task_t* task, int size, struct node_pool_t* pool);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Push a new task into a queue created from a node pool
+///
+/// @param head The head of the queue
+/// @param task The task to be put into the queue
+/// @param pool The node pool
+//----------------------------------------------------------------------------------------------------------------------------------
+void push_pooled(struct node_t** head, struct task_t* task, struct node_pool_t* pool);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Removes the element at the top of a queue created from a node pool.
+///
+/// @param head The head of the queue.
+/// @param pool The node pool
+//----------------------------------------------------------------------------------------------------------------------------------
+void pop_pooled(struct node_t** head, struct node_pool_t* pool);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Creates a queue descriptor.
+///
+/// @param[in] task The task information (may be NULL if size is 0)
+/// @param[in] size The size of the task array
+/// @param[in] pool The node pool to take nodes from (NULL to use malloc)
+///
+/// @return the new queue
+//----------------------------------------------------------------------------------------------------------------------------------
+struct queue_t* create_task_queue(struct task_t* task, int size, struct node_pool_t* pool);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Returns the top task in the queue
+///
+/// @param queue The queue
+///
+/// @return the task at the top of the queue
+//----------------------------------------------------------------------------------------------------------------------------------
+struct task_t* queue_peek(struct queue_t* queue);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Removes the task at the top of the queue.
+///
+/// @param queue The queue
+//----------------------------------------------------------------------------------------------------------------------------------
+void queue_pop(struct queue_t* queue);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Push a new task onto the end of the queue in constant time
+///
+/// @param queue The queue
+/// @param task The task to be put into the queue
+//----------------------------------------------------------------------------------------------------------------------------------
+void queue_push(struct queue_t* queue, struct task_t* task);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Returns the number of tasks in the queue
+///
+/// @param queue The queue
+///
+/// @return the number of queued tasks
+//----------------------------------------------------------------------------------------------------------------------------------
+int queue_size(struct queue_t* queue);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Determines whether the queue is empty.
+///
+/// @param queue The queue
+///
+/// @return True if the queue is empty, False otherwise.
+//----------------------------------------------------------------------------------------------------------------------------------
+int queue_is_empty(struct queue_t* queue);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Free the queue descriptor and its nodes
+///
+/// @param queue The queue
+//----------------------------------------------------------------------------------------------------------------------------------
+void destroy_task_queue(struct queue_t* queue);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Initialize an empty intrusive queue
+///
+/// @param list The intrusive queue
+//----------------------------------------------------------------------------------------------------------------------------------
+void task_list_init(struct task_list_t* list);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Returns the top task in the intrusive queue
+///
+/// @param list The intrusive queue
+///
+/// @return the task link at the top of the queue
+//----------------------------------------------------------------------------------------------------------------------------------
+struct task_link_t* task_list_peek(struct task_list_t* list);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Removes the task at the top of the intrusive queue.
+///
+/// @param list The intrusive queue
+//----------------------------------------------------------------------------------------------------------------------------------
+void task_list_pop(struct task_list_t* list);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Push a task onto the end of the intrusive queue (the task must not already be queued)
+///
+/// @param list The intrusive queue
+/// @param link The task to be put into the queue
+//----------------------------------------------------------------------------------------------------------------------------------
+void task_list_push(struct task_list_t* list, struct task_link_t* link);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Determines whether the intrusive queue is empty.
+///
+/// @param list The intrusive queue
+///
+/// @return True if the queue is empty, False otherwise.
+//----------------------------------------------------------------------------------------------------------------------------------
+int task_list_is_empty(struct task_list_t* list);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Stable merge sort of the intrusive queue, relinking tasks in place
+///
+/// @param list The intrusive queue
+/// @param compare Returns non-zero if taskA must be queued after taskB
+//----------------------------------------------------------------------------------------------------------------------------------
+void task_list_sort(struct task_list_t* list, int (*compare)(struct task_t* taskA, struct task_t* taskB));
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds a single Heap Queue entry
+//----------------------------------------------------------------------------------------------------------------------------------
+struct heap_entry_t {
+    // Task information
+    struct task_t* task;
+
+    // Priority the entry is currently keyed on (cached so the heap stays valid while tasks are aged)
+    int priority;
+
+    // Tie-break between equal priorities (lower values are dispatched first)
+    long long order;
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds the Heap Queue information. The heap is a binary max-heap keyed on
+/// (priority, order), which dispatches tasks in the same order as the stable sorted linked list.
+//----------------------------------------------------------------------------------------------------------------------------------
+struct heap_queue_t {
+    // Heap storage
+    struct heap_entry_t* entries;
+
+    // Heap slot of each task in the task array (-1 if the task is not queued)
+    int* position;
+
+    // Task array the heap was created from
+    struct task_t* base;
+
+    // Number of queued tasks
+    int size;
+
+    // Number of tasks in the task array
+    int capacity;
+
+    // Next tie-break for tasks queued behind their equal priority peers
+    long long backOrder;
+
+    // Next tie-break for tasks queued ahead of their equal priority peers
+    long long frontOrder;
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Creates a heap queue holding every task in the array. Equal priorities are dispatched
+/// in array order.
+///
+/// @param[in] task The task information
+/// @param[in] size The size of the task array
+///
+/// @return the new heap queue
+//----------------------------------------------------------------------------------------------------------------------------------
+struct heap_queue_t* create_heap_queue(struct task_t* task, int size);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Returns the highest priority task in the heap queue
+///
+/// @param heap The heap queue
+///
+/// @return the task at the top of the heap queue
+//----------------------------------------------------------------------------------------------------------------------------------
+struct task_t* heap_peek(struct heap_queue_t* heap);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Removes the highest priority task from the heap queue.
+///
+/// @param heap The heap queue
+//----------------------------------------------------------------------------------------------------------------------------------
+void heap_pop(struct heap_queue_t* heap);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Push a task into the heap queue, behind any queued task of equal priority
+///
+/// @param heap The heap queue
+/// @param task The task to be put into the heap queue (must belong to the heap's task array)
+//----------------------------------------------------------------------------------------------------------------------------------
+void heap_push(struct heap_queue_t* heap, struct task_t* task);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Restore the heap order after a queued task's priority was changed. A task whose
+/// priority rose is placed behind the tasks already at its new priority, a task whose priority
+/// fell is placed ahead of them (the same order a stable sort of the queue would produce).
+///
+/// @param heap The heap queue
+/// @param task The task whose priority changed
+//----------------------------------------------------------------------------------------------------------------------------------
+void heap_reprioritize(struct heap_queue_t* heap, struct task_t* task);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Determines whether the heap queue is empty.
+///
+/// @param heap The heap queue
+///
+/// @return True if the heap queue is empty, False otherwise.
+//----------------------------------------------------------------------------------------------------------------------------------
+int heap_is_empty(struct heap_queue_t* heap);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Free the heap queue (the tasks themselves are not owned by the heap)
+///
+/// @param heap The heap queue
+//----------------------------------------------------------------------------------------------------------------------------------
+void destroy_heap_queue(struct heap_queue_t* heap);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Number of priority levels in a Bucket Queue (one bit of the ready bitmap per level)
+//----------------------------------------------------------------------------------------------------------------------------------
+#define PRIORITY_LEVELS 64
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds the Bucket Queue information. Each priority level has its own FIFO,
+/// and the highest ready level is found with a single count-leading-zeros on the ready bitmap.
+//----------------------------------------------------------------------------------------------------------------------------------
+struct bucket_queue_t {
+    // Bit N is set while level N has queued tasks
+    unsigned long long readyMask;
+
+    // First task index queued at each level (-1 if the level is empty)
+    int head[PRIORITY_LEVELS];
+
+    // Last task index queued at each level (-1 if the level is empty)
+    int tail[PRIORITY_LEVELS];
+
+    // Next task index in the same level (-1 at the end of the level)
+    int* next;
+
+    // Previous task index in the same level (-1 at the start of the level)
+    int* prev;
+
+    // Level each task is queued at (-1 if the task is not queued)
+    int* level;
+
+    // Rank of each queued task within its level (lower ranks are dispatched first)
+    long long* order;
+
+    // Ranks handed out to the next task linked at the front and at the back of a level
+    long long frontOrder;
+    long long backOrder;
+
+    // Task array the queue was created from
+    struct task_t* base;
+
+    // Number of queued tasks
+    int size;
+
+    // Number of tasks in the task array
+    int capacity;
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Maps a task priority onto a Bucket Queue level, clamping it to [0, PRIORITY_LEVELS - 1]
+///
+/// @param[in] priority The task priority
+///
+/// @return the level the priority is queued at
+//----------------------------------------------------------------------------------------------------------------------------------
+int priority_level(int priority);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Creates a bucket queue holding every task in the array. Tasks at the same level are
+/// dispatched in array order.
+///
+/// @param[in] task The task information
+/// @param[in] size The size of the task array
+///
+/// @return the new bucket queue
+//----------------------------------------------------------------------------------------------------------------------------------
+struct bucket_queue_t* create_bucket_queue(struct task_t* task, int size);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Returns the first task of the highest ready level in constant time
+///
+/// @param bucket The bucket queue
+///
+/// @return the task at the top of the bucket queue
+//----------------------------------------------------------------------------------------------------------------------------------
+struct task_t* bucket_peek(struct bucket_queue_t* bucket);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Removes the first task of the highest ready level.
+///
+/// @param bucket The bucket queue
+//----------------------------------------------------------------------------------------------------------------------------------
+void bucket_pop(struct bucket_queue_t* bucket);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Push a task onto the end of its level's FIFO
+///
+/// @param bucket The bucket queue
+/// @param task The task to be put into the bucket queue (must belong to the bucket's task array)
+//----------------------------------------------------------------------------------------------------------------------------------
+void bucket_push(struct bucket_queue_t* bucket, struct task_t* task);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Move a queued task to the level of its new priority. A task moving up a level is placed
+/// at the back of the new level, a task moving down is placed at the front. A task whose level
+/// is unchanged keeps its place.
+///
+/// @param bucket The bucket queue
+/// @param task The task whose priority changed
+//----------------------------------------------------------------------------------------------------------------------------------
+void bucket_reprioritize(struct bucket_queue_t* bucket, struct task_t* task);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Determines whether the bucket queue is empty.
+///
+/// @param bucket The bucket queue
+///
+/// @return True if the bucket queue is empty, False otherwise.
+//----------------------------------------------------------------------------------------------------------------------------------
+int bucket_is_empty(struct bucket_queue_t* bucket);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Free the bucket queue (the tasks themselves are not owned by the queue)
+///
+/// @param bucket The bucket queue
+//----------------------------------------------------------------------------------------------------------------------------------
+void destroy_bucket_queue(struct bucket_queue_t* bucket);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds the queue allocation counters. Nodes are the ones create_new_node()
+/// mallocs (pooled nodes belong to their pool); bytes cover every malloc of the queue layer: nodes,
+/// queue descriptors, node pools and their slabs, heap queues and bucket queues.
+//----------------------------------------------------------------------------------------------------------------------------------
+struct queue_alloc_stats_t {
+    // Nodes allocated and not freed yet, and the most there were at once
+    long long live_nodes;
+    long long peak_nodes;
+
+    // Bytes allocated and not freed yet, and the most there were at once
+    long long live_bytes;
+    long long peak_bytes;
+
+    // Calls to malloc and free
+    long long mallocs;
+    long long frees;
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Turn allocation tracking on (off by default). There is no way back, so a queue is never
+/// freed uncounted after being counted. Turn it on before the first queue is created: memory
+/// allocated before is still subtracted when it's freed.
+//----------------------------------------------------------------------------------------------------------------------------------
+void queue_alloc_enable_tracking(void);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Read the allocation counters
+///
+/// @param stats The counters
+//----------------------------------------------------------------------------------------------------------------------------------
+void queue_alloc_stats(struct queue_alloc_stats_t* stats);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Restart the peaks from the live counts
+//----------------------------------------------------------------------------------------------------------------------------------
+void queue_alloc_reset_peak(void);
+
 #endif // __QUEUE__
\ No newline at end of file
@@ -0,0 +1,178 @@
+#include <stdio.h>
+#include "priority.h"
+
+#ifndef __LATENCY_STATS__
+#define __LATENCY_STATS__
+
+// Linear sub-buckets per power of two are 2^HISTOGRAM_PRECISION_BITS: values below that are
+// counted exactly, larger ones within 1/2^(HISTOGRAM_PRECISION_BITS - 1) (under 1%)
+#define HISTOGRAM_PRECISION_BITS 8
+
+// Number of buckets needed to cover every non-negative int
+#define HISTOGRAM_BUCKETS ((1 << HISTOGRAM_PRECISION_BITS) + ((31 - HISTOGRAM_PRECISION_BITS) << (HISTOGRAM_PRECISION_BITS - 1)))
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds a log-linear (HDR style) histogram of non-negative times. The
+/// memory used doesn't depend on how many values are recorded.
+//----------------------------------------------------------------------------------------------------------------------------------
+struct histogram_t {
+    // Number of values recorded in each bucket
+    long long counts[HISTOGRAM_BUCKETS];
+
+    // Number of values recorded and their sum
+    long long total;
+    long long sum;
+
+    // Exact smallest and largest values recorded
+    int min;
+    int max;
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds the usual summary of a histogram
+//----------------------------------------------------------------------------------------------------------------------------------
+struct latency_summary_t {
+    long long count;
+    double mean;
+    int p50;
+    int p90;
+    int p99;
+    int p999;
+    int max;
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds the wait and turn around time statistics of a task array. Sums are
+/// exact (64-bit integers), the variances are population variances.
+//----------------------------------------------------------------------------------------------------------------------------------
+struct time_stats_t {
+    long long count;
+
+    long long waitSum;
+    int waitMin;
+    int waitMax;
+    double waitVariance;
+
+    long long turnaroundSum;
+    int turnaroundMin;
+    int turnaroundMax;
+    double turnaroundVariance;
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Structure which holds running totals of the wait and turn around times, updated as tasks
+/// complete so that the statistics are known without another pass over the tasks
+//----------------------------------------------------------------------------------------------------------------------------------
+struct online_stats_t {
+    // Number of tasks added
+    long long count;
+
+    // Exact running totals ([0] wait times, [1] turn around times)
+    long long sum[2];
+    unsigned __int128 sumSquares[2];
+    int min[2];
+    int max[2];
+};
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Empty an online statistics accumulator
+///
+/// @param[in] online The accumulator
+//----------------------------------------------------------------------------------------------------------------------------------
+void online_stats_init(struct online_stats_t* online);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Add a completed task's wait and turn around time (constant time)
+///
+/// @param[in] online The accumulator
+/// @param[in] task The task that just completed
+//----------------------------------------------------------------------------------------------------------------------------------
+void online_stats_add(struct online_stats_t* online, const struct task_t* task);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Read the statistics of the tasks added so far (can be called at any time)
+///
+/// @param[in] online The accumulator
+/// @param[out] stats The statistics (all zero if no task was added)
+//----------------------------------------------------------------------------------------------------------------------------------
+void online_stats_read(const struct online_stats_t* online, struct time_stats_t* stats);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Compute the sum, min, max and variance of the wait and turn around times in a single pass
+/// over the task array (vectorized with AVX2 when the CPU supports it)
+///
+/// @param[in] task The buffer containing task data
+/// @param[in] size The size of the buffer
+/// @param[out] stats The statistics (all zero for an empty buffer)
+//----------------------------------------------------------------------------------------------------------------------------------
+void calculate_time_stats(struct task_t* task, int size, struct time_stats_t* stats);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Empty a histogram
+///
+/// @param[in] histogram The histogram
+//----------------------------------------------------------------------------------------------------------------------------------
+void histogram_init(struct histogram_t* histogram);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Record a value (negative values are recorded as 0)
+///
+/// @param[in] histogram The histogram
+/// @param[in] value The value to record
+//----------------------------------------------------------------------------------------------------------------------------------
+void histogram_record(struct histogram_t* histogram, int value);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Add every value of one histogram to another (e.g. to combine several runs)
+///
+/// @param[in] histogram The histogram to add to
+/// @param[in] other The histogram to add
+//----------------------------------------------------------------------------------------------------------------------------------
+void histogram_merge(struct histogram_t* histogram, const struct histogram_t* other);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Returns the value below which the given percentage of the recorded values fall (the
+/// upper end of its bucket, never above the largest value recorded)
+///
+/// @param[in] histogram The histogram
+/// @param[in] percentile The percentile, in [0, 100]
+///
+/// @return the percentile value, 0 if the histogram is empty
+//----------------------------------------------------------------------------------------------------------------------------------
+int histogram_percentile(const struct histogram_t* histogram, double percentile);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Summarize a histogram: count, mean, p50/p90/p99/p99.9 and max
+///
+/// @param[in] histogram The histogram
+/// @param[out] summary The summary
+//----------------------------------------------------------------------------------------------------------------------------------
+void histogram_summary(const struct histogram_t* histogram, struct latency_summary_t* summary);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Print the summary of a histogram (at the summary trace level)
+///
+/// @param[in] name Label for the summary line
+/// @param[in] histogram The histogram
+//----------------------------------------------------------------------------------------------------------------------------------
+void histogram_print(const char* name, const struct histogram_t* histogram);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Record the wait time of every task
+///
+/// @param[in] histogram The histogram
+/// @param[in] task The buffer containing task data
+/// @param[in] size The size of the buffer
+//----------------------------------------------------------------------------------------------------------------------------------
+void histogram_record_wait_times(struct histogram_t* histogram, struct task_t* task, int size);
+
+//----------------------------------------------------------------------------------------------------------------------------------
+/// @brief Record the turn around time of every task
+///
+/// @param[in] histogram The histogram
+/// @param[in] task The buffer containing task data
+/// @param[in] size The size of the buffer
+//----------------------------------------------------------------------------------------------------------------------------------
+void histogram_record_turnaround_times(struct histogram_t* histogram, struct task_t* task, int size);
+
+#endif // __LATENCY_STATS__
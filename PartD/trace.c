@@ -0,0 +1,324 @@
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include "trace.h"
+
+
+struct trace_buffer_t trace_default = {
+    .level = TRACE_LEVEL_AGING,
+    .sink = TRACE_SINK_STDOUT,
+    .out = NULL,
+    .start = 0,
+    .length = 0
+};
+
+static void traceFormat(struct trace_buffer_t* trace, const char* format, va_list args);
+static void traceAppend(struct trace_buffer_t* trace, const char* text, size_t length);
+static void traceWriteOut(struct trace_buffer_t* trace);
+
+
+///-------------------------------------------------
+/// @brief  Sets the runtime trace level
+///
+/// @param[in] level The new trace level
+///
+/// @return None
+///-------------------------------------------------
+void trace_set_level(int level)
+{
+    trace_default.level = level;
+}
+
+
+///-------------------------------------------------
+/// @brief  Selects where buffered trace output
+///         goes
+///
+/// @param[in] sink The new sink
+///
+/// @return None
+///-------------------------------------------------
+void trace_set_sink(enum trace_sink_t sink)
+{
+    trace_buffer_set_sink(&trace_default, sink);
+}
+
+
+///-------------------------------------------------
+/// @brief  Formats a message into the trace buffer
+///
+/// @param[in] format printf() style format string
+///
+/// @return None
+///-------------------------------------------------
+void trace_printf(const char* format, ...)
+{
+    va_list args;
+
+    va_start(args, format);
+    traceFormat(&trace_default, format, args);
+    va_end(args);
+}
+
+
+///-------------------------------------------------
+/// @brief  Writes the buffered output to stdout
+///         (unless it is kept in the ring)
+///
+/// @return None
+///-------------------------------------------------
+void trace_flush(void)
+{
+    trace_buffer_flush(&trace_default);
+}
+
+
+///-------------------------------------------------
+/// @brief  Copies the buffered output without
+///         consuming it
+///
+/// @param[out] buffer Destination buffer
+/// @param[in] size Size of the destination
+///
+/// @return Number of bytes copied
+///-------------------------------------------------
+size_t trace_snapshot(char* buffer, size_t size)
+{
+    return trace_buffer_snapshot(&trace_default, buffer, size);
+}
+
+
+///-------------------------------------------------
+/// @brief  Creates an empty trace buffer
+///
+/// @param[in] level The trace level
+/// @param[in] out Stream to write to
+///
+/// @return The trace buffer
+///-------------------------------------------------
+struct trace_buffer_t* create_trace_buffer(int level, FILE* out)
+{
+    struct trace_buffer_t* trace = (struct trace_buffer_t*)malloc(sizeof(struct trace_buffer_t));
+
+    if(trace == NULL)
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't create trace buffer!\n", __func__);
+        return NULL;
+    }
+
+    trace->level = level;
+    trace->sink = TRACE_SINK_STDOUT;
+    trace->out = out;
+    trace->start = 0;
+    trace->length = 0;
+
+    return trace;
+}
+
+
+///-------------------------------------------------
+/// @brief  Selects where the output of a trace
+///         buffer goes
+///
+/// @param[in] trace The trace buffer
+/// @param[in] sink The new sink
+///
+/// @return None
+///-------------------------------------------------
+void trace_buffer_set_sink(struct trace_buffer_t* trace, enum trace_sink_t sink)
+{
+    traceWriteOut(trace);
+    trace->sink = sink;
+}
+
+
+///-------------------------------------------------
+/// @brief  Formats a message into a trace buffer
+///
+/// @param[in] trace The trace buffer
+/// @param[in] format printf() style format string
+///
+/// @return None
+///-------------------------------------------------
+void trace_buffer_printf(struct trace_buffer_t* trace, const char* format, ...)
+{
+    va_list args;
+
+    va_start(args, format);
+    traceFormat(trace, format, args);
+    va_end(args);
+}
+
+
+///-------------------------------------------------
+/// @brief  Writes the output of a trace buffer to
+///         its stream (unless it is kept in the
+///         ring)
+///
+/// @param[in] trace The trace buffer
+///
+/// @return None
+///-------------------------------------------------
+void trace_buffer_flush(struct trace_buffer_t* trace)
+{
+    if(trace->sink == TRACE_SINK_STDOUT)
+    {
+        traceWriteOut(trace);
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Copies the output of a trace buffer
+///         without consuming it
+///
+/// @param[in] trace The trace buffer
+/// @param[out] buffer Destination buffer
+/// @param[in] size Size of the destination
+///
+/// @return Number of bytes copied
+///-------------------------------------------------
+size_t trace_buffer_snapshot(struct trace_buffer_t* trace, char* buffer, size_t size)
+{
+    if((buffer == NULL) || (size == 0))
+    {
+        return 0;
+    }
+
+    size_t count = (trace->length < (size - 1)) ? trace->length : (size - 1);
+
+    for(size_t i = 0; i < count; i++)
+    {
+        buffer[i] = trace->data[(trace->start + i) % TRACE_BUFFER_SIZE];
+    }
+
+    buffer[count] = '\0';
+
+    return count;
+}
+
+
+///-------------------------------------------------
+/// @brief  Writes out and frees a trace buffer
+///
+/// @param[in] trace The trace buffer
+///
+/// @return None
+///-------------------------------------------------
+void destroy_trace_buffer(struct trace_buffer_t* trace)
+{
+    if(trace == NULL)
+    {
+        return;
+    }
+
+    traceWriteOut(trace);
+    free(trace);
+}
+
+
+///-------------------------------------------------
+/// @brief  Formats a message into a trace buffer
+///
+/// @param[in] trace The trace buffer
+/// @param[in] format printf() style format string
+/// @param[in] args Arguments of the format
+///
+/// @return None
+///-------------------------------------------------
+static void traceFormat(struct trace_buffer_t* trace, const char* format, va_list args)
+{
+    char line[TRACE_LINE_SIZE];
+    int length = vsnprintf(line, sizeof(line), format, args);
+
+    if(length < 0)
+    {
+        return;
+    }
+
+    // Keep the truncated part of long messages
+    if((size_t)length >= sizeof(line))
+    {
+        length = sizeof(line) - 1;
+    }
+
+    traceAppend(trace, line, length);
+}
+
+
+///-------------------------------------------------
+/// @brief  Appends text to a trace buffer,
+///         flushing or overwriting the oldest
+///         output depending on the sink
+///
+/// @param[in] trace The trace buffer
+/// @param[in] text The text to append
+/// @param[in] length Length of the text
+///
+/// @return None
+///-------------------------------------------------
+static void traceAppend(struct trace_buffer_t* trace, const char* text, size_t length)
+{
+    if(trace->sink == TRACE_SINK_STDOUT)
+    {
+        // Flush in bulk when the message doesn't fit
+        if((trace->length + length) > TRACE_BUFFER_SIZE)
+        {
+            traceWriteOut(trace);
+        }
+
+        memcpy(&trace->data[trace->length], text, length);
+        trace->length += length;
+        return;
+    }
+
+    for(size_t i = 0; i < length; i++)
+    {
+        trace->data[(trace->start + trace->length) % TRACE_BUFFER_SIZE] = text[i];
+
+        // Overwrite the oldest byte once the ring is full
+        if(trace->length == TRACE_BUFFER_SIZE)
+        {
+            trace->start = (trace->start + 1) % TRACE_BUFFER_SIZE;
+        }
+        else
+        {
+            trace->length++;
+        }
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Writes everything in a trace buffer to
+///         its stream and empties it
+///
+/// @param[in] trace The trace buffer
+///
+/// @return None
+///-------------------------------------------------
+static void traceWriteOut(struct trace_buffer_t* trace)
+{
+    if(trace->length == 0)
+    {
+        return;
+    }
+
+    FILE* out = (trace->out != NULL) ? trace->out : stdout;
+
+    // Retained output may wrap around the end of
+    // the ring
+    size_t firstPart = TRACE_BUFFER_SIZE - trace->start;
+
+    if(firstPart > trace->length)
+    {
+        firstPart = trace->length;
+    }
+
+    fwrite(&trace->data[trace->start], 1, firstPart, out);
+    fwrite(trace->data, 1, trace->length - firstPart, out);
+    fflush(out);
+
+    trace->start = 0;
+    trace->length = 0;
+}
@@ -0,0 +1,653 @@
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "workload.h"
+
+// Eight digits at a time are parsed as one little endian word
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define WORKLOAD_HAVE_SWAR
+#endif
+
+// Room after the copy of the last CSV line, so every word read stays in bounds
+#define WORKLOAD_TAIL_PADDING 16
+
+
+static struct workload_t* loadPacked(const char* path, const char* data, size_t length);
+static struct workload_t* loadCsv(const char* path, const char* data, size_t length);
+static int parseLines(struct workload_t* workload, const char* cursor, const char* last, const char* end, int* line);
+static const char* parseLine(const char* cursor, const char* end, int* value);
+static const char* parseField(const char* cursor, const char* end, int* value);
+
+
+///-------------------------------------------------
+/// @brief  Creates a workload with room for the
+///         given number of tasks
+///
+/// @param[in] size Number of tasks
+///
+/// @return The workload, NULL on failure
+///-------------------------------------------------
+struct workload_t* create_workload(int size)
+{
+    struct workload_t* workload = (struct workload_t*)malloc(sizeof(struct workload_t));
+
+    if(workload == NULL)
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't create workload!\n", __func__);
+        return NULL;
+    }
+
+    // One allocation holds the three columns
+    workload->size = size;
+    workload->execution = (int*)calloc(3 * (size_t)size + 1, sizeof(int));
+
+    // Verify that calloc didn't fail
+    if(workload->execution == NULL)
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't create workload!\n", __func__);
+        free(workload);
+        return NULL;
+    }
+
+    workload->priority = workload->execution + size;
+    workload->arrival = workload->priority + size;
+
+    return workload;
+}
+
+
+///-------------------------------------------------
+/// @brief  Loads a workload from a mapped file
+///
+/// @param[in] path File to load
+///
+/// @return The workload, NULL on failure
+///-------------------------------------------------
+struct workload_t* workload_load(const char* path)
+{
+    if(path == NULL)
+    {
+        return NULL;
+    }
+
+    int fd = open(path, O_RDONLY);
+
+    if(fd < 0)
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't open %s!\n", __func__, path);
+        return NULL;
+    }
+
+    struct stat info;
+
+    if(fstat(fd, &info) != 0)
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't stat %s!\n", __func__, path);
+        close(fd);
+        return NULL;
+    }
+
+    size_t length = (size_t)info.st_size;
+
+    // An empty file is an empty workload (and can't be mapped)
+    if(length == 0)
+    {
+        close(fd);
+        return create_workload(0);
+    }
+
+    const char* data = (const char*)mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if(data == MAP_FAILED)
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't map %s!\n", __func__, path);
+        return NULL;
+    }
+
+    // Both formats are read front to back once
+    madvise((void*)data, length, MADV_SEQUENTIAL);
+
+    struct workload_t* workload;
+
+    if((length >= sizeof(struct workload_header_t)) && (memcmp(data, WORKLOAD_MAGIC, 4) == 0))
+    {
+        workload = loadPacked(path, data, length);
+    }
+    else
+    {
+        workload = loadCsv(path, data, length);
+    }
+
+    munmap((void*)data, length);
+
+    return workload;
+}
+
+
+///-------------------------------------------------
+/// @brief  Writes a workload as a packed file
+///
+/// @param[in] workload The workload
+/// @param[in] path File to write
+///
+/// @return 0 on success, -1 on failure
+///-------------------------------------------------
+int workload_write(const struct workload_t* workload, const char* path)
+{
+    // Validate parameters
+    if((workload == NULL) || (path == NULL))
+    {
+        return -1;
+    }
+
+    FILE* file = fopen(path, "wb");
+
+    if(file == NULL)
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't open %s!\n", __func__, path);
+        return -1;
+    }
+
+    struct workload_header_t header;
+    size_t size = (size_t)workload->size;
+
+    memcpy(header.magic, WORKLOAD_MAGIC, sizeof(header.magic));
+    header.version = WORKLOAD_VERSION;
+    header.count = workload->size;
+    header.reserved = 0;
+
+    int failed = (fwrite(&header, sizeof(header), 1, file) != 1) ||
+                 (fwrite(workload->execution, sizeof(int), size, file) != size) ||
+                 (fwrite(workload->priority, sizeof(int), size, file) != size) ||
+                 (fwrite(workload->arrival, sizeof(int), size, file) != size);
+
+    if(fclose(file) != 0)
+    {
+        failed = 1;
+    }
+
+    if(failed)
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't write %s!\n", __func__, path);
+        return -1;
+    }
+
+    return 0;
+}
+
+
+///-------------------------------------------------
+/// @brief  Initializes a task array from a workload
+///
+/// @param[in] workload The workload
+/// @param[in] task The task array to fill
+///
+/// @return None
+///-------------------------------------------------
+void workload_init_tasks(const struct workload_t* workload, struct task_t* task)
+{
+    init(task, workload->execution, workload->priority, workload->size);
+}
+
+
+///-------------------------------------------------
+/// @brief  Creates a CSV task reader
+///
+/// @param[in] fd File descriptor to read
+///
+/// @return The reader, NULL on failure
+///-------------------------------------------------
+struct workload_reader_t* create_workload_reader(int fd)
+{
+    struct workload_reader_t* reader = (struct workload_reader_t*)malloc(sizeof(struct workload_reader_t));
+
+    if(reader == NULL)
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't create workload reader!\n", __func__);
+        return NULL;
+    }
+
+    // The padding keeps the word reads of the last
+    // line in bounds
+    reader->fd = fd;
+    reader->buffer = (char*)calloc(WORKLOAD_READ_BUFFER + WORKLOAD_TAIL_PADDING, 1);
+    reader->start = 0;
+    reader->end = 0;
+    reader->line = 0;
+    reader->eof = 0;
+
+    // Verify that calloc didn't fail
+    if(reader->buffer == NULL)
+    {
+        fprintf(stderr, "%s() ERROR: Couldn't create workload reader!\n", __func__);
+        free(reader);
+        return NULL;
+    }
+
+    return reader;
+}
+
+
+///-------------------------------------------------
+/// @brief  Reads the next task from a CSV reader
+///
+/// @param[in] reader The reader
+/// @param[out] value Execution, priority, arrival
+///
+/// @return 1 for a task, 0 at the end, -1 on
+///         failure
+///-------------------------------------------------
+int workload_reader_next(struct workload_reader_t* reader, int* value)
+{
+    char* buffer = reader->buffer;
+
+    while(1)
+    {
+        char* cursor = buffer + reader->start;
+        char* newline = (char*)memchr(cursor, '\n', reader->end - reader->start);
+
+        if(newline != NULL)
+        {
+            reader->start = (newline + 1) - buffer;
+            reader->line++;
+
+            // Skip blank lines and a header line
+            if((cursor == newline) || ((cursor[0] == '\r') && (cursor + 1 == newline)) ||
+               ((reader->line == 1) && isalpha((unsigned char)cursor[0])))
+            {
+                continue;
+            }
+
+            if(parseLine(cursor, buffer + WORKLOAD_READ_BUFFER + WORKLOAD_TAIL_PADDING, value) == NULL)
+            {
+                fprintf(stderr, "%s() ERROR: Line %d isn't a workload line!\n", __func__, reader->line);
+                return -1;
+            }
+
+            return 1;
+        }
+
+        // Give an unterminated last line its newline
+        if(reader->eof)
+        {
+            if(reader->start == reader->end)
+            {
+                return 0;
+            }
+
+            buffer[reader->end++] = '\n';
+            continue;
+        }
+
+        // Move the partial line to the front and read
+        // more behind it
+        memmove(buffer, cursor, reader->end - reader->start);
+        reader->end -= reader->start;
+        reader->start = 0;
+
+        if(reader->end == WORKLOAD_READ_BUFFER)
+        {
+            fprintf(stderr, "%s() ERROR: Line %d is too long!\n", __func__, reader->line + 1);
+            return -1;
+        }
+
+        ssize_t length = read(reader->fd, buffer + reader->end, WORKLOAD_READ_BUFFER - reader->end);
+
+        if(length < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+
+            fprintf(stderr, "%s() ERROR: Couldn't read the workload!\n", __func__);
+            return -1;
+        }
+
+        reader->eof = (length == 0);
+        reader->end += length;
+    }
+}
+
+
+///-------------------------------------------------
+/// @brief  Frees a CSV task reader
+///
+/// @param[in] reader The reader
+///
+/// @return None
+///-------------------------------------------------
+void destroy_workload_reader(struct workload_reader_t* reader)
+{
+    if(reader == NULL)
+    {
+        return;
+    }
+
+    free(reader->buffer);
+    free(reader);
+}
+
+
+///-------------------------------------------------
+/// @brief  Frees a workload
+///
+/// @param[in] workload The workload
+///
+/// @return None
+///-------------------------------------------------
+void destroy_workload(struct workload_t* workload)
+{
+    if(workload == NULL)
+    {
+        return;
+    }
+
+    // The columns share one allocation
+    free(workload->execution);
+    free(workload);
+}
+
+
+///-------------------------------------------------
+/// @brief  Copies the columns out of a mapped
+///         packed workload file
+///
+/// @param[in] path File being loaded (for errors)
+/// @param[in] data The mapped file
+/// @param[in] length Length of the file
+///
+/// @return The workload, NULL on failure
+///-------------------------------------------------
+static struct workload_t* loadPacked(const char* path, const char* data, size_t length)
+{
+    struct workload_header_t header;
+
+    memcpy(&header, data, sizeof(header));
+
+    // Verify the file holds exactly the columns its
+    // header describes
+    if((header.version != WORKLOAD_VERSION) ||
+       (header.count < 0) ||
+       (length != sizeof(header) + 3 * (size_t)header.count * sizeof(int)))
+    {
+        fprintf(stderr, "%s() ERROR: %s isn't a packed workload!\n", __func__, path);
+        return NULL;
+    }
+
+    struct workload_t* workload = create_workload(header.count);
+
+    if(workload == NULL)
+    {
+        return NULL;
+    }
+
+    memcpy(workload->execution, data + sizeof(header), 3 * (size_t)header.count * sizeof(int));
+
+    return workload;
+}
+
+
+///-------------------------------------------------
+/// @brief  Parses a mapped CSV workload file
+///
+/// @param[in] path File being loaded (for errors)
+/// @param[in] data The mapped file
+/// @param[in] length Length of the file
+///
+/// @return The workload, NULL on failure
+///-------------------------------------------------
+static struct workload_t* loadCsv(const char* path, const char* data, size_t length)
+{
+    const char* end = data + length;
+    const char* last = data;
+    size_t lines = 0;
+
+    // Size the columns from the line count (memchr
+    // scans a word or vector at a time)
+    for(const char* newline = data; (newline = (const char*)memchr(newline, '\n', end - newline)) != NULL; newline++)
+    {
+        last = newline + 1;
+        lines++;
+    }
+
+    if(lines >= INT_MAX)
+    {
+        fprintf(stderr, "%s() ERROR: %s has too many tasks!\n", __func__, path);
+        return NULL;
+    }
+
+    struct workload_t* workload = create_workload((int)lines + 1);
+
+    if(workload == NULL)
+    {
+        return NULL;
+    }
+
+    const char* cursor = data;
+
+    // Skip a header line (one starting with a name)
+    if(isalpha((unsigned char)*cursor))
+    {
+        cursor = (const char*)memchr(cursor, '\n', end - cursor);
+        cursor = (cursor == NULL) ? end : cursor + 1;
+    }
+
+    workload->size = 0;
+    int line = (cursor == data) ? 1 : 2;
+
+    // Every complete line ends in a newline, so the
+    // parser needs no bounds checks up to the last one
+    if(cursor < last)
+    {
+        if(parseLines(workload, cursor, last, end, &line) != 0)
+        {
+            fprintf(stderr, "%s() ERROR: %s:%d isn't a workload line!\n", __func__, path, line);
+            destroy_workload(workload);
+            return NULL;
+        }
+
+        cursor = last;
+    }
+
+    // Give the unterminated last line a newline and
+    // some padding in a copy of its own
+    if(cursor < end)
+    {
+        size_t tail = end - cursor;
+        char* copy = (char*)calloc(tail + WORKLOAD_TAIL_PADDING, 1);
+
+        if(copy == NULL)
+        {
+            fprintf(stderr, "%s() ERROR: Couldn't load %s!\n", __func__, path);
+            destroy_workload(workload);
+            return NULL;
+        }
+
+        memcpy(copy, cursor, tail);
+        copy[tail] = '\n';
+
+        int result = parseLines(workload, copy, copy + tail + 1, copy + tail + WORKLOAD_TAIL_PADDING, &line);
+        free(copy);
+
+        if(result != 0)
+        {
+            fprintf(stderr, "%s() ERROR: %s:%d isn't a workload line!\n", __func__, path, line);
+            destroy_workload(workload);
+            return NULL;
+        }
+    }
+
+    return workload;
+}
+
+
+///-------------------------------------------------
+/// @brief  Parses newline terminated CSV lines into
+///         the workload columns
+///
+/// @param[in] workload The workload to append to
+/// @param[in] cursor First line to parse
+/// @param[in] last Just past the last newline
+/// @param[in] end End of the readable memory
+/// @param[in,out] line Line number (for errors)
+///
+/// @return 0 on success, -1 on failure
+///-------------------------------------------------
+static int parseLines(struct workload_t* workload, const char* cursor, const char* last, const char* end, int* line)
+{
+    int size = workload->size;
+    int value[3];
+
+    while(cursor < last)
+    {
+        // Skip blank lines
+        if((*cursor == '\n') || (*cursor == '\r'))
+        {
+            *line += (*cursor == '\n');
+            cursor++;
+            continue;
+        }
+
+        cursor = parseLine(cursor, end, value);
+
+        if(cursor == NULL)
+        {
+            workload->size = size;
+            return -1;
+        }
+
+        workload->execution[size] = value[0];
+        workload->priority[size] = value[1];
+        workload->arrival[size] = value[2];
+        size++;
+        (*line)++;
+    }
+
+    workload->size = size;
+
+    return 0;
+}
+
+
+///-------------------------------------------------
+/// @brief  Parses one newline terminated CSV line
+///
+/// @param[in] cursor Start of the line
+/// @param[in] end End of the readable memory
+/// @param[out] value Execution, priority, arrival
+///
+/// @return Start of the next line, NULL on failure
+///-------------------------------------------------
+static const char* parseLine(const char* cursor, const char* end, int* value)
+{
+    value[1] = 0;
+    value[2] = 0;
+
+    cursor = parseField(cursor, end, &value[0]);
+
+    // Optional priority and arrival fields
+    for(int field = 1; (cursor != NULL) && (field < 3) && (*cursor == ','); field++)
+    {
+        cursor = parseField(cursor + 1, end, &value[field]);
+    }
+
+    if(cursor == NULL)
+    {
+        return NULL;
+    }
+
+    // Accept CRLF line endings
+    cursor += (*cursor == '\r');
+
+    return (*cursor == '\n') ? cursor + 1 : NULL;
+}
+
+
+///-------------------------------------------------
+/// @brief  Parses a non-negative decimal field,
+///         eight digits per step where possible
+///
+/// @param[in] cursor Start of the field
+/// @param[in] end End of the readable memory
+/// @param[out] value The parsed value
+///
+/// @return Just past the field, NULL on failure
+///-------------------------------------------------
+static const char* parseField(const char* cursor, const char* end, int* value)
+{
+    while(*cursor == ' ')
+    {
+        cursor++;
+    }
+
+    const char* start = cursor;
+    unsigned long long result = 0;
+
+#ifdef WORKLOAD_HAVE_SWAR
+    if(end - cursor >= 8)
+    {
+        uint64_t word;
+        memcpy(&word, cursor, sizeof(word));
+
+        // Flag the bytes outside '0'..'9' (a borrow or
+        // carry only reaches bytes after the first one
+        // flagged, so the lowest flag is exact)
+        uint64_t flags = (word | (word - 0x3030303030303030ULL) | (word + 0x4646464646464646ULL)) & 0x8080808080808080ULL;
+        int digits = (flags == 0) ? 8 : (__builtin_ctzll(flags) >> 3);
+
+        if(digits == 0)
+        {
+            return NULL;
+        }
+
+        // Move the digits to the top of the word (the
+        // zeros shifted in act as leading zeros), then
+        // combine pairs, quads and the two halves
+        word <<= 8 * (8 - digits);
+        word = ((word & 0x0F0F0F0F0F0F0F0FULL) * 2561) >> 8;
+        word = ((word & 0x00FF00FF00FF00FFULL) * 6553601) >> 16;
+        word = ((word & 0x0000FFFF0000FFFFULL) * 42949672960001ULL) >> 32;
+
+        result = word;
+        cursor += digits;
+    }
+#else
+    (void)end;
+#endif
+
+    // Digits the word step didn't cover (none unless
+    // it was cut short or saw eight digits)
+    for(unsigned digit; (digit = (unsigned)(*cursor - '0')) <= 9; cursor++)
+    {
+        result = result * 10 + digit;
+
+        // Stop before the value can overflow
+        if(result > INT_MAX)
+        {
+            return NULL;
+        }
+    }
+
+    if(cursor == start)
+    {
+        return NULL;
+    }
+
+    while(*cursor == ' ')
+    {
+        cursor++;
+    }
+
+    *value = (int)result;
+
+    return cursor;
+}